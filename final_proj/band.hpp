@@ -0,0 +1,47 @@
+#ifndef BAND_HPP
+#define BAND_HPP
+
+//banded alignment: only the tiles a band of diagonals crosses are computed, every other cell is taken to be 0
+//a diagonal is (position in seq2) - (position in seq1), the band is every cell within width of its center diagonal
+//near identical pairs, like a read against the reference window it came from, never leave it,
+//so a tile row is (2 * width / tile size + 2) tiles instead of all of them
+//adaptive, the center moves to the diagonal of the best cell so far after every tile row, so the band follows the indels
+//the kernel recenters after every seq2 tile row and the CPU baselines after every seq1 block row, so an adaptive band
+//is not the same band on the two and they can give different alignments, a fixed band is the same tiles and alignment on both
+//the alignment is the best one inside the band, the full matrix's whenever that one stays in it
+
+struct Band {
+    int width;
+        //cells either side of the center diagonal, < 0 is no band, the whole matrix
+    int center;
+    bool adaptive;
+
+    bool on() const { return width >= 0; }
+};
+
+inline Band fullBand() {
+    Band band = {-1, 0, false};
+    return band;
+}
+
+//rounds down for negative a too
+inline int bandFloorDiv(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+//first / last tile of tile row `row` the diagonals [diagonal - width, diagonal + width] cross, lo > hi if none do
+//tiles are tileDim cells a side and a tile row is `tiles` tiles, the diagonal here is row position - column position,
+//so an engine with seq2 down the rows passes the band's center as it is and one with seq1 down the rows passes -center
+inline void bandTileRange(int row, int tileDim, int tiles, int diagonal, int width, int& lo, int& hi) {
+    //the cells of tile (row, col) are on diagonals (row - col) * tileDim - (tileDim - 1) to (row - col) * tileDim + (tileDim - 1)
+    lo = bandFloorDiv(row * tileDim - diagonal - width, tileDim);
+    hi = bandFloorDiv(row * tileDim + tileDim - 1 - diagonal + width, tileDim);
+    if (lo < 0) {
+        lo = 0;
+    }
+    if (hi > tiles - 1) {
+        hi = tiles - 1;
+    }
+}
+
+#endif
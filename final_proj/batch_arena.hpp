@@ -0,0 +1,80 @@
+#ifndef BATCH_ARENA_HPP
+#define BATCH_ARENA_HPP
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "defines.hpp"
+#include "packed_seq.hpp"
+#include "scoring.hpp"
+#include "sw_algo.hpp"
+
+//the inputs of SW_batch_linear for a batch of pairs, built one pair at a time
+//every sequence goes in the arena padded like a SW_basic_linear input (kernelSequence), the pair table says where
+//the tile size, score width, boundary planes and traceback bits are the kernel's, a host passes the ones of its xclbin (KernelConfig)
+struct BatchArena {
+    BatchArena(int tileDimension = TILE_DIMENSION, int scoreBits = SCORE_BITS, int boundaryPlanes = BOUNDARY_PLANES,
+               int tracebackBits = TRACEBACK_BITS)
+        : tileDimension(tileDimension), scoreBits(scoreBits), boundaryPlanes(boundaryPlanes), tracebackBits(tracebackBits) {}
+
+    KernelSeq arena;
+    std::vector<int> pairTable;
+    size_t outputBytes = 0;
+        //each aligned arena, seq1_len + seq2_len for every pair
+    size_t boundaryTiles = 0;
+        //tilenum[0] * tilenum[1] of the biggest pair, the buffer is sized for it
+
+    int pairs() const { return (int)pairTable.size() / BATCH_PAIR_WORDS; }
+
+    //false if the pair can't go to the kernel, see kernelSequence() and scoreBitsNeeded(), the batch is left as it was
+    bool add(const std::string& seq1, const std::string& seq2, const ScoringScheme& scheme = defaultScheme()) {
+        if (scoreBitsNeeded(scheme, seq1.length(), seq2.length()) > scoreBits) {
+            return false;
+        }
+        int tiles1 = (seq1.length() + tileDimension - 1) / tileDimension;
+        int tiles2 = (seq2.length() + tileDimension - 1) / tileDimension;
+        KernelSeq seq1_in, seq2_in;
+        if (!kernelSequence(seq1, tiles1 * tileDimension, seq1_in) || !kernelSequence(seq2, tiles2 * tileDimension, seq2_in)) {
+            return false;
+        }
+        pairTable.push_back(append(seq1_in));
+        pairTable.push_back((int)seq1.length());
+        pairTable.push_back(append(seq2_in));
+        pairTable.push_back((int)seq2.length());
+        outputBytes += seq1.length() + seq2.length();
+        boundaryTiles = std::max(boundaryTiles, (size_t)tiles1 * tiles2);
+        return true;
+    }
+
+    //boundary_t words of the buffer argument
+    size_t bufferWords() const {
+        int wordBits = scoreBits <= 8 ? 8 : (scoreBits <= 16 ? 16 : 32);
+            //boundary_t of the kernel
+        return alignBufferWords(boundaryTiles, tileDimension, wordBits, boundaryPlanes, tracebackBits);
+    }
+
+    //pair p's alignment out of the kernel's outputs, in order (the kernel writes it reversed)
+    static std::string aligned(const std::vector<char>& alignedArena, const int* resultTable, int p) {
+        const char* start = &alignedArena[resultTable[p * BATCH_RESULT_WORDS + 3]];
+        std::string out(start, start + resultTable[p * BATCH_RESULT_WORDS + 4]);
+        std::reverse(out.begin(), out.end());
+        return out;
+    }
+
+private:
+    int tileDimension;
+    int scoreBits;
+    int boundaryPlanes;
+    int tracebackBits;
+
+    //offset of seq in the arena, in seq_in_t
+    int append(const KernelSeq& seq) {
+        int offset = (int)(arena.chars.size() + arena.words.size());
+            //only one of them is used
+        arena.chars.insert(arena.chars.end(), seq.chars.begin(), seq.chars.end());
+        arena.words.insert(arena.words.end(), seq.words.begin(), seq.words.end());
+        return offset;
+    }
+};
+
+#endif
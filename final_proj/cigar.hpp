@@ -0,0 +1,53 @@
+#ifndef CIGAR_HPP
+#define CIGAR_HPP
+
+#include <string>
+#include "defines.hpp"
+
+//SW_cigar_linear's output: the alignment as runs, one word a run, length << CIGAR_OP_BITS | op
+//the ops are BAM's with seq1 as the reference: CIGAR_MATCH steps both, CIGAR_INS only seq2 (a '-' in seq1), CIGAR_DEL only seq1
+//the kernel writes the runs end first, the helpers here take them as the kernel left them and give them back in order
+//result is SW_cigar_linear's: score, start in seq1, start in seq2, end in seq1, end in seq2, runs (1 based, start > end if empty)
+
+inline int cigarOp(unsigned int run) { return run & ((1 << CIGAR_OP_BITS) - 1); }
+inline int cigarLength(unsigned int run) { return run >> CIGAR_OP_BITS; }
+
+//the usual text form, "12M1I30M"
+inline std::string cigarString(const int result[CIGAR_RESULT_WORDS], const unsigned int* cigar) {
+    static const char opChars[] = "MID";
+    std::string text;
+    for (int r = result[5] - 1; r >= 0; r--) {
+        text += std::to_string(cigarLength(cigar[r]));
+        text += opChars[cigarOp(cigar[r])];
+    }
+    return text;
+}
+
+//the gapped strings SW_basic_linear would have written, in order, from the sequences the pair was aligned with
+inline void expandCigar(const std::string& seq1, const std::string& seq2, const int result[CIGAR_RESULT_WORDS],
+                        const unsigned int* cigar, std::string& aligned1, std::string& aligned2) {
+    aligned1.clear();
+    aligned2.clear();
+    int j = result[1] - 1;
+    int i = result[2] - 1;
+    for (int r = result[5] - 1; r >= 0; r--) {
+        int op = cigarOp(cigar[r]);
+        int length = cigarLength(cigar[r]);
+        if (op == CIGAR_MATCH) {
+            aligned1.append(seq1, j, length);
+            aligned2.append(seq2, i, length);
+            j += length;
+            i += length;
+        } else if (op == CIGAR_INS) {
+            aligned1.append(length, '-');
+            aligned2.append(seq2, i, length);
+            i += length;
+        } else {
+            aligned1.append(seq1, j, length);
+            aligned2.append(length, '-');
+            j += length;
+        }
+    }
+}
+
+#endif
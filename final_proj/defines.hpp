@@ -3,14 +3,153 @@
 
     // Constants
     #define BASELINE_TILE_DIM 32
-        //this is for software
-    #define TILE_DIMENSION 16
-        //for FPGA implementations
-    #define TILE_DIM_TIMES_2 32
-        //x2 of the above
+        //this is for software, the default block size of the blocked CPU baselines
+        //they are built for 8, 16, 32 and 64 (src_base/tile_dim.hpp) and base_main -t picks one at run time
+    #ifndef TILE_DIMENSION
+        #define TILE_DIMENSION 16
+    #endif
+        //for FPGA implementations, 8, 16, 32 or 64
+        //v++ / vitis_hls -DTILE_DIMENSION=32 synthesizes another size without editing this,
+        //the hosts read the size of the xclbin they load back from SW_kernel_config (src_syst/kernel_config.hpp)
+    #define TILE_BOUNDARY_SLOT ((TILE_DIMENSION + 1) * 2)
+        //one tile's bottom and right side in the tile edges buffer
 
     #define MATCH_SCORE 3
     #define MISMATCH_SCORE -3
+        //default substitution scores, the engines take a ScoringScheme (scoring.hpp) for anything else
     #define GAP_SCORE -2
 
+    #define SCORE_ALPHABET 32
+        //substitution matrices are SCORE_ALPHABET x SCORE_ALPHABET, every character is encoded to a code below it
+    #define SCORING_WORDS (SCORE_ALPHABET * SCORE_ALPHABET + 256)
+        //kernel scoring argument: the substitution matrix row major, then the code of every character
+
+    #define TILE_DATAFLOW
+        //syst kernel: each tile row is a load -> compute -> store pipeline (tile_row_dataflow), so the next tile is loaded
+        //and the last one stored while a tile is on the systolic array, without it the steps of a tile run one after the other
+
+    #ifndef SCORE_BITS
+        #define SCORE_BITS 32
+    #endif
+        //syst kernel: width of a score (ap_int) in the PEs, the streams and the tile arrays, and of a word of the tile edges buffer
+        //16 halves the FIFOs, the tile BRAM and the buffer's DDR traffic, the hosts only send a pair that fits (scoreBitsNeeded, scoring.hpp)
+        //-DSCORE_BITS=16 on the v++ / vitis_hls line builds the narrow kernel without editing this
+        //the loop and systold kernels only build with more than 16
+
+    //#define STRIP_SYSTOLIC
+        //syst kernel: the PE column stays up for a whole tile row (strip_dataflow) and seq1 streams past it without stopping,
+        //so the array fills and drains once a strip instead of once a tile, the strip's bottom row goes out to buffer as a stream
+        //used over TILE_DATAFLOW when both are on, the backtrack and the score kernel are the same either way
+
+    #ifndef ONCHIP_BOUNDARY_LEN
+        #define ONCHIP_BOUNDARY_LEN 4096
+    #endif
+        //syst kernel: when seq1 is at most this long, the bottom row of the tile row above stays in an on chip line (URAM)
+        //and the forward pass reads nothing back from buffer, longer seq1 spill to buffer like before, 0 always spills
+        //the tile edges still go out to buffer for the backtrack, the score kernel makes no buffer accesses for its row at all
+        //STRIP_SYSTOLIC always reads the row above from buffer
+
+    //#define AFFINE_GAP
+        //Gotoh gaps (H, E, F) instead of GAP_SCORE for every gap cell, picked at compile time so the linear build is unchanged
+        //a gap of length k scores GAP_OPEN + (k - 1) * GAP_EXTEND, GAP_OPEN has to be <= GAP_EXTEND
+        //E and F are clamped at 0 like H, so every boundary and padding cell is still 0
+    #define GAP_OPEN -5
+    #define GAP_EXTEND -1
+
+    #ifdef AFFINE_GAP
+        #define BOUNDARY_PLANES 2
+    #else
+        #define BOUNDARY_PLANES 1
+    #endif
+        //tile boundary buffers hold H, plus the gap scores (F on the bottom, E on the right) with AFFINE_GAP
+
+    //#define TRACEBACK_POINTERS
+        //syst kernel: every PE also writes where its cell came from, packed after the tile edges in buffer (traceback_ptr.hpp),
+        //and the backtrack walks those instead of recomputing every tile it goes into, TRACEBACK_BITS more of buffer a cell
+    #ifndef TRACEBACK_POINTERS
+        #define TRACEBACK_BITS 0
+    #elif defined(AFFINE_GAP)
+        #define TRACEBACK_BITS 4
+    #else
+        #define TRACEBACK_BITS 2
+    #endif
+        //the move in 2 bits (TRACE_STOP, TRACE_DIAG, TRACE_LEFT, TRACE_UP), with AFFINE_GAP a bit each for a gap opening in E / F
+    #define TRACE_STOP 0
+    #define TRACE_DIAG 1
+    #define TRACE_LEFT 2
+    #define TRACE_UP 3
+    #define TRACE_E_OPEN 4
+    #define TRACE_F_OPEN 8
+
+    //#define BANDED
+        //syst kernel: a tile row only computes the tiles a band of diagonals crosses (band.hpp), every other cell is taken to be 0
+        //the skipped tiles next to the band get zero edges in buffer instead, so the backtracks and the hosts read them unchanged
+        //for near identical pairs the forward pass is (2 * BAND_WIDTH / TILE_DIMENSION + 2) tiles a row instead of tilenum[0],
+        //SW_score_linear is not banded
+    #ifndef BAND_WIDTH
+        #define BAND_WIDTH 64
+    #endif
+        //cells either side of the center diagonal
+    #ifndef BAND_CENTER
+        #define BAND_CENTER 0
+    #endif
+        //diagonal the band starts on, position in seq2 - position in seq1
+    #ifndef BAND_ADAPTIVE
+        #define BAND_ADAPTIVE 1
+    #endif
+        //with BANDED, 1 moves the center to the diagonal of the best cell so far after every tile row, so the band follows indels
+        //0 keeps it on BAND_CENTER, the band the CPU baselines take without -r
+
+    //#define XDROP
+        //syst kernel: X-drop on the tiles, a tile is dead when its edges (bottom row, right column) are all more than XDROP_SCORE
+        //below the best score before its tile row, and the next tile row runs from the first tile under a live one
+        //to the one after the last, like BLAST's X-drop window, the skipped tiles get zero edges like BANDED's
+        //once a tile row has no live tile the forward pass stops, SW_score_linear does not drop
+        //base_main -x drops against the best along each block's dependencies instead, so at a real X the two skip different
+        //tiles and are not expected to give the same alignment
+    #ifndef XDROP_SCORE
+        #define XDROP_SCORE 40
+    #endif
+
+    //#define PACKED_SEQ
+        //the syst kernel takes seq1 and seq2 packed 2 bits a base with an N mask (packed_seq.hpp) instead of a char a base
+        //DNA only: the hosts refuse anything but A C G T N, the loop and systold kernels only build without it
+    #define PACKED_BASES_PER_WORD 16
+    #define PACKED_BLOCK_BASES 32
+    #define PACKED_BLOCK_WORDS 3
+        //2 words of codes then the N mask word, TILE_DIMENSION has to divide PACKED_BLOCK_BASES or be a multiple of it
+    #define PACKED_TILE_WORDS (((TILE_DIMENSION + PACKED_BLOCK_BASES - 1) / PACKED_BLOCK_BASES) * PACKED_BLOCK_WORDS)
+        //words the kernel reads for one tile
+
+    #define BATCH_PAIR_WORDS 4
+        //SW_batch_linear pair table: seq1 offset, seq1 length, seq2 offset, seq2 length
+    #define BATCH_RESULT_WORDS 5
+        //SW_batch_linear result table: score, end in seq1, end in seq2, output offset, alignment length
+
+    #define CIGAR_RESULT_WORDS 6
+        //SW_cigar_linear result: score, start in seq1, start in seq2, end in seq1, end in seq2, runs in cigar (1 based like best)
+    #define CIGAR_OP_BITS 4
+        //a cigar run is one word, length << CIGAR_OP_BITS | op, the ops are BAM's (cigar.hpp)
+    #define CIGAR_MATCH 0
+        //seq1 and seq2 both step, match or mismatch
+    #define CIGAR_INS 1
+        //seq2 only, a gap in seq1
+    #define CIGAR_DEL 2
+        //seq1 only, a gap in seq2
+    #define CIGAR_BUFFER_RUNS 256
+        //runs the kernel keeps on chip, they go out in one burst when it is full and at the end
+
+    #define KERNEL_CONFIG_WORDS 4
+        //SW_kernel_config output: TILE_DIMENSION, SCORE_BITS, BOUNDARY_PLANES, then a bit per KERNEL_FEATURE_ the build has on
+    #define KERNEL_FEATURE_AFFINE_GAP 1
+    #define KERNEL_FEATURE_PACKED_SEQ 2
+    #define KERNEL_FEATURE_TILE_DATAFLOW 4
+    #define KERNEL_FEATURE_STRIP_SYSTOLIC 8
+    #define KERNEL_FEATURE_TRACEBACK_POINTERS 16
+    #define KERNEL_FEATURE_BANDED 32
+    #define KERNEL_FEATURE_XDROP 64
+
+    #define SECOND_BEST_MIN_MASK 15
+        //score only mode: the second best score skips ends within max(this, shorter length / 2) of the best end in seq2
+
 #endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+#ifndef PACKED_SEQ_HPP
+#define PACKED_SEQ_HPP
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "defines.hpp"
+
+//2 bit DNA sequences for the kernel inputs (PACKED_SEQ), 3 bits a base instead of 8 with the N mask
+//a block of PACKED_BLOCK_BASES bases is PACKED_BLOCK_WORDS words:
+//  the 2 bit codes, PACKED_BASES_PER_WORD to a word, base k of the block at bits 2 * (k % PACKED_BASES_PER_WORD)
+//  then the N mask, bit k set if base k is N (its code is 0)
+//a tile never goes over a block edge, so the kernel reads the words of its block and unpacks the tile from them
+
+//A C G T, the order of the 2 bit codes
+#define PACKED_LETTERS "ACGT"
+
+//-1 if c can't be packed
+inline int packedCode(char c) {
+    switch (c) {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return -1;
+    }
+}
+
+//only A C G T and N, anything else would come back as something else
+inline bool isPackable(const std::string& seq) {
+    for (char c : seq) {
+        if (c != 'N' && packedCode(c) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//words for the first numBases bases, the last block is padded with A
+inline size_t packedWords(size_t numBases) {
+    return (numBases + PACKED_BLOCK_BASES - 1) / PACKED_BLOCK_BASES * PACKED_BLOCK_WORDS;
+}
+
+//packs seq into out, which is packedWords(paddedSize) long
+//paddedSize is what the kernel reads (tilenum * TILE_DIMENSION), the bases after seq are A
+inline void packSequence(const std::string& seq, size_t paddedSize, std::vector<unsigned int>& out) {
+    out.assign(packedWords(std::max(paddedSize, seq.size())), 0);
+    for (size_t n = 0; n < seq.size(); ++n) {
+        unsigned int* block = &out[n / PACKED_BLOCK_BASES * PACKED_BLOCK_WORDS];
+        int k = n % PACKED_BLOCK_BASES;
+        int code = packedCode(seq[n]);
+        if (code < 0) {
+            block[PACKED_BLOCK_WORDS - 1] |= 1u << k;
+        } else {
+            block[k / PACKED_BASES_PER_WORD] |= (unsigned int)code << (2 * (k % PACKED_BASES_PER_WORD));
+        }
+    }
+}
+
+//base n of a packed sequence, what the kernel unpacks
+inline char unpackedBase(const unsigned int* packed, size_t n) {
+    const unsigned int* block = &packed[n / PACKED_BLOCK_BASES * PACKED_BLOCK_WORDS];
+    int k = n % PACKED_BLOCK_BASES;
+    if ((block[PACKED_BLOCK_WORDS - 1] >> k) & 1) {
+        return 'N';
+    }
+    return PACKED_LETTERS[(block[k / PACKED_BASES_PER_WORD] >> (2 * (k % PACKED_BASES_PER_WORD))) & 3];
+}
+
+inline std::string unpackSequence(const std::vector<unsigned int>& packed, size_t size) {
+    std::string seq(size, 0);
+    for (size_t n = 0; n < size; ++n) {
+        seq[n] = unpackedBase(packed.data(), n);
+    }
+    return seq;
+}
+
+//what the hosts and testbenches hand the kernel for one sequence:
+//the chars padded to paddedSize + 1 (null terminated), or the packed words with PACKED_SEQ
+struct KernelSeq {
+    std::vector<char> chars;
+    std::vector<unsigned int> words;
+
+    #ifdef PACKED_SEQ
+        void* data() { return words.data(); }
+        size_t bytes() const { return sizeof(unsigned int) * words.size(); }
+    #else
+        void* data() { return chars.data(); }
+        size_t bytes() const { return sizeof(char) * chars.size(); }
+    #endif
+};
+
+//false if the sequence can't go to the kernel, only with PACKED_SEQ and something that is not A C G T N
+inline bool kernelSequence(const std::string& seq, size_t paddedSize, KernelSeq& out) {
+    #ifdef PACKED_SEQ
+        if (!isPackable(seq)) {
+            return false;
+        }
+        packSequence(seq, paddedSize, out.words);
+    #else
+        out.chars.assign(std::max(paddedSize, seq.size()) + 1, 0);
+        std::copy(seq.begin(), seq.end(), out.chars.begin());
+    #endif
+    return true;
+}
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef SCORING_HPP
+#define SCORING_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "defines.hpp"
+
+//runtime scoring schemes: a substitution matrix over small integer codes, and the code of every character
+//every engine looks scores up through this instead of comparing characters against MATCH_SCORE / MISMATCH_SCORE,
+//so another matrix is a different argument, not a rebuild (or a re-synthesis for the kernels)
+//the gap scores are still the compile time ones in defines.hpp, the gap model picks the datapath
+
+//letters in the order of the NCBI matrix files
+#define BLOSUM_LETTERS "ARNDCQEGHILKMFPSTWYVBZX*"
+
+struct ScoringScheme {
+    unsigned char code[256];
+        //code of every character, always below size
+    int sub[SCORE_ALPHABET][SCORE_ALPHABET];
+        //sub[code a][code b] is the score of a against b
+    int size;
+        //number of codes in use
+
+    //filled in by finish()
+    int maxScore;
+    int minScore;
+    bool uniform;
+        //every code only matches itself, with one match and one mismatch score,
+        //so comparing codes gives the same scores (the SIMD engines keep their compare for these)
+    int matchScore;
+    int mismatchScore;
+
+    unsigned char encode(char c) const { return code[(unsigned char)c]; }
+    int score(char a, char b) const { return sub[code[(unsigned char)a]][code[(unsigned char)b]]; }
+
+    void finish() {
+        maxScore = sub[0][0];
+        minScore = sub[0][0];
+        matchScore = sub[0][0];
+        mismatchScore = (size > 1) ? sub[0][1] : sub[0][0];
+        uniform = true;
+        for (int a = 0; a < size; ++a) {
+            for (int b = 0; b < size; ++b) {
+                maxScore = std::max(maxScore, sub[a][b]);
+                minScore = std::min(minScore, sub[a][b]);
+                uniform = uniform && (sub[a][b] == ((a == b) ? matchScore : mismatchScore));
+            }
+        }
+    }
+
+    //kernel argument, see SCORING_WORDS
+    void pack(int out[SCORING_WORDS]) const {
+        for (int a = 0; a < SCORE_ALPHABET; ++a) {
+            for (int b = 0; b < SCORE_ALPHABET; ++b) {
+                out[a * SCORE_ALPHABET + b] = sub[a][b];
+            }
+        }
+        for (int c = 0; c < 256; ++c) {
+            out[SCORE_ALPHABET * SCORE_ALPHABET + c] = code[c];
+        }
+    }
+};
+
+//the codes of a sequence, for the engines that compare or look up codes in bulk
+inline std::string encodeSequence(const ScoringScheme& scheme, const char* seq, size_t size) {
+    std::string codes(size, 0);
+    for (size_t k = 0; k < size; ++k) {
+        codes[k] = scheme.encode(seq[k]);
+    }
+    return codes;
+}
+
+//every code scores match against itself and mismatch against everything else
+inline void fillIdentity(ScoringScheme& scheme, int match, int mismatch) {
+    for (int a = 0; a < SCORE_ALPHABET; ++a) {
+        for (int b = 0; b < SCORE_ALPHABET; ++b) {
+            scheme.sub[a][b] = (a == b) ? match : mismatch;
+        }
+    }
+}
+
+//letters (either case) are codes 0 to 25, every other character is code 26
+//with the defaults this scores exactly like comparing upper case letters, which is what the datasets hold
+inline ScoringScheme matchMismatchScheme(int match = MATCH_SCORE, int mismatch = MISMATCH_SCORE) {
+    ScoringScheme scheme;
+    scheme.size = 27;
+    for (int c = 0; c < 256; ++c) {
+        scheme.code[c] = std::isalpha(c) ? std::toupper(c) - 'A' : 26;
+    }
+    fillIdentity(scheme, match, mismatch);
+    scheme.finish();
+    return scheme;
+}
+
+//A, C, G, T (either case) are codes 0 to 3, anything else is N (code 4)
+inline ScoringScheme dnaScheme(int match = MATCH_SCORE, int mismatch = MISMATCH_SCORE) {
+    ScoringScheme scheme;
+    scheme.size = 5;
+    std::fill(scheme.code, scheme.code + 256, 4);
+    const char* bases = "ACGT";
+    for (int k = 0; k < 4; ++k) {
+        scheme.code[(unsigned char)bases[k]] = k;
+        scheme.code[(unsigned char)std::tolower(bases[k])] = k;
+    }
+    fillIdentity(scheme, match, mismatch);
+    scheme.finish();
+    return scheme;
+}
+
+//codes are the positions in letters, every other character is the code of unknown
+inline void fillLetterCodes(ScoringScheme& scheme, const std::string& letters, char unknown) {
+    scheme.size = letters.length();
+    int unknownCode = letters.find(unknown);
+    std::fill(scheme.code, scheme.code + 256, unknownCode);
+    for (int k = 0; k < (int)letters.length(); ++k) {
+        scheme.code[(unsigned char)letters[k]] = k;
+        scheme.code[(unsigned char)std::tolower(letters[k])] = k;
+    }
+}
+
+//BLOSUM62, letters outside BLOSUM_LETTERS score as X
+inline ScoringScheme blosum62Scheme() {
+    static const int blosum62[24][24] = {
+        { 4, -1, -2, -2,  0, -1, -1,  0, -2, -1, -1, -1, -1, -2, -1,  1,  0, -3, -2,  0, -2, -1,  0, -4},
+        {-1,  5,  0, -2, -3,  1,  0, -2,  0, -3, -2,  2, -1, -3, -2, -1, -1, -3, -2, -3, -1,  0, -1, -4},
+        {-2,  0,  6,  1, -3,  0,  0,  0,  1, -3, -3,  0, -2, -3, -2,  1,  0, -4, -2, -3,  3,  0, -1, -4},
+        {-2, -2,  1,  6, -3,  0,  2, -1, -1, -3, -4, -1, -3, -3, -1,  0, -1, -4, -3, -3,  4,  1, -1, -4},
+        { 0, -3, -3, -3,  9, -3, -4, -3, -3, -1, -1, -3, -1, -2, -3, -1, -1, -2, -2, -1, -3, -3, -2, -4},
+        {-1,  1,  0,  0, -3,  5,  2, -2,  0, -3, -2,  1,  0, -3, -1,  0, -1, -2, -1, -2,  0,  3, -1, -4},
+        {-1,  0,  0,  2, -4,  2,  5, -2,  0, -3, -3,  1, -2, -3, -1,  0, -1, -3, -2, -2,  1,  4, -1, -4},
+        { 0, -2,  0, -1, -3, -2, -2,  6, -2, -4, -4, -2, -3, -3, -2,  0, -2, -2, -3, -3, -1, -2, -1, -4},
+        {-2,  0,  1, -1, -3,  0,  0, -2,  8, -3, -3, -1, -2, -1, -2, -1, -2, -2,  2, -3,  0,  0, -1, -4},
+        {-1, -3, -3, -3, -1, -3, -3, -4, -3,  4,  2, -3,  1,  0, -3, -2, -1, -3, -1,  3, -3, -3, -1, -4},
+        {-1, -2, -3, -4, -1, -2, -3, -4, -3,  2,  4, -2,  2,  0, -3, -2, -1, -2, -1,  1, -4, -3, -1, -4},
+        {-1,  2,  0, -1, -3,  1,  1, -2, -1, -3, -2,  5, -1, -3, -1,  0, -1, -3, -2, -2,  0,  1, -1, -4},
+        {-1, -1, -2, -3, -1,  0, -2, -3, -2,  1,  2, -1,  5,  0, -2, -1, -1, -1, -1,  1, -3, -1, -1, -4},
+        {-2, -3, -3, -3, -2, -3, -3, -3, -1,  0,  0, -3,  0,  6, -4, -2, -2,  1,  3, -1, -3, -3, -1, -4},
+        {-1, -2, -2, -1, -3, -1, -1, -2, -2, -3, -3, -1, -2, -4,  7, -1, -1, -4, -3, -2, -2, -1, -2, -4},
+        { 1, -1,  1,  0, -1,  0,  0,  0, -1, -2, -2,  0, -1, -2, -1,  4,  1, -3, -2, -2,  0,  0,  0, -4},
+        { 0, -1,  0, -1, -1, -1, -1, -2, -2, -1, -1, -1, -1, -2, -1,  1,  5, -2, -2,  0, -1, -1,  0, -4},
+        {-3, -3, -4, -4, -2, -2, -3, -2, -2, -3, -2, -3, -1,  1, -4, -3, -2, 11,  2, -3, -4, -3, -2, -4},
+        {-2, -2, -2, -3, -2, -1, -2, -3,  2, -1, -1, -2, -1,  3, -3, -2, -2,  2,  7, -1, -3, -2, -1, -4},
+        { 0, -3, -3, -3, -1, -2, -2, -3, -3,  3,  1, -2,  1, -1, -2, -2,  0, -3, -1,  4, -3, -2, -1, -4},
+        {-2, -1,  3,  4, -3,  0,  1, -1,  0, -3, -4,  0, -3, -3, -2,  0, -1, -4, -3, -3,  4,  1, -1, -4},
+        {-1,  0,  0,  1, -3,  3,  4, -2,  0, -3, -3,  1, -1, -3, -1,  0, -1, -3, -2, -2,  1,  4, -1, -4},
+        { 0, -1, -1, -1, -2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -2,  0,  0, -2, -1, -1, -1, -1, -1, -4},
+        {-4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4,  1}
+    };
+
+    ScoringScheme scheme;
+    fillLetterCodes(scheme, BLOSUM_LETTERS, 'X');
+    fillIdentity(scheme, 0, 0);
+    for (int a = 0; a < 24; ++a) {
+        for (int b = 0; b < 24; ++b) {
+            scheme.sub[a][b] = blosum62[a][b];
+        }
+    }
+    scheme.finish();
+    return scheme;
+}
+
+//reads a matrix in the NCBI format (PAM250, BLOSUM45, ...): '#' comments, a line with the letters,
+//then one line per letter, starting with the letter and followed by its scores in the same order
+//letters that are not in the file score as X if the file has X, otherwise as the first letter
+inline bool loadScoringScheme(const std::string& filename, ScoringScheme& scheme) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open scoring matrix " << filename << std::endl;
+        return false;
+    }
+
+    std::string letters;
+    std::vector<std::vector<int>> rows;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        if (letters.empty()) {
+            std::string letter;
+            while (fields >> letter) {
+                letters += letter[0];
+            }
+            continue;
+        }
+        std::string letter;
+        fields >> letter;
+        std::vector<int> row;
+        int value;
+        while (fields >> value) {
+            row.push_back(value);
+        }
+        if (letter.empty()) {
+            continue;
+        }
+        if (row.size() != letters.length() || letter[0] != letters[rows.size()]) {
+            std::cerr << "Error: Row " << letter << " of " << filename << " does not match the header" << std::endl;
+            return false;
+        }
+        rows.push_back(row);
+    }
+
+    if (letters.empty() || rows.size() != letters.length() || (int)letters.length() > SCORE_ALPHABET) {
+        std::cerr << "Error: " << filename << " is not a square matrix of at most " << SCORE_ALPHABET << " letters" << std::endl;
+        return false;
+    }
+
+    fillLetterCodes(scheme, letters, (letters.find('X') != std::string::npos) ? 'X' : letters[0]);
+    fillIdentity(scheme, 0, 0);
+    for (size_t a = 0; a < rows.size(); ++a) {
+        for (size_t b = 0; b < rows.size(); ++b) {
+            scheme.sub[a][b] = rows[a][b];
+        }
+    }
+    scheme.finish();
+    return true;
+}
+
+//"default" (matchMismatchScheme), "dna", "blosum62", or the path of a matrix file
+inline bool scoringSchemeByName(const std::string& name, ScoringScheme& scheme) {
+    if (name == "default") {
+        scheme = matchMismatchScheme();
+    } else if (name == "dna") {
+        scheme = dnaScheme();
+    } else if (name == "blosum62") {
+        scheme = blosum62Scheme();
+    } else {
+        return loadScoringScheme(name, scheme);
+    }
+    return true;
+}
+
+//what the engines use when they are not given a scheme
+inline const ScoringScheme& defaultScheme() {
+    static const ScoringScheme scheme = matchMismatchScheme();
+    return scheme;
+}
+
+//bits (sign included) a score of the pair can need in the syst kernel, compare with SCORE_BITS
+//no cell beats the shorter sequence matching all the way at maxScore, and nothing goes below a gap or the worst substitution
+inline int scoreBitsNeeded(const ScoringScheme& scheme, size_t len1, size_t len2) {
+    long long high = (long long)std::min(len1, len2) * std::max(scheme.maxScore, 0);
+    long long low = std::min({(long long)scheme.minScore, (long long)GAP_SCORE, (long long)GAP_OPEN});
+    int bits = 2;
+    while (high > (1LL << (bits - 1)) - 1 || low < -(1LL << (bits - 1))) {
+        bits++;
+    }
+    return bits;
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef AFFINE_GAP_HPP
+#define AFFINE_GAP_HPP
+
+#include <algorithm>
+#include <string>
+#include "../defines.hpp"
+#include "../scoring.hpp"
+
+//Gotoh helpers for the CPU baselines, only used with AFFINE_GAP
+//E is the gap coming from the left (j - 1), F is the gap coming from above (i - 1)
+//the fills keep E and F next to the cells they are working on (one per row / column), the matrices still only hold H,
+//so the backtrack works the gap lengths out from H:
+//  a gap of length k ends at (i, j) if H[i][j] == H[i - k][j] + GAP_OPEN + (k - 1) * GAP_EXTEND (or k cells to the left)
+//  the shortest k is taken, so a gap is only extended when opening it later does not give the score
+
+//one cell, gapE comes in as E of the left cell and gapF as F of the cell above, both leave as this cell's
+inline int gotohCell(int diagScore, int leftScore, int aboveScore, int& gapE, int& gapF) {
+    gapE = std::max({0, leftScore + GAP_OPEN, gapE + GAP_EXTEND});
+    gapF = std::max({0, aboveScore + GAP_OPEN, gapF + GAP_EXTEND});
+    return std::max({0, diagScore, gapE, gapF});
+}
+
+//length of the gap that ends in a cell with score h, back(k) is H k cells back along the gap
+//0 if no gap ends there
+//limit is how far back the matrix goes, and no cell is above maxScore, so the search stops once the start would have to be
+template <typename Back>
+int affineGapLength(int h, int limit, int maxScore, Back back) {
+    for (int k = 1; k <= limit; ++k) {
+        int start = h - GAP_OPEN - (k - 1) * GAP_EXTEND;
+        if (start > maxScore) {
+            return 0;
+        }
+        if (back(k) == start) {
+            return k;
+        }
+    }
+    return 0;
+}
+
+//backtrack from the max cell (i, j) on H alone, score(i, j) is H with row and column 0 at 0
+//the aligned strings come out reversed, like the linear backtracks
+//preference is the same as the linear backtracks: diagonal, then up (gap in seq2), then left (gap in seq1)
+template <typename Score>
+void affineBacktrack(Score score, const ScoringScheme& scheme, const char* seq1, const char* seq2, int i, int j,
+                     std::string& alignedSeq1, std::string& alignedSeq2) {
+    const int maxScore = (i > 0 && j > 0) ? score(i, j) : 0;
+    //BACKTRACKING
+    while (i > 0 && j > 0 && score(i, j) > 0)
+    {
+        int h = score(i, j);
+        if (h == score(i - 1, j - 1) + scheme.score(seq1[i - 1], seq2[j - 1]))
+        {
+            alignedSeq1 += seq1[i - 1];
+            alignedSeq2 += seq2[j - 1];
+            i--;
+            j--;
+            continue;
+        }
+        int up = affineGapLength(h, i, maxScore, [&](int k) { return score(i - k, j); });
+        if (up > 0)
+        {
+            for (int k = 0; k < up; ++k) {
+                alignedSeq1 += seq1[i - 1];
+                alignedSeq2 += '-';
+                i--;
+            }
+        }
+        else // H[i][j] == E[i][j]
+        {
+            int left = affineGapLength(h, j, maxScore, [&](int k) { return score(i, j - k); });
+            for (int k = 0; k < left; ++k) {
+                alignedSeq1 += '-';
+                alignedSeq2 += seq2[j - 1];
+                j--;
+            }
+        }
+    }
+}
+
+#endif
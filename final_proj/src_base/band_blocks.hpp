@@ -0,0 +1,82 @@
+#ifndef BAND_BLOCKS_HPP
+#define BAND_BLOCKS_HPP
+
+#include <algorithm>
+#include <vector>
+#include "../band.hpp"
+#include "score_matrix.hpp"
+
+//the band (band.hpp) on the blocked engines that keep the whole ScoreMatrix, base_basic and base_wave
+//seq1 is down the rows, so the band's diagonal goes into bandTileRange() the other way round
+//the blocks the band skips are never written, so the cells around the blocks it crosses are zeroed instead,
+//every block then reads its edges like it always does
+
+//the blocks of every block row the band crosses, lo[x] to hi[x], no rows is the whole matrix
+struct BlockRanges {
+    std::vector<int> lo;
+    std::vector<int> hi;
+    int tileDim;
+
+    bool full() const { return lo.empty(); }
+
+    bool has(int block_num_x, int block_num_y) const {
+        if (full()) {
+            return true;
+        }
+        return block_num_x >= 0 && block_num_x < (int)lo.size() && block_num_y >= lo[block_num_x] && block_num_y <= hi[block_num_x];
+    }
+
+    //a block with neither the block above nor the one to the left in the band still reads the corner of the one above and to the left
+    bool cornerDep(int block_num_x, int block_num_y) const {
+        return !full() && has(block_num_x - 1, block_num_y - 1) && !has(block_num_x - 1, block_num_y) && !has(block_num_x, block_num_y - 1);
+    }
+
+    //0 for a cell of a block the band skipped, for the gap length search of affineBacktrack, which can look past the zeroed edge
+    template <typename T>
+    int cell(const ScoreMatrix<T>& matrix, int i, int j) const {
+        if (i == 0 || j == 0 || has((i - 1) / tileDim, (j - 1) / tileDim)) {
+            return matrix[i][j];
+        }
+        return 0;
+    }
+};
+
+//blocks of block row x the band crosses when its center is `center`, all of them without a band
+inline void bandBlockRange(const Band& band, int center, int block_num_x, int tileDim, int num_blocks_seq2, int& lo, int& hi) {
+    if (!band.on()) {
+        lo = 0;
+        hi = num_blocks_seq2 - 1;
+        return;
+    }
+    bandTileRange(block_num_x, tileDim, num_blocks_seq2, -center, band.width, lo, hi);
+}
+
+//zeroes what block row x (blocks lo to hi) reads from blocks the band skipped:
+//the bottom row of the blocks above that are not in aboveLo to aboveHi, and the right column of the block before lo
+//the corner of block lo is on the bottom row of the block above lo - 1, so that is zeroed or written as well
+template <typename T>
+void zeroBandEdges(ScoreMatrix<T>& matrix, int block_num_x, int lo, int hi, int aboveLo, int aboveHi, int tileDim,
+                   size_t size1, size_t size2) {
+    if (lo > hi) {
+        return;
+    }
+    int start_i = block_num_x * tileDim + 1;
+    int end_i = std::min(start_i + tileDim - 1, (int)size1);
+    if (block_num_x > 0) {
+        for (int block_num_y = std::max(lo - 1, 0); block_num_y <= hi; ++block_num_y) {
+            if (block_num_y >= aboveLo && block_num_y <= aboveHi) {
+                continue;
+            }
+            int start_j = block_num_y * tileDim + 1;
+            int end_j = std::min(start_j + tileDim - 1, (int)size2);
+            std::fill(matrix[start_i - 1] + start_j, matrix[start_i - 1] + end_j + 1, 0);
+        }
+    }
+    if (lo > 0) {
+        for (int i = start_i; i <= end_i; ++i) {
+            matrix[i][lo * tileDim] = 0;
+        }
+    }
+}
+
+#endif
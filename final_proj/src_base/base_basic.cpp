@@ -3,6 +3,13 @@
 #include <bits/stdc++.h>
 #include "base_main.hpp"
 #include "../defines.hpp"
+#include "score_matrix.hpp"
+#include "score_only.hpp"
+#include "affine_gap.hpp"
+#include "query_profile.hpp"
+#include "tile_dim.hpp"
+#include "band_blocks.hpp"
+#include "xdrop_blocks.hpp"
 
 using namespace std;
 
@@ -10,8 +17,11 @@ using namespace std;
 //written in a lab for a previous class
 
 //start and end are inclusive
+//with AFFINE_GAP, gapE[i] is E of the last column done in row i and gapF[j] is F of the last row done in column j,
+//so a block picks up the gaps of the blocks to its left and above, unused otherwise
+template <typename T>
 std::tuple<int, int, int> process_block(int start_i, int end_i, int start_j, int end_j, 
-                   std::vector<std::vector<int>>& matrix, const std::string& seq1, const std::string& seq2) {
+                   ScoreMatrix<T>& matrix, const char* seq1, const QueryProfile& profile, int* gapE, int* gapF) {
 
     int maxScore = 0;
     int maxI = 0;
@@ -19,14 +29,19 @@ std::tuple<int, int, int> process_block(int start_i, int end_i, int start_j, int
 
     for (size_t i = start_i; i <= end_i; ++i)
     {
+        const int* profileRow = profile.row(seq1[i - 1]);
         for (size_t j = start_j; j <= end_j; ++j)
         {
             
-            int matchScore = (seq1[i - 1] == seq2[j - 1]) ? MATCH_SCORE : MISMATCH_SCORE;
-            matrix[i][j] = std::max({0,
-                                    matrix[i - 1][j - 1] + matchScore,
-                                    matrix[i - 1][j] + GAP_SCORE,
-                                    matrix[i][j - 1] + GAP_SCORE});
+            int matchScore = profileRow[j];
+            #ifdef AFFINE_GAP
+                matrix[i][j] = gotohCell(matrix[i - 1][j - 1] + matchScore, matrix[i][j - 1], matrix[i - 1][j], gapE[i], gapF[j]);
+            #else
+                matrix[i][j] = std::max({0,
+                                        matrix[i - 1][j - 1] + matchScore,
+                                        matrix[i - 1][j] + GAP_SCORE,
+                                        matrix[i][j - 1] + GAP_SCORE});
+            #endif
             if (matrix[i][j] > maxScore)
             {
                 maxScore = matrix[i][j];
@@ -38,38 +53,82 @@ std::tuple<int, int, int> process_block(int start_i, int end_i, int start_j, int
     return std::make_tuple(maxScore, maxI, maxJ);
 }
 
-std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1, const char *seq2, size_t size2) {
+template <typename T, int TileDim>
+std::pair<std::string, std::string> smithWatermanCells(const char *seq1, size_t size1, const char *seq2, size_t size2,
+                                                       const ScoringScheme& scheme, const Band& band, int xDrop) {
 
     //MATRIX ALLOCATION
-    std::vector<std::vector<int>> score(size1 + 1, std::vector<int>(size2 + 1, 0));
+    ScoreMatrix<T> score(size1 + 1, size2 + 1);
+    QueryProfile profile(scheme, seq1, size1, seq2, size2);
 
     int maxScore = 0;
     int maxI = 0, maxJ = 0;
     std::tuple<int, int, int> block_out;
 
+    //gap scores on the edge of the blocks done so far, only with AFFINE_GAP
+    std::vector<int> gapE, gapF;
+    #ifdef AFFINE_GAP
+        gapE.assign(size1 + 1, 0);
+        gapF.assign(size2 + 1, 0);
+    #endif
+
     //PROCESSING
-    for (size_t start_i = 1; start_i < size1; start_i += BASELINE_TILE_DIM) {
-        for (size_t start_j = 1; start_j < size2; start_j += BASELINE_TILE_DIM) {
-            int end_i = min(start_i + BASELINE_TILE_DIM - 1, size1);
-            int end_j = min(start_j + BASELINE_TILE_DIM - 1, size2);
+    //with a band only the blocks it crosses (band_blocks.hpp), and with xDrop not the ones behind dead blocks (xdrop_blocks.hpp)
+    int num_blocks_seq2 = (size2 + TileDim - 1) / TileDim;
+    BlockRanges ranges = {{}, {}, TileDim};
+    XDropBlocks xdrop(xDrop, (size1 + TileDim - 1) / TileDim, num_blocks_seq2, TileDim);
+    int center = band.center;
+    int above_lo = 0, above_hi = num_blocks_seq2 - 1;
+    for (size_t start_i = 1; start_i <= size1; start_i += TileDim) {
+        int block_num_x = (start_i - 1) / TileDim;
+        int block_lo, block_hi;
+        bandBlockRange(band, center, block_num_x, TileDim, num_blocks_seq2, block_lo, block_hi);
+        if (band.on()) {
+            zeroBandEdges(score, block_num_x, block_lo, block_hi, above_lo, above_hi, TileDim, size1, size2);
+            ranges.lo.push_back(block_lo);
+            ranges.hi.push_back(block_hi);
+        }
+        for (int block_num_y = block_lo; block_num_y <= block_hi; ++block_num_y) {
+            size_t start_j = block_num_y * TileDim + 1;
+            int end_i = min(start_i + TileDim - 1, size1);
+            int end_j = min(start_j + TileDim - 1, size2);
+            #ifdef AFFINE_GAP
+                //F left in the column by a block the band has moved off since, the block above this one is 0
+                if (block_num_y < above_lo || block_num_y > above_hi) {
+                    std::fill(gapF.begin() + start_j, gapF.begin() + end_j + 1, 0);
+                }
+            #endif
+            if (!xdrop.enter(ranges, block_num_x, block_num_y)) {
+                xdrop.zeroEdges(score, block_num_x, block_num_y, size1, size2, gapE.data(), gapF.data());
+                continue;
+            }
             //std::cout << start_i << "_" << end_i << "|" << start_j << "_" << end_j << std::endl;
-            block_out = process_block(start_i, end_i, start_j, end_j, score, seq1, seq2);
+            block_out = process_block(start_i, end_i, start_j, end_j, score, seq1, profile, gapE.data(), gapF.data());
+            xdrop.leave(score, block_num_x, block_num_y, std::get<0>(block_out), size1, size2);
             if (std::get<0>(block_out) > maxScore) {
                 maxScore = std::get<0>(block_out);
                 maxI = std::get<1>(block_out);
                 maxJ = std::get<2>(block_out);
             }
         }
+        above_lo = block_lo;
+        above_hi = block_hi;
+        if (band.adaptive && maxScore > 0) {
+            center = maxJ - maxI;
+        }
     }
 
 
     //backtrack to find the aligned sequences
     std::string alignedSeq1, alignedSeq2;
+    #ifdef AFFINE_GAP
+        affineBacktrack([&](int i, int j) { return xdrop.cell(ranges, score, i, j); }, scheme, seq1, seq2, maxI, maxJ, alignedSeq1, alignedSeq2);
+    #else
     size_t i = maxI, j = maxJ;
     //BACKTRACKING
     while (i > 0 && j > 0 && score[i][j] > 0)
     {
-        if (score[i][j] == score[i - 1][j - 1] + ((seq1[i - 1] == seq2[j - 1]) ? MATCH_SCORE : MISMATCH_SCORE))
+        if (score[i][j] == score[i - 1][j - 1] + scheme.score(seq1[i - 1], seq2[j - 1]))
         {
             alignedSeq1 += seq1[i - 1];
             alignedSeq2 += seq2[j - 1];
@@ -89,10 +148,28 @@ std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1
             j--;
         }
     }
+    #endif
 
     //reverse the aligned sequences
     std::reverse(alignedSeq1.begin(), alignedSeq1.end());
     std::reverse(alignedSeq2.begin(), alignedSeq2.end());
 
     return {alignedSeq1, alignedSeq2}; // Return the aligned sequences
-}
\ No newline at end of file
+}
+
+std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1, const char *seq2, size_t size2,
+                                                  const ScoringScheme& scheme, int tileDim, const Band& band, int xDrop) {
+    return withTileDim(tileDim, [&](auto tile) {
+        //half the memory traffic when the scores fit
+        if (scoreFitsInt16(size1, size2, scheme.maxScore)) {
+            return smithWatermanCells<int16_t, decltype(tile)::value>(seq1, size1, seq2, size2, scheme, band, xDrop);
+        }
+        return smithWatermanCells<int, decltype(tile)::value>(seq1, size1, seq2, size2, scheme, band, xDrop);
+    });
+}
+
+//score only, two rolling rows instead of the matrix
+ScoreResult smithWatermanScore(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest,
+                               const ScoringScheme& scheme, int tileDim) {
+    return rollingRowScore(seq1, size1, seq2, size2, secondBest, scheme, tileDim);
+}
@@ -0,0 +1,242 @@
+#ifndef BASE_BATCH_HPP
+#define BASE_BATCH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "base_main.hpp"
+#include "score_matrix.hpp"
+#include "affine_gap.hpp"
+#include "tile_dim.hpp"
+#include "../defines.hpp"
+
+//batch alignment of many independent pairs, on top of whichever smithWaterman() backend is linked
+//short pairs are aligned BATCH_LANES at a time, one pair per SIMD lane (inter-sequence), so the
+//per pair overhead (allocation, max merge, backtrack setup) is paid once per group instead of once per pair
+//longer pairs go through smithWaterman() one at a time
+//groups and long pairs are spread over the OpenMP threads, biggest first so a long pair is not left for the end
+//the alignments are the same as base_basic's
+
+//pairs where both sequences are at most this long share vectors
+//a group keeps its whole (rows x cols x BATCH_LANES) matrix for the backtrack, 256 keeps it at a few MB
+#define BATCH_SHORT_LEN 256
+
+#if defined(__AVX512BW__)
+    #define BATCH_VEC_BYTES 64
+#elif defined(__AVX2__)
+    #define BATCH_VEC_BYTES 32
+#else
+    #define BATCH_VEC_BYTES 16
+#endif
+//16 bit lanes, BATCH_SHORT_LEN * the best substitution score has to fit (checked in smithWatermanBatch)
+#define BATCH_LANES (BATCH_VEC_BYTES / 2)
+
+typedef int16_t batch_vec_t __attribute__((vector_size(BATCH_VEC_BYTES)));
+typedef char batch_chars_t __attribute__((vector_size(BATCH_LANES)));
+
+typedef std::pair<std::string, std::string> SequencePair;
+
+//aligns up to BATCH_LANES short pairs at once, lane k is pairs[ids[k]]
+//the lanes share one (rows + 1) x (cols + 1) matrix of vectors, rows and cols are the longest sequences of the group
+//cells past the end of a lane's sequences are computed but never read by that lane's real cells or its max
+//a uniform scheme compares codes, anything else looks every lane up in the substitution matrix
+template <int TileDim>
+void align_lane_group(const std::vector<SequencePair>& pairs, const int* ids, int count, const ScoringScheme& scheme,
+                             std::vector<SequencePair>& out) {
+    int rows = 0, cols = 0;
+    //empty lanes have size 0, so none of their cells count
+    batch_vec_t size1v = {}, size2v = {};
+    for (int k = 0; k < count; ++k) {
+        size1v[k] = pairs[ids[k]].first.length();
+        size2v[k] = pairs[ids[k]].second.length();
+        rows = std::max(rows, (int)size1v[k]);
+        cols = std::max(cols, (int)size2v[k]);
+    }
+
+    //codes of every row / column, one lane per pair, padded with code 0
+    std::vector<batch_chars_t> seq1Chars(rows), seq2Chars(cols);
+    for (int k = 0; k < BATCH_LANES; ++k) {
+        const std::string* s1 = (k < count) ? &pairs[ids[k]].first : nullptr;
+        const std::string* s2 = (k < count) ? &pairs[ids[k]].second : nullptr;
+        for (int i = 0; i < rows; ++i) {
+            seq1Chars[i][k] = (s1 != nullptr && i < (int)s1->length()) ? scheme.encode((*s1)[i]) : 0;
+        }
+        for (int j = 0; j < cols; ++j) {
+            seq2Chars[j][k] = (s2 != nullptr && j < (int)s2->length()) ? scheme.encode((*s2)[j]) : 0;
+        }
+    }
+
+    const size_t stride = cols + 1;
+    batch_vec_t* cells = (batch_vec_t*)ScoreArena::local().reserve(sizeof(batch_vec_t) * (rows + 1) * stride);
+    auto cell = [&](int i, int j) -> batch_vec_t& { return cells[i * stride + j]; };
+    const batch_vec_t zero = {};
+    const bool uniform = scheme.uniform;
+    const int16_t matchScoreDiff = scheme.matchScore - scheme.mismatchScore;
+    const int16_t mismatchScore = scheme.mismatchScore;
+    for (int j = 0; j <= cols; ++j) {
+        cell(0, j) = zero;
+    }
+    for (int i = 1; i <= rows; ++i) {
+        cell(i, 0) = zero;
+    }
+
+    //PROCESSING
+    //same block order as base_basic, so the first strictly greater cell of every lane is the same max cell
+    batch_vec_t maxScore = zero, maxI = zero, maxJ = zero;
+    #ifdef AFFINE_GAP
+        //E of the last column done in every row, F of the last row done in every column
+        std::vector<batch_vec_t> gapE(rows + 1, zero), gapF(cols + 1, zero);
+    #endif
+    for (int start_i = 1; start_i <= rows; start_i += TileDim) {
+        for (int start_j = 1; start_j <= cols; start_j += TileDim) {
+            int end_i = std::min(start_i + TileDim - 1, rows);
+            int end_j = std::min(start_j + TileDim - 1, cols);
+            for (int i = start_i; i <= end_i; ++i) {
+                const batch_vec_t iv = zero + (int16_t)i;
+                const batch_vec_t rowValid = iv <= size1v;
+                for (int j = start_j; j <= end_j; ++j) {
+                    batch_vec_t matchScore;
+                    if (uniform) {
+                        batch_vec_t isMatch = __builtin_convertvector(seq1Chars[i - 1] == seq2Chars[j - 1], batch_vec_t);
+                        matchScore = (isMatch & matchScoreDiff) + mismatchScore;
+                    } else {
+                        for (int k = 0; k < BATCH_LANES; ++k) {
+                            matchScore[k] = scheme.sub[(unsigned char)seq1Chars[i - 1][k]][(unsigned char)seq2Chars[j - 1][k]];
+                        }
+                    }
+                    batch_vec_t score = cell(i - 1, j - 1) + matchScore;
+                    score = (score > zero) ? score : zero;
+                    #ifdef AFFINE_GAP
+                        batch_vec_t gap = cell(i, j - 1) + GAP_OPEN;
+                        batch_vec_t extend = gapE[i] + GAP_EXTEND;
+                        gapE[i] = (extend > gap) ? extend : gap;
+                        gapE[i] = (gapE[i] > zero) ? gapE[i] : zero;
+                        gap = cell(i - 1, j) + GAP_OPEN;
+                        extend = gapF[j] + GAP_EXTEND;
+                        gapF[j] = (extend > gap) ? extend : gap;
+                        gapF[j] = (gapF[j] > zero) ? gapF[j] : zero;
+                        score = (score > gapE[i]) ? score : gapE[i];
+                        score = (score > gapF[j]) ? score : gapF[j];
+                    #else
+                        batch_vec_t gap = cell(i - 1, j) + GAP_SCORE;
+                        score = (score > gap) ? score : gap;
+                        gap = cell(i, j - 1) + GAP_SCORE;
+                        score = (score > gap) ? score : gap;
+                    #endif
+                    cell(i, j) = score;
+
+                    const batch_vec_t jv = zero + (int16_t)j;
+                    batch_vec_t better = rowValid & (jv <= size2v) & (score > maxScore);
+                    maxScore = better ? score : maxScore;
+                    maxI = better ? iv : maxI;
+                    maxJ = better ? jv : maxJ;
+                }
+            }
+        }
+    }
+
+    //backtrack every lane on its own
+    for (int k = 0; k < count; ++k) {
+        const std::string& seq1 = pairs[ids[k]].first;
+        const std::string& seq2 = pairs[ids[k]].second;
+        std::string alignedSeq1, alignedSeq2;
+        #ifdef AFFINE_GAP
+            affineBacktrack([&](int i, int j) { return (int)cell(i, j)[k]; }, scheme, seq1.c_str(), seq2.c_str(), maxI[k], maxJ[k],
+                            alignedSeq1, alignedSeq2);
+        #else
+        int i = maxI[k], j = maxJ[k];
+        //BACKTRACKING
+        while (i > 0 && j > 0 && cell(i, j)[k] > 0)
+        {
+            if (cell(i, j)[k] == cell(i - 1, j - 1)[k] + scheme.score(seq1[i - 1], seq2[j - 1]))
+            {
+                alignedSeq1 += seq1[i - 1];
+                alignedSeq2 += seq2[j - 1];
+                i--;
+                j--;
+            }
+            else if (cell(i, j)[k] == cell(i - 1, j)[k] + GAP_SCORE)
+            {
+                alignedSeq1 += seq1[i - 1];
+                alignedSeq2 += '-';
+                i--;
+            }
+            else // score[i][j] == score[i][j - 1] + GAP_SCORE
+            {
+                alignedSeq1 += '-';
+                alignedSeq2 += seq2[j - 1];
+                j--;
+            }
+        }
+        #endif
+        std::reverse(alignedSeq1.begin(), alignedSeq1.end());
+        std::reverse(alignedSeq2.begin(), alignedSeq2.end());
+        out[ids[k]] = {alignedSeq1, alignedSeq2};
+    }
+}
+
+//aligns every pair, out[n] is the alignment of pairs[n], tileDim like smithWaterman()
+inline std::vector<SequencePair> smithWatermanBatch(const std::vector<SequencePair>& pairs,
+                                                   const ScoringScheme& scheme = defaultScheme(), int tileDim = BASELINE_TILE_DIM) {
+    std::vector<SequencePair> out(pairs.size());
+
+    //a scheme with big enough scores could overflow the 16 bit lanes, then every pair is a long one
+    const bool lanesFit = scoreFitsInt16(BATCH_SHORT_LEN, BATCH_SHORT_LEN, scheme.maxScore);
+    std::vector<int> shortIds, longIds;
+    for (int n = 0; n < (int)pairs.size(); ++n) {
+        if (lanesFit && pairs[n].first.length() <= BATCH_SHORT_LEN && pairs[n].second.length() <= BATCH_SHORT_LEN) {
+            shortIds.push_back(n);
+        } else {
+            longIds.push_back(n);
+        }
+    }
+    //pairs of similar shape go in the same group, so there is little padding
+    std::sort(shortIds.begin(), shortIds.end(), [&](int a, int b) {
+        return std::make_pair(pairs[a].first.length(), pairs[a].second.length()) <
+               std::make_pair(pairs[b].first.length(), pairs[b].second.length());
+    });
+
+    //a job is either a group of up to BATCH_LANES short pairs or a single long pair
+    struct BatchJob {
+        const int* ids;
+        int count;
+        bool group;
+        size_t cells;
+    };
+    std::vector<BatchJob> jobs;
+    for (size_t first = 0; first < shortIds.size(); first += BATCH_LANES) {
+        int count = std::min((size_t)BATCH_LANES, shortIds.size() - first);
+        size_t rows = 0, cols = 0;
+        for (int k = 0; k < count; ++k) {
+            rows = std::max(rows, pairs[shortIds[first + k]].first.length());
+            cols = std::max(cols, pairs[shortIds[first + k]].second.length());
+        }
+        jobs.push_back({&shortIds[first], count, true, rows * cols});
+    }
+    for (const int& id : longIds) {
+        jobs.push_back({&id, 1, false, pairs[id].first.length() * pairs[id].second.length()});
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const BatchJob& a, const BatchJob& b) { return a.cells > b.cells; });
+
+    //a backend that is itself parallel gets one thread here, unless nested parallelism is turned on
+    #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic, 1)
+    #endif
+    for (int n = 0; n < (int)jobs.size(); ++n) {
+        const BatchJob& job = jobs[n];
+        if (job.group) {
+            withTileDim(tileDim, [&](auto tile) {
+                align_lane_group<decltype(tile)::value>(pairs, job.ids, job.count, scheme, out);
+            });
+        } else {
+            const SequencePair& pair = pairs[job.ids[0]];
+            out[job.ids[0]] = smithWaterman(pair.first.c_str(), pair.first.length(), pair.second.c_str(), pair.second.length(),
+                                            scheme, tileDim);
+        }
+    }
+    return out;
+}
+
+#endif
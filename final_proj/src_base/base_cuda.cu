@@ -3,12 +3,25 @@
 #include <vector>
 #include <cuda_runtime.h>
 #include "../defines.hpp"
+#include "base_main.hpp"
+#include "score_only.hpp"
+
+// Substitution score of a against b, scoring is a packed ScoringScheme (see SCORING_WORDS)
+__device__ __forceinline__ int substitution(const int *__restrict__ scoring, char a, char b)
+{
+    const int *code = scoring + SCORE_ALPHABET * SCORE_ALPHABET;
+    return scoring[code[(unsigned char)a] * SCORE_ALPHABET + code[(unsigned char)b]];
+}
 
 // This kernel fills the dp matrix based on 3 of its neighbors and penalties
+// With AFFINE_GAP, gap_e and gap_f are the E and F matrices (same layout as score), unused otherwise
 __global__ void smith_waterman_kernel_optimized(
     const char *__restrict__ seq1,
     const char *__restrict__ seq2,
+    const int *__restrict__ scoring,
     int *__restrict__ score,
+    int *__restrict__ gap_e,
+    int *__restrict__ gap_f,
     int size1,
     int size2,
     int diag)
@@ -31,10 +44,8 @@ __global__ void smith_waterman_kernel_optimized(
     unsigned long long index_up = (i - 1) * (size2 + 1) + j;
     unsigned long long index_left = i * (size2 + 1) + (j - 1);
 
-    // checking miss MATCH_SCORE or MATCH_SCORE
-    char a = seq1[i - 1];
-    char b = seq2[j - 1];
-    int matchScore = (a == b) ? MATCH_SCORE : MISMATCH_SCORE;
+    // substitution score from the scheme
+    int matchScore = substitution(scoring, seq1[i - 1], seq2[j - 1]);
 
     // Use shared memory to store neighboring values
     shared_score[thread_id] = score[index_diag];
@@ -43,8 +54,16 @@ __global__ void smith_waterman_kernel_optimized(
 
     // computing all the possibilites, removed conditional statements for speed up
     int score_diag = shared_score[thread_id] + matchScore;
+#ifdef AFFINE_GAP
+    // Gotoh: the gaps either open from H or extend the E / F of the neighbour, clamped at 0 like H
+    int score_up = max(0, max(score[index_up] + GAP_OPEN, gap_f[index_up] + GAP_EXTEND));
+    int score_left = max(0, max(score[index_left] + GAP_OPEN, gap_e[index_left] + GAP_EXTEND));
+    gap_f[index] = score_up;
+    gap_e[index] = score_left;
+#else
     int score_up = score[index_up] + GAP_SCORE;
     int score_left = score[index_left] + GAP_SCORE;
+#endif
 
     //updating the matrix
     int cellScore = max(0, max(score_diag, max(score_up, score_left)));
@@ -122,10 +141,14 @@ __global__ void find_max_score_kernel(
 }
 
 // Traceback kernel to generate alignment paths
+// With AFFINE_GAP it follows the gaps through gap_e / gap_f, leaving a gap as soon as opening it there gives the score
 __global__ void traceback_kernel(
     const char *__restrict__ seq1,
     const char *__restrict__ seq2,
+    const int *__restrict__ scoring,
     int *__restrict__ score,
+    int *__restrict__ gap_e,
+    int *__restrict__ gap_f,
     int max_i,
     int max_j,
     int size1,
@@ -143,16 +166,52 @@ __global__ void traceback_kernel(
         // Temporary arrays to store alignment (will be reversed later)
         char temp_seq1[10000]; // Assuming max length, adjust as needed
         char temp_seq2[10000];
-        
+
+#ifdef AFFINE_GAP
+        // 0 = on H, 1 = in a gap going up, 2 = in a gap going left
+        int state = 0;
+        while (i > 0 && j > 0 && score[i * (size2 + 1) + j] > 0) {
+            int current_idx = i * (size2 + 1) + j;
+            int diag_idx = (i - 1) * (size2 + 1) + (j - 1);
+            int up_idx = (i - 1) * (size2 + 1) + j;
+            int left_idx = i * (size2 + 1) + (j - 1);
+
+            if (state == 0) {
+                int match_score = substitution(scoring, seq1[i - 1], seq2[j - 1]);
+                if (score[current_idx] == score[diag_idx] + match_score) {
+                    // Diagonal
+                    temp_seq1[idx] = seq1[i - 1];
+                    temp_seq2[idx] = seq2[j - 1];
+                    i--; j--;
+                    idx++;
+                    continue;
+                }
+                state = (score[current_idx] == gap_f[current_idx]) ? 1 : 2;
+            }
+
+            if (state == 1) {
+                // Up
+                temp_seq1[idx] = seq1[i - 1];
+                temp_seq2[idx] = '-';
+                if (gap_f[current_idx] == score[up_idx] + GAP_OPEN) state = 0;
+                i--;
+            } else {
+                // Left
+                temp_seq1[idx] = '-';
+                temp_seq2[idx] = seq2[j - 1];
+                if (gap_e[current_idx] == score[left_idx] + GAP_OPEN) state = 0;
+                j--;
+            }
+            idx++;
+        }
+#else
         while (i > 0 && j > 0 && score[i * (size2 + 1) + j] > 0) {
             int current_idx = i * (size2 + 1) + j;
             int diag_idx = (i - 1) * (size2 + 1) + (j - 1);
             int up_idx = (i - 1) * (size2 + 1) + j;
             //int left_idx = i * (size2 + 1) + (j - 1);
             
-            char a = seq1[i - 1];
-            char b = seq2[j - 1];
-            int match_score = (a == b) ? MATCH_SCORE : MISMATCH_SCORE;
+            int match_score = substitution(scoring, seq1[i - 1], seq2[j - 1]);
             
             if (score[current_idx] == score[diag_idx] + match_score) {
                 // Diagonal
@@ -172,6 +231,7 @@ __global__ void traceback_kernel(
             }
             idx++;
         }
+#endif
         
         // Reverse the alignment
         for (int k = 0; k < idx; k++) {
@@ -188,11 +248,16 @@ __global__ void traceback_kernel(
     }
 }
 
+//not blocked like the CPU baselines, tileDim, band and xDrop are only taken for the shared signature
 std::pair<std::string, std::string> smithWaterman(
     const char *seq1,
     size_t size1,
     const char *seq2,
-    size_t size2)
+    size_t size2,
+    const ScoringScheme &scheme,
+    int tileDim,
+    const Band &band,
+    int xDrop)
 {
     int device;
     cudaGetDevice(&device);
@@ -202,7 +267,9 @@ std::pair<std::string, std::string> smithWaterman(
     printf("Running on GPU %d: %s\n", device, prop.name);
     
     char *cuda_seq1, *cuda_seq2;
+    int *cuda_scoring;
     int *cuda_score;
+    int *cuda_gap_e = nullptr, *cuda_gap_f = nullptr;
     int *cuda_max_i, *cuda_max_j, *cuda_max_score;
     char *cuda_aligned_seq1, *cuda_aligned_seq2;
     int *cuda_align_length;
@@ -210,6 +277,7 @@ std::pair<std::string, std::string> smithWaterman(
     // Allocate memory on the device
     cudaMalloc((void **)&cuda_seq1, size1 * sizeof(char));
     cudaMalloc((void **)&cuda_seq2, size2 * sizeof(char));
+    cudaMalloc((void **)&cuda_scoring, SCORING_WORDS * sizeof(int));
     cudaMalloc((void **)&cuda_score, (size1 + 1) * (size2 + 1) * sizeof(int));
     cudaMalloc((void **)&cuda_max_i, sizeof(int));
     cudaMalloc((void **)&cuda_max_j, sizeof(int));
@@ -229,7 +297,16 @@ std::pair<std::string, std::string> smithWaterman(
     // Copy sequences to device
     cudaMemcpy(cuda_seq1, seq1, size1 * sizeof(char), cudaMemcpyHostToDevice);
     cudaMemcpy(cuda_seq2, seq2, size2 * sizeof(char), cudaMemcpyHostToDevice);
+    int h_scoring[SCORING_WORDS];
+    scheme.pack(h_scoring);
+    cudaMemcpy(cuda_scoring, h_scoring, SCORING_WORDS * sizeof(int), cudaMemcpyHostToDevice);
     cudaMemset(cuda_score, 0, (size1 + 1) * (size2 + 1) * sizeof(int));
+#ifdef AFFINE_GAP
+    cudaMalloc((void **)&cuda_gap_e, (size1 + 1) * (size2 + 1) * sizeof(int));
+    cudaMalloc((void **)&cuda_gap_f, (size1 + 1) * (size2 + 1) * sizeof(int));
+    cudaMemset(cuda_gap_e, 0, (size1 + 1) * (size2 + 1) * sizeof(int));
+    cudaMemset(cuda_gap_f, 0, (size1 + 1) * (size2 + 1) * sizeof(int));
+#endif
 
     // Fill score matrix in wave-front (anti-diagonal order)
     int total_diagonals = size1 + size2 - 1;
@@ -241,7 +318,7 @@ std::pair<std::string, std::string> smithWaterman(
         int blocks = (elements_in_diag + threads_per_block - 1) / threads_per_block;
 
         smith_waterman_kernel_optimized<<<blocks, threads_per_block, shared_mem_size>>>(
-            cuda_seq1, cuda_seq2, cuda_score,
+            cuda_seq1, cuda_seq2, cuda_scoring, cuda_score, cuda_gap_e, cuda_gap_f,
             size1, size2, diag);
         
         cudaDeviceSynchronize();
@@ -265,7 +342,7 @@ std::pair<std::string, std::string> smithWaterman(
     
     // Perform traceback on GPU
     traceback_kernel<<<1, 1>>>(
-        cuda_seq1, cuda_seq2, cuda_score,
+        cuda_seq1, cuda_seq2, cuda_scoring, cuda_score, cuda_gap_e, cuda_gap_f,
         max_i, max_j, size1, size2,
         cuda_aligned_seq1, cuda_aligned_seq2, cuda_align_length);
     
@@ -284,6 +361,7 @@ std::pair<std::string, std::string> smithWaterman(
     // Free device memory
     cudaFree(cuda_seq1);
     cudaFree(cuda_seq2);
+    cudaFree(cuda_scoring);
     cudaFree(cuda_score);
     cudaFree(cuda_max_i);
     cudaFree(cuda_max_j);
@@ -291,6 +369,10 @@ std::pair<std::string, std::string> smithWaterman(
     cudaFree(cuda_aligned_seq1);
     cudaFree(cuda_aligned_seq2);
     cudaFree(cuda_align_length);
+#ifdef AFFINE_GAP
+    cudaFree(cuda_gap_e);
+    cudaFree(cuda_gap_f);
+#endif
 
     // Convert to strings
     std::string alignedSeq1(h_aligned_seq1.data(), align_length);
@@ -298,3 +380,98 @@ std::pair<std::string, std::string> smithWaterman(
     
     return {alignedSeq1, alignedSeq2};
 }
+
+// Score only: same fill and max kernels, no traceback and no alignment buffers
+ScoreResult smithWatermanScore(
+    const char *seq1,
+    size_t size1,
+    const char *seq2,
+    size_t size2,
+    bool secondBest,
+    const ScoringScheme &scheme,
+    int tileDim)
+{
+    char *cuda_seq1, *cuda_seq2;
+    int *cuda_scoring;
+    int *cuda_score;
+    int *cuda_gap_e = nullptr, *cuda_gap_f = nullptr;
+    int *cuda_max_i, *cuda_max_j, *cuda_max_score;
+
+    // Allocate memory on the device
+    cudaMalloc((void **)&cuda_seq1, size1 * sizeof(char));
+    cudaMalloc((void **)&cuda_seq2, size2 * sizeof(char));
+    cudaMalloc((void **)&cuda_scoring, SCORING_WORDS * sizeof(int));
+    cudaMalloc((void **)&cuda_score, (size1 + 1) * (size2 + 1) * sizeof(int));
+    cudaMalloc((void **)&cuda_max_i, sizeof(int));
+    cudaMalloc((void **)&cuda_max_j, sizeof(int));
+    cudaMalloc((void **)&cuda_max_score, sizeof(int));
+
+    cudaMemset(cuda_max_i, 0, sizeof(int));
+    cudaMemset(cuda_max_j, 0, sizeof(int));
+    cudaMemset(cuda_max_score, 0, sizeof(int));
+    cudaMemcpy(cuda_seq1, seq1, size1 * sizeof(char), cudaMemcpyHostToDevice);
+    cudaMemcpy(cuda_seq2, seq2, size2 * sizeof(char), cudaMemcpyHostToDevice);
+    int h_scoring[SCORING_WORDS];
+    scheme.pack(h_scoring);
+    cudaMemcpy(cuda_scoring, h_scoring, SCORING_WORDS * sizeof(int), cudaMemcpyHostToDevice);
+    cudaMemset(cuda_score, 0, (size1 + 1) * (size2 + 1) * sizeof(int));
+#ifdef AFFINE_GAP
+    cudaMalloc((void **)&cuda_gap_e, (size1 + 1) * (size2 + 1) * sizeof(int));
+    cudaMalloc((void **)&cuda_gap_f, (size1 + 1) * (size2 + 1) * sizeof(int));
+    cudaMemset(cuda_gap_e, 0, (size1 + 1) * (size2 + 1) * sizeof(int));
+    cudaMemset(cuda_gap_f, 0, (size1 + 1) * (size2 + 1) * sizeof(int));
+#endif
+
+    // Fill score matrix in wave-front (anti-diagonal order)
+    int total_diagonals = size1 + size2 - 1;
+    int threads_per_block = 1024;
+    int shared_mem_size = threads_per_block * sizeof(int);
+    for (int diag = 1; diag <= total_diagonals; ++diag) {
+        int elements_in_diag = min(diag, min(static_cast<int>(size1), static_cast<int>(size2)));
+        int blocks = (elements_in_diag + threads_per_block - 1) / threads_per_block;
+        smith_waterman_kernel_optimized<<<blocks, threads_per_block, shared_mem_size>>>(
+            cuda_seq1, cuda_seq2, cuda_scoring, cuda_score, cuda_gap_e, cuda_gap_f,
+            size1, size2, diag);
+        cudaDeviceSynchronize();
+    }
+
+    int num_blocks = min(32, (int)((size1 * size2 + threads_per_block - 1) / threads_per_block));
+    int find_max_shared_mem = threads_per_block * 3 * sizeof(int);
+    find_max_score_kernel<<<num_blocks, threads_per_block, find_max_shared_mem>>>(
+        cuda_score, cuda_max_i, cuda_max_j, cuda_max_score,
+        size1, size2);
+    cudaDeviceSynchronize();
+
+    ScoreResult result = {0, 0, 0, 0};
+    cudaMemcpy(&result.maxI, cuda_max_i, sizeof(int), cudaMemcpyDeviceToHost);
+    cudaMemcpy(&result.maxJ, cuda_max_j, sizeof(int), cudaMemcpyDeviceToHost);
+    cudaMemcpy(&result.score, cuda_max_score, sizeof(int), cudaMemcpyDeviceToHost);
+
+    // The column maxes are only needed for the second best, so only then is the matrix copied back
+    if (secondBest) {
+        std::vector<int> h_score((size1 + 1) * (size2 + 1));
+        cudaMemcpy(h_score.data(), cuda_score, h_score.size() * sizeof(int), cudaMemcpyDeviceToHost);
+        std::vector<int> colMax(size2 + 1, 0);
+        for (size_t i = 1; i <= size1; ++i) {
+            for (size_t j = 1; j <= size2; ++j) {
+                colMax[j] = std::max(colMax[j], h_score[i * (size2 + 1) + j]);
+            }
+        }
+        result.secondScore = maskedSecondBest(colMax, result.maxJ, secondBestMask(size1, size2));
+    }
+
+    // Free device memory
+    cudaFree(cuda_seq1);
+    cudaFree(cuda_seq2);
+    cudaFree(cuda_scoring);
+    cudaFree(cuda_score);
+    cudaFree(cuda_max_i);
+    cudaFree(cuda_max_j);
+    cudaFree(cuda_max_score);
+#ifdef AFFINE_GAP
+    cudaFree(cuda_gap_e);
+    cudaFree(cuda_gap_f);
+#endif
+
+    return result;
+}
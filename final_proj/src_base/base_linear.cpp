@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <iostream>
+#include <bits/stdc++.h>
+#include "base_main.hpp"
+#include "../defines.hpp"
+#include "score_only.hpp"
+#include "affine_gap.hpp"
+#include "query_profile.hpp"
+
+using namespace std;
+
+//linear memory implementation, for genome length inputs
+//the forward pass only keeps one row of the score matrix
+//the backtrack recomputes rows from checkpoint rows instead of storing the matrix:
+//  the rows the path goes through are split in half, the bottom half is done first from a checkpoint at the middle row,
+//  then the top half from the checkpoint above it
+//this keeps one checkpoint row per level of recursion (log(size1) of them) plus a small block of rows at the leaves,
+//so memory is O(size1 + size2 * log(size1)) instead of O(size1 * size2)
+//the path and tie breaking are the same as base_basic, so the aligned strings are the same
+//with AFFINE_GAP every row also keeps F and E, so a checkpoint can carry the vertical gaps on,
+//and the backtrack follows the gap it is in across leaves instead of searching H for the gap length
+
+//values kept for every cell of a row, next to each other: H, then F and E with AFFINE_GAP
+//the first (c + 1) cells of a row are columns 0 to c whatever its width
+#ifdef AFFINE_GAP
+    #define LINEAR_ROW_PLANES 3
+#else
+    #define LINEAR_ROW_PLANES 1
+#endif
+
+//leaves are backtracked from a stored block of this many rows
+#define LINEAR_LEAF_ROWS BASELINE_TILE_DIM
+
+//computes row i of the score matrix from row i - 1, columns 0 to numCols
+//profileRow is the profile row of seq1[i - 1]
+void compute_row(const int* above, const int* profileRow, int numCols, int* row) {
+#ifdef AFFINE_GAP
+    std::fill(row, row + LINEAR_ROW_PLANES, 0);
+    int gapE = 0;
+    for (int j = 1; j <= numCols; ++j) {
+        int matchScore = profileRow[j];
+        int* cell = row + j * LINEAR_ROW_PLANES;
+        const int* up = above + j * LINEAR_ROW_PLANES;
+        int gapF = up[1];
+        cell[0] = gotohCell(above[(j - 1) * LINEAR_ROW_PLANES] + matchScore, cell[-LINEAR_ROW_PLANES], up[0], gapE, gapF);
+        cell[1] = gapF;
+        cell[2] = gapE;
+    }
+#else
+    row[0] = 0;
+    for (int j = 1; j <= numCols; ++j) {
+        int matchScore = profileRow[j];
+        row[j] = std::max({0,
+                           above[j - 1] + matchScore,
+                           above[j] + GAP_SCORE,
+                           row[j - 1] + GAP_SCORE});
+    }
+#endif
+}
+
+//computes row "to" from row "from", only two rows are kept
+void compute_last_row(const int* rowIn, int from, int to, int numCols, const char* seq1, const QueryProfile& profile, int* rowOut) {
+    std::vector<int> above(rowIn, rowIn + (numCols + 1) * LINEAR_ROW_PLANES);
+    std::vector<int> row((numCols + 1) * LINEAR_ROW_PLANES);
+    for (int i = from + 1; i <= to; ++i) {
+        compute_row(above.data(), profile.row(seq1[i - 1]), numCols, row.data());
+        std::swap(above, row);
+    }
+    std::copy(above.begin(), above.end(), rowOut);
+}
+
+//the backtrack is either on H or in the middle of a gap, only with AFFINE_GAP
+enum GapState { ON_SCORE, IN_GAP_UP, IN_GAP_LEFT };
+
+//walks the path from (i, j) down to row lo, where rowLo is row lo of the score matrix
+//i starts at hi
+//state is where the path is at (i, j), a vertical gap can carry on into the rows above
+//returns true once the backtrack has finished
+bool backtrack_rows(int lo, const int* rowLo, int hi, int& i, int& j, GapState& state, const char* seq1, const char* seq2,
+                    const QueryProfile& profile, std::string& alignedSeq1, std::string& alignedSeq2) {
+
+    if (hi - lo > LINEAR_LEAF_ROWS) {
+        int mid = lo + (hi - lo) / 2;
+        std::vector<int> rowMid((j + 1) * LINEAR_ROW_PLANES);
+        compute_last_row(rowLo, lo, mid, j, seq1, profile, rowMid.data());
+        if (backtrack_rows(mid, rowMid.data(), hi, i, j, state, seq1, seq2, profile, alignedSeq1, alignedSeq2)) {
+            return true;
+        }
+        rowMid.clear();
+        rowMid.shrink_to_fit();
+        //path has reached row mid, carry on above it
+        return backtrack_rows(lo, rowLo, mid, i, j, state, seq1, seq2, profile, alignedSeq1, alignedSeq2);
+    }
+
+    //leaf, store rows lo to hi, columns 0 to j
+    int numCols = j;
+    const size_t rowWidth = (size_t)(numCols + 1) * LINEAR_ROW_PLANES;
+    std::vector<int> block((size_t)(hi - lo + 1) * rowWidth);
+    std::copy(rowLo, rowLo + rowWidth, block.begin());
+    for (int r = lo + 1; r <= hi; ++r) {
+        compute_row(&block[(size_t)(r - lo - 1) * rowWidth], profile.row(seq1[r - 1]), numCols, &block[(size_t)(r - lo) * rowWidth]);
+    }
+    auto score = [&](int r, int c) { return block[(size_t)(r - lo) * rowWidth + c * LINEAR_ROW_PLANES]; };
+
+#ifdef AFFINE_GAP
+    auto gapF = [&](int r, int c) { return block[(size_t)(r - lo) * rowWidth + c * LINEAR_ROW_PLANES + 1]; };
+    auto gapE = [&](int r, int c) { return block[(size_t)(r - lo) * rowWidth + c * LINEAR_ROW_PLANES + 2]; };
+
+    //BACKTRACKING
+    //same path as affineBacktrack: a gap is left as soon as opening it there gives the score, so it is the shortest one
+    while (i > lo) {
+        if (state == ON_SCORE) {
+            if (j <= 0 || score(i, j) <= 0) {
+                return true;
+            }
+            if (score(i, j) == score(i - 1, j - 1) + profile.row(seq1[i - 1])[j])
+            {
+                alignedSeq1 += seq1[i - 1];
+                alignedSeq2 += seq2[j - 1];
+                i--;
+                j--;
+                continue;
+            }
+            state = (score(i, j) == gapF(i, j)) ? IN_GAP_UP : IN_GAP_LEFT;
+        }
+
+        if (state == IN_GAP_UP)
+        {
+            alignedSeq1 += seq1[i - 1];
+            alignedSeq2 += '-';
+            if (gapF(i, j) == score(i - 1, j) + GAP_OPEN) {
+                state = ON_SCORE;
+            }
+            i--;
+        }
+        else // IN_GAP_LEFT
+        {
+            alignedSeq1 += '-';
+            alignedSeq2 += seq2[j - 1];
+            if (gapE(i, j) == score(i, j - 1) + GAP_OPEN) {
+                state = ON_SCORE;
+            }
+            j--;
+        }
+    }
+#else
+    //BACKTRACKING
+    while (i > lo) {
+        if (j <= 0 || score(i, j) <= 0) {
+            return true;
+        }
+        if (score(i, j) == score(i - 1, j - 1) + profile.row(seq1[i - 1])[j])
+        {
+            alignedSeq1 += seq1[i - 1];
+            alignedSeq2 += seq2[j - 1];
+            i--;
+            j--;
+        }
+        else if (score(i, j) == score(i - 1, j) + GAP_SCORE)
+        {
+            alignedSeq1 += seq1[i - 1];
+            alignedSeq2 += '-';
+            i--;
+        }
+        else // score[i][j] == score[i][j - 1] + GAP_SCORE
+        {
+            alignedSeq1 += '-';
+            alignedSeq2 += seq2[j - 1];
+            j--;
+        }
+    }
+#endif
+    return i <= 0;
+}
+
+//band and xDrop are only taken for the shared signature, the checkpoint rows are whole rows
+std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1, const char *seq2, size_t size2,
+                                                  const ScoringScheme& scheme, int tileDim, const Band& band, int xDrop) {
+
+    //the forward pass is the score only pass, it only keeps two rows
+    ScoreResult forward = rollingRowScore(seq1, size1, seq2, size2, false, scheme, tileDim);
+    int maxScore = forward.score;
+    int maxI = forward.maxI, maxJ = forward.maxJ;
+
+    //backtrack to find the aligned sequences
+    std::string alignedSeq1, alignedSeq2;
+    if (maxScore > 0) {
+        int i = maxI, j = maxJ;
+        GapState state = ON_SCORE;
+        std::vector<int> zeroRow((j + 1) * LINEAR_ROW_PLANES, 0);
+        QueryProfile profile(scheme, seq1, i, seq2, j);
+        backtrack_rows(0, zeroRow.data(), maxI, i, j, state, seq1, seq2, profile, alignedSeq1, alignedSeq2);
+    }
+
+    //reverse the aligned sequences
+    std::reverse(alignedSeq1.begin(), alignedSeq1.end());
+    std::reverse(alignedSeq2.begin(), alignedSeq2.end());
+
+    return {alignedSeq1, alignedSeq2}; // Return the aligned sequences
+}
+
+ScoreResult smithWatermanScore(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest,
+                               const ScoringScheme& scheme, int tileDim) {
+    return rollingRowScore(seq1, size1, seq2, size2, secondBest, scheme, tileDim);
+}
@@ -6,9 +6,24 @@
 #include <numeric>
 #include <algorithm>
 #include "base_main.hpp"
+#include "base_batch.hpp"
+#include "tile_dim.hpp"
 #include <sstream>
 #include "../defines.hpp"
 #include <cstring>
+#include <sys/resource.h>
+
+// Scoring scheme every alignment uses, set with -m
+ScoringScheme scoringScheme = matchMismatchScheme();
+
+// Block size of the blocked engines, set with -t
+int tileDim = BASELINE_TILE_DIM;
+
+// Band the blocked engines stay in, set with -w, -d and -r, the whole matrix by default
+Band band = fullBand();
+
+// X-drop of the blocked engines, set with -x, off (-1) by default
+int xDrop = -1;
 
 // Structure to hold test data
 struct TestCase {
@@ -97,7 +112,7 @@ double runTestCase(const TestCase& testCase, bool printOutput = true, bool skipV
     auto start = std::chrono::high_resolution_clock::now();
     
     // Run Smith-Waterman algorithm
-    std::pair<std::string, std::string> out = smithWaterman(seq1Ptr, size1, seq2Ptr, size2);
+    std::pair<std::string, std::string> out = smithWaterman(seq1Ptr, size1, seq2Ptr, size2, scoringScheme, tileDim, band, xDrop);
     
     // End timing
     auto end = std::chrono::high_resolution_clock::now();
@@ -161,12 +176,121 @@ double runTestCase(const TestCase& testCase, bool printOutput = true, bool skipV
     return duration.count();
 }
 
+// Score of an alignment, used to check score only runs against the expected alignment
+int alignmentScore(const std::string& aligned1, const std::string& aligned2) {
+    int total = 0;
+    for (size_t k = 0; k < aligned1.length() && k < aligned2.length(); k++) {
+        if (aligned1[k] == '-' || aligned2[k] == '-') {
+            #ifdef AFFINE_GAP
+                //a gap carries on if the column before has its gap in the same sequence
+                bool extends = k > 0 && ((aligned1[k] == '-' && aligned1[k - 1] == '-') ||
+                                         (aligned2[k] == '-' && aligned2[k - 1] == '-'));
+                total += extends ? GAP_EXTEND : GAP_OPEN;
+            #else
+                total += GAP_SCORE;
+            #endif
+        } else {
+            total += scoringScheme.score(aligned1[k], aligned2[k]);
+        }
+    }
+    return total;
+}
+
+// Function to run a single test case in score only mode and return execution time
+double runScoreTestCase(const TestCase& testCase, bool printOutput = true, bool skipVerification = false) {
+    // Start timing
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Only the score, its end cell and the second best score
+    ScoreResult out = smithWatermanScore(testCase.seq1.c_str(), testCase.seq1.length(),
+                                         testCase.seq2.c_str(), testCase.seq2.length(), true, scoringScheme, tileDim);
+
+    // End timing
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    if (printOutput) {
+        std::cout << "Score     : " << out.score << " ending at (" << out.maxI << ", " << out.maxJ << ")" << std::endl;
+        std::cout << "Second    : " << out.secondScore << std::endl;
+
+        // The expected alignment gives the expected score
+        if (!skipVerification && !testCase.expectedAligned1.empty() && !testCase.expectedAligned2.empty()) {
+            int expectedScore = alignmentScore(testCase.expectedAligned1, testCase.expectedAligned2);
+            std::cout << "Expected  : " << expectedScore << std::endl;
+            if (out.score != expectedScore) {
+                std::cout << "Output does not match expected result!" << std::endl;
+            } else {
+                std::cout << "Output matches expected result." << std::endl;
+            }
+        }
+    }
+
+    return duration.count();
+}
+
+// Function to align every test case in one smithWatermanBatch() call and return execution time
+double runBatch(const std::vector<TestCase>& testCases, bool printOutput = true, bool skipVerification = false) {
+    std::vector<SequencePair> pairs;
+    pairs.reserve(testCases.size());
+    for (const TestCase& testCase : testCases) {
+        pairs.push_back({testCase.seq1, testCase.seq2});
+    }
+
+    // Start timing
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // Run Smith-Waterman on every pair
+    std::vector<SequencePair> out = smithWatermanBatch(pairs, scoringScheme, tileDim);
+
+    // End timing
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    if (printOutput && !skipVerification) {
+        // Only test cases with expected values are checked
+        int checked = 0;
+        int matching = 0;
+        for (size_t n = 0; n < testCases.size(); n++) {
+            if (testCases[n].expectedAligned1.empty() || testCases[n].expectedAligned2.empty()) {
+                continue;
+            }
+            checked++;
+            if (out[n].first == testCases[n].expectedAligned1 && out[n].second == testCases[n].expectedAligned2) {
+                matching++;
+            } else {
+                std::cout << "Test case " << n << ": output does not match expected result!" << std::endl;
+            }
+        }
+        std::cout << "Batch of " << testCases.size() << " test cases, " << matching << "/" << checked << " outputs match expected results." << std::endl;
+    }
+
+    return duration.count();
+}
+
+// Peak resident set size of this process so far, in kilobytes
+long peakRSSKilobytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+    return usage.ru_maxrss; // Linux reports this in kilobytes
+}
+
 void printUsage(const char* programName) {
     std::cout << "Usage: " << programName << " [options] [test_case_index]" << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  -f <filename>       Specify input file (default: ../datasets/sequence_test_cases.txt)" << std::endl;
     std::cout << "  -b <num_runs>       Run benchmark with specified number of iterations (default: 10)" << std::endl;
     std::cout << "  -e                  Skip correctness verification (for datasets without expected alignments)" << std::endl;
+    std::cout << "  -a                  Benchmark every test case in the file per iteration instead of one (use with -b)" << std::endl;
+    std::cout << "  -s                  Score only: best score, its end cell and the second best score, no alignment" << std::endl;
+    std::cout << "  -p                  Align every test case in the file with one smithWatermanBatch() call" << std::endl;
+    std::cout << "  -m <name|file>      Scoring scheme: default, dna, blosum62 or an NCBI format matrix file (default: default)" << std::endl;
+    std::cout << "  -t <tile_size>      Block size of the blocked engines: 8, 16, 32 or 64 (default: " << BASELINE_TILE_DIM << ")" << std::endl;
+    std::cout << "  -w <width>          Banded: alignments only compute the blocks within width cells of the band's diagonal (base_basic, base_wave)" << std::endl;
+    std::cout << "  -d <diagonal>       Diagonal the band is on, position in seq2 - position in seq1 (default: 0)" << std::endl;
+    std::cout << "  -r                  Recenter the band on the best cell so far after every block row" << std::endl;
+    std::cout << "  -x <drop>           X-drop: skip the blocks behind ones whose edges are all more than drop below the best (base_basic, base_wave)" << std::endl;
     std::cout << "  -h                  Display this help message" << std::endl;
 }
 
@@ -183,6 +307,15 @@ int main(int argc, char* argv[])
     
     // New flag for skipping correctness verification
     bool skipVerification = false;
+
+    // Flag for benchmarking the whole file instead of one test case
+    bool benchmarkAll = false;
+
+    // Flag for score only runs
+    bool scoreOnly = false;
+
+    // Flag for aligning the whole file as one batch
+    bool batchMode = false;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -201,6 +334,52 @@ int main(int argc, char* argv[])
         } else if (strcmp(argv[i], "-e") == 0) {
             // -e flag for skipping correctness verification
             skipVerification = true;
+        } else if (strcmp(argv[i], "-a") == 0) {
+            // -a flag for benchmarking every test case
+            benchmarkAll = true;
+        } else if (strcmp(argv[i], "-s") == 0) {
+            // -s flag for score only mode
+            scoreOnly = true;
+        } else if (strcmp(argv[i], "-p") == 0) {
+            // -p flag for batch mode
+            batchMode = true;
+        } else if (i < argc - 1 && strcmp(argv[i], "-m") == 0) {
+            // -m flag for the scoring scheme
+            if (!scoringSchemeByName(argv[i + 1], scoringScheme)) {
+                return 1;
+            }
+            i++; // Skip the next argument since we've used it
+        } else if (i < argc - 1 && strcmp(argv[i], "-t") == 0) {
+            // -t flag for the block size, no rebuild needed
+            tileDim = std::atoi(argv[i + 1]);
+            if (!isTileDim(tileDim)) {
+                std::cerr << "Error: Tile size must be 8, 16, 32 or 64." << std::endl;
+                return 1;
+            }
+            i++; // Skip the next argument since we've used it
+        } else if (i < argc - 1 && strcmp(argv[i], "-w") == 0) {
+            // -w flag for the band width
+            band.width = std::atoi(argv[i + 1]);
+            if (band.width < 0) {
+                std::cerr << "Error: Band width must not be negative." << std::endl;
+                return 1;
+            }
+            i++; // Skip the next argument since we've used it
+        } else if (i < argc - 1 && strcmp(argv[i], "-d") == 0) {
+            // -d flag for the band's diagonal
+            band.center = std::atoi(argv[i + 1]);
+            i++; // Skip the next argument since we've used it
+        } else if (strcmp(argv[i], "-r") == 0) {
+            // -r flag for a band that follows the best cell
+            band.adaptive = true;
+        } else if (i < argc - 1 && strcmp(argv[i], "-x") == 0) {
+            // -x flag for the X-drop
+            xDrop = std::atoi(argv[i + 1]);
+            if (xDrop < 0) {
+                std::cerr << "Error: X-drop must not be negative." << std::endl;
+                return 1;
+            }
+            i++; // Skip the next argument since we've used it
         } else if (strcmp(argv[i], "-h") == 0) {
             // -h flag for help
             printUsage(argv[0]);
@@ -212,6 +391,14 @@ int main(int argc, char* argv[])
     }
     
     std::cout << "Using input file: " << inputFile << std::endl;
+    std::cout << "Using tile size: " << tileDim << std::endl;
+    if (band.on()) {
+        std::cout << "Using band: width " << band.width << " around diagonal " << band.center
+                  << (band.adaptive ? ", recentered every block row" : "") << std::endl;
+    }
+    if (xDrop >= 0) {
+        std::cout << "Using X-drop: " << xDrop << std::endl;
+    }
     if (skipVerification) {
         std::cout << "Correctness verification disabled" << std::endl;
     }
@@ -231,10 +418,22 @@ int main(int argc, char* argv[])
     
     // Get the selected test case
     TestCase selectedTest = testCases[testCaseIndex];
+
+    // Score only runs go through smithWatermanScore() instead
+    double (*runCase)(const TestCase&, bool, bool) = scoreOnly ? runScoreTestCase : runTestCase;
+    if (scoreOnly) {
+        std::cout << "Score only mode" << std::endl;
+    }
     
     if (benchmarkRuns > 0) {
         // Benchmark mode - run the test multiple times
-        std::cout << "Running benchmark with " << benchmarkRuns << " iterations for test case " << testCaseIndex << std::endl;
+        if (batchMode) {
+            std::cout << "Running benchmark with " << benchmarkRuns << " iterations for a batch of all " << testCases.size() << " test cases" << std::endl;
+        } else if (benchmarkAll) {
+            std::cout << "Running benchmark with " << benchmarkRuns << " iterations for all " << testCases.size() << " test cases" << std::endl;
+        } else {
+            std::cout << "Running benchmark with " << benchmarkRuns << " iterations for test case " << testCaseIndex << std::endl;
+        }
         
         std::vector<double> times;
         times.reserve(benchmarkRuns);
@@ -242,8 +441,19 @@ int main(int argc, char* argv[])
         // Run tests
         for (int i = 0; i < benchmarkRuns; i++) {
             std::cout << "Iteration " << (i + 1) << "/" << benchmarkRuns << ":" << std::endl;
-            // Only print output for the first run
-            double time = runTestCase(selectedTest, i == 0, skipVerification);
+            double time = 0.0;
+            if (batchMode) {
+                // One batch call, only check the output of the first run
+                time = runBatch(testCases, i == 0, skipVerification);
+            } else if (benchmarkAll) {
+                // Total over the whole file, nothing printed per test case
+                for (const TestCase& testCase : testCases) {
+                    time += runCase(testCase, false, skipVerification);
+                }
+            } else {
+                // Only print output for the first run
+                time = runCase(selectedTest, i == 0, skipVerification);
+            }
             times.push_back(time);
             std::cout << "Time: " << time << " seconds" << std::endl;
             std::cout << "--------------------------------" << std::endl;
@@ -262,14 +472,22 @@ int main(int argc, char* argv[])
             std::cout << "  Average time: " << avg << " seconds" << std::endl;
             std::cout << "  Min time: " << min << " seconds" << std::endl;
             std::cout << "  Max time: " << max << " seconds" << std::endl;
+            std::cout << "  Peak RSS: " << peakRSSKilobytes() << " KB" << std::endl;
         } else {
             std::cout << "Note: At least 2 iterations are needed to calculate statistics excluding first run." << std::endl;
         }
+    } else if (batchMode) {
+        // Batch mode - run the whole file once
+        std::cout << "Running a batch of " << testCases.size() << " test cases" << std::endl;
+        double time = runBatch(testCases, true, skipVerification);
+        std::cout << "Total time taken: " << time << " seconds" << std::endl;
+        std::cout << "Peak RSS: " << peakRSSKilobytes() << " KB" << std::endl;
     } else {
         // Normal mode - run single test
         std::cout << "Running test case " << testCaseIndex << std::endl;
-        double time = runTestCase(selectedTest, true, skipVerification);
+        double time = runCase(selectedTest, true, skipVerification);
         std::cout << "Total time taken: " << time << " seconds" << std::endl;
+        std::cout << "Peak RSS: " << peakRSSKilobytes() << " KB" << std::endl;
     }
     
     return 0;
@@ -3,7 +3,31 @@
 
 #include <string>
 #include <vector>
+#include "../defines.hpp"
+#include "../scoring.hpp"
+#include "../band.hpp"
 
-std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1, const char *seq2, size_t size2);
+//scheme gives the substitution scores, the default scores like MATCH_SCORE / MISMATCH_SCORE
+//tileDim is the block size of the blocked engines, 8, 16, 32 or 64 (tile_dim.hpp)
+//it picks which of several equal best cells is the end, so every engine takes it and ends on the same cell
+//band (band.hpp) skips the blocks it does not cross in base_basic and base_wave,
+//xDrop (>= 0) skips the blocks behind ones whose edges fell more than that below the best (xdrop_blocks.hpp) in those two as well,
+//the other engines take them and do the whole matrix
+std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1, const char *seq2, size_t size2,
+                                                  const ScoringScheme& scheme = defaultScheme(), int tileDim = BASELINE_TILE_DIM,
+                                                  const Band& band = fullBand(), int xDrop = -1);
 
-#endif
\ No newline at end of file
+//score only result, nothing is kept for a backtrack
+//maxI / maxJ are the same end cell smithWaterman() backtracks from, 0 if the score is 0
+struct ScoreResult {
+    int score;
+    int maxI;
+    int maxJ;
+    int secondScore;
+        //best score ending more than secondBestMask() columns away from maxJ, only filled in when asked for
+};
+
+ScoreResult smithWatermanScore(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest = false,
+                               const ScoringScheme& scheme = defaultScheme(), int tileDim = BASELINE_TILE_DIM);
+
+#endif
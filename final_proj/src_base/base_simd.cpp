@@ -0,0 +1,457 @@
+#include <algorithm>
+#include <iostream>
+#include <bits/stdc++.h>
+#include <immintrin.h>
+#include "base_main.hpp"
+#include "../defines.hpp"
+#include "score_only.hpp"
+#include "affine_gap.hpp"
+
+using namespace std;
+
+//striped (Farrar) implementation
+//seq1 is the query, it is striped across the vector lanes
+//seq2 is the database, each column j is one pass over the striped query
+//query position i (0 indexed) lives in lane i / segLen, segment i % segLen
+//scores run in 16 bit saturating lanes first, and rerun in 32 bit lanes if the max saturates
+//with AFFINE_GAP this is Farrar's affine version: E of every segment is kept from one column to the next,
+//and the lazy F loop also raises E where it raises H
+
+//build with -march=native (or -mavx2 / -mavx512bw), falls back to SSE2 otherwise
+
+#if defined(__AVX512BW__)
+    #define SIMD_BYTES 64
+    typedef __m512i simd_t;
+#elif defined(__AVX2__)
+    #define SIMD_BYTES 32
+    typedef __m256i simd_t;
+#else
+    #define SIMD_BYTES 16
+    typedef __m128i simd_t;
+#endif
+
+//16 bit lanes, saturating
+struct Lane16 {
+    typedef int16_t cell_t;
+    static const int LANES = SIMD_BYTES / 2;
+    static const int SATURATED = INT16_MAX;
+
+#if defined(__AVX512BW__)
+    static simd_t set1(int x) { return _mm512_set1_epi16((short)x); }
+    static simd_t add(simd_t a, simd_t b) { return _mm512_adds_epi16(a, b); }
+    static simd_t sub(simd_t a, simd_t b) { return _mm512_subs_epi16(a, b); }
+    static simd_t max(simd_t a, simd_t b) { return _mm512_max_epi16(a, b); }
+    static bool anyGreater(simd_t a, simd_t b) { return _mm512_cmpgt_epi16_mask(a, b) != 0; }
+    //lowest lane where a == b, -1 if none
+    static int firstEqual(simd_t a, simd_t b) {
+        uint32_t mask = _mm512_cmpeq_epi16_mask(a, b);
+        return mask ? __builtin_ctz(mask) : -1;
+    }
+    //moves every lane up by one, lane 0 becomes 0
+    static simd_t shift(simd_t a) {
+        static const uint16_t idx[32] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                                         15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30};
+        return _mm512_maskz_permutexvar_epi16(0xFFFFFFFE, _mm512_loadu_si512(idx), a);
+    }
+#elif defined(__AVX2__)
+    static simd_t set1(int x) { return _mm256_set1_epi16((short)x); }
+    static simd_t add(simd_t a, simd_t b) { return _mm256_adds_epi16(a, b); }
+    static simd_t sub(simd_t a, simd_t b) { return _mm256_subs_epi16(a, b); }
+    static simd_t max(simd_t a, simd_t b) { return _mm256_max_epi16(a, b); }
+    static bool anyGreater(simd_t a, simd_t b) { return _mm256_movemask_epi8(_mm256_cmpgt_epi16(a, b)) != 0; }
+    static int firstEqual(simd_t a, simd_t b) {
+        uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi16(a, b));
+        return mask ? __builtin_ctz(mask) / 2 : -1;
+    }
+    static simd_t shift(simd_t a) {
+        //carry the top of the low 128 bits into the high 128 bits
+        return _mm256_alignr_epi8(a, _mm256_permute2x128_si256(a, a, 0x08), 16 - 2);
+    }
+#else
+    static simd_t set1(int x) { return _mm_set1_epi16((short)x); }
+    static simd_t add(simd_t a, simd_t b) { return _mm_adds_epi16(a, b); }
+    static simd_t sub(simd_t a, simd_t b) { return _mm_subs_epi16(a, b); }
+    static simd_t max(simd_t a, simd_t b) { return _mm_max_epi16(a, b); }
+    static bool anyGreater(simd_t a, simd_t b) { return _mm_movemask_epi8(_mm_cmpgt_epi16(a, b)) != 0; }
+    static int firstEqual(simd_t a, simd_t b) {
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi16(a, b));
+        return mask ? __builtin_ctz(mask) / 2 : -1;
+    }
+    static simd_t shift(simd_t a) { return _mm_slli_si128(a, 2); }
+#endif
+};
+
+//32 bit lanes, only used when the 16 bit pass saturates
+struct Lane32 {
+    typedef int32_t cell_t;
+    static const int LANES = SIMD_BYTES / 4;
+    static const int SATURATED = INT32_MAX;
+
+#if defined(__AVX512BW__)
+    static simd_t set1(int x) { return _mm512_set1_epi32(x); }
+    static simd_t add(simd_t a, simd_t b) { return _mm512_add_epi32(a, b); }
+    static simd_t sub(simd_t a, simd_t b) { return _mm512_sub_epi32(a, b); }
+    static simd_t max(simd_t a, simd_t b) { return _mm512_max_epi32(a, b); }
+    static bool anyGreater(simd_t a, simd_t b) { return _mm512_cmpgt_epi32_mask(a, b) != 0; }
+    static int firstEqual(simd_t a, simd_t b) {
+        uint32_t mask = _mm512_cmpeq_epi32_mask(a, b);
+        return mask ? __builtin_ctz(mask) : -1;
+    }
+    static simd_t shift(simd_t a) { return _mm512_alignr_epi32(a, _mm512_setzero_si512(), 15); }
+#elif defined(__AVX2__)
+    static simd_t set1(int x) { return _mm256_set1_epi32(x); }
+    static simd_t add(simd_t a, simd_t b) { return _mm256_add_epi32(a, b); }
+    static simd_t sub(simd_t a, simd_t b) { return _mm256_sub_epi32(a, b); }
+    static simd_t max(simd_t a, simd_t b) { return _mm256_max_epi32(a, b); }
+    static bool anyGreater(simd_t a, simd_t b) { return _mm256_movemask_epi8(_mm256_cmpgt_epi32(a, b)) != 0; }
+    static int firstEqual(simd_t a, simd_t b) {
+        uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi32(a, b));
+        return mask ? __builtin_ctz(mask) / 4 : -1;
+    }
+    static simd_t shift(simd_t a) {
+        return _mm256_alignr_epi8(a, _mm256_permute2x128_si256(a, a, 0x08), 16 - 4);
+    }
+#else
+    //SSE2 has no signed 32 bit max
+    static simd_t set1(int x) { return _mm_set1_epi32(x); }
+    static simd_t add(simd_t a, simd_t b) { return _mm_add_epi32(a, b); }
+    static simd_t sub(simd_t a, simd_t b) { return _mm_sub_epi32(a, b); }
+    static simd_t max(simd_t a, simd_t b) {
+        simd_t gt = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+    }
+    static bool anyGreater(simd_t a, simd_t b) { return _mm_movemask_epi8(_mm_cmpgt_epi32(a, b)) != 0; }
+    static int firstEqual(simd_t a, simd_t b) {
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi32(a, b));
+        return mask ? __builtin_ctz(mask) / 4 : -1;
+    }
+    static simd_t shift(simd_t a) { return _mm_slli_si128(a, 4); }
+#endif
+};
+
+//every column of H in striped order, kept for the backtrack
+//in score only mode the columns are not kept, maxCells has the first (i, j) of every column that holds the max instead
+template <typename Lane>
+struct StripedMatrix {
+    typedef typename Lane::cell_t cell_t;
+
+    int size1 = 0;
+    int size2 = 0;
+    int segLen = 0;
+    cell_t* cells = nullptr;
+    std::vector<int> colMax;
+        //max of every column, used to find the max position without a full scan
+    int maxScore = 0;
+    std::vector<std::pair<int, int>> maxCells;
+
+    ~StripedMatrix() { _mm_free(cells); }
+
+    //i and j are 1 indexed like score[i][j] in base_basic
+    int at(int i, int j) const {
+        if (i == 0 || j == 0) {
+            return 0;
+        }
+        int q = i - 1;
+        return cells[((size_t)(j - 1) * segLen + q % segLen) * Lane::LANES + q / segLen];
+    }
+};
+
+//first row (1 indexed) of a striped column that holds value, the lowest lane is the lowest row
+template <typename Lane>
+int firstRowWith(const simd_t* column, int segLen, int value) {
+    const simd_t vValue = Lane::set1(value);
+    int first = INT_MAX;
+    for (int s = 0; s < segLen; s++) {
+        int k = Lane::firstEqual(column[s], vValue);
+        if (k >= 0) {
+            first = std::min(first, k * segLen + s + 1);
+        }
+    }
+    return first;
+}
+
+//returns false if the lanes saturated
+template <typename Lane>
+bool stripedFill(const char* seq1, int size1, const char* seq2, int size2, const ScoringScheme& scheme,
+                 StripedMatrix<Lane>& H, bool scoreOnly = false) {
+    typedef typename Lane::cell_t cell_t;
+    const int L = Lane::LANES;
+    const int segLen = (size1 + L - 1) / L;
+
+    H.size1 = size1;
+    H.size2 = size2;
+    H.segLen = segLen;
+    if (!scoreOnly) {
+        H.cells = (cell_t*)_mm_malloc(sizeof(simd_t) * segLen * size2, SIMD_BYTES);
+    }
+    H.colMax.assign(size2 + 1, 0);
+
+    //query profile, one striped row of substitution scores per code that shows up in seq2
+    int profileIndex[SCORE_ALPHABET];
+    std::fill(profileIndex, profileIndex + SCORE_ALPHABET, -1);
+    int numProfiles = 0;
+    for (int j = 0; j < size2; j++) {
+        unsigned char c = scheme.encode(seq2[j]);
+        if (profileIndex[c] < 0) {
+            profileIndex[c] = numProfiles++;
+        }
+    }
+    simd_t* profile = (simd_t*)_mm_malloc(sizeof(simd_t) * segLen * std::max(numProfiles, 1), SIMD_BYTES);
+    //padding past the end of seq1 scores below any real move, a gap opening too, so a padding row never holds the max:
+    //a padding cell's diagonal from the last row of seq1 is then below the gap from that cell into the last row
+    #ifdef AFFINE_GAP
+        const int padScore = std::min(scheme.minScore, GAP_OPEN) - 1;
+    #else
+        const int padScore = std::min(scheme.minScore, GAP_SCORE) - 1;
+    #endif
+    for (int c = 0; c < SCORE_ALPHABET; c++) {
+        if (profileIndex[c] < 0) {
+            continue;
+        }
+        cell_t* row = (cell_t*)(profile + (size_t)profileIndex[c] * segLen);
+        for (int s = 0; s < segLen; s++) {
+            for (int k = 0; k < L; k++) {
+                int q = k * segLen + s;
+                row[s * L + k] = (q < size1) ? scheme.sub[scheme.encode(seq1[q])][c] : padScore;
+            }
+        }
+    }
+
+    simd_t* pvHLoad = (simd_t*)_mm_malloc(sizeof(simd_t) * segLen, SIMD_BYTES);
+    simd_t* pvHStore = (simd_t*)_mm_malloc(sizeof(simd_t) * segLen, SIMD_BYTES);
+    const simd_t vZero = Lane::set1(0);
+#ifdef AFFINE_GAP
+    simd_t* pvE = (simd_t*)_mm_malloc(sizeof(simd_t) * segLen, SIMD_BYTES);
+    const simd_t vGapOpen = Lane::set1(-GAP_OPEN);
+    const simd_t vGapExtend = Lane::set1(-GAP_EXTEND);
+    //F can only change anything further down while it is above H + GAP_OPEN - GAP_EXTEND, and above 0 (F is clamped like H)
+    const simd_t vGapLazy = Lane::set1(GAP_EXTEND - GAP_OPEN);
+    for (int s = 0; s < segLen; s++) {
+        pvE[s] = vZero;
+    }
+#else
+    const simd_t vGap = Lane::set1(-GAP_SCORE);
+#endif
+    for (int s = 0; s < segLen; s++) {
+        pvHStore[s] = vZero;
+    }
+    simd_t vMax = vZero;
+
+    for (int j = 0; j < size2; j++) {
+        const simd_t* vP = profile + (size_t)profileIndex[scheme.encode(seq2[j])] * segLen;
+        simd_t vColMax = vZero;
+        simd_t vF = vZero;
+        //diagonal for segment 0 is the last segment of the previous column moved up a lane
+        simd_t vH = Lane::shift(pvHStore[segLen - 1]);
+        std::swap(pvHLoad, pvHStore);
+
+        for (int s = 0; s < segLen; s++) {
+            vH = Lane::add(vH, vP[s]);
+#ifdef AFFINE_GAP
+            vH = Lane::max(vH, pvE[s]);
+            vH = Lane::max(vH, vF);
+            vH = Lane::max(vH, vZero);
+            pvHStore[s] = vH;
+            vColMax = Lane::max(vColMax, vH);
+
+            //E for the next column, F for the next segment
+            simd_t vHOpen = Lane::sub(vH, vGapOpen);
+            pvE[s] = Lane::max(Lane::sub(pvE[s], vGapExtend), vHOpen);
+            vF = Lane::max(Lane::sub(vF, vGapExtend), vHOpen);
+#else
+            //linear gaps, so E is just the left cell minus the gap
+            vH = Lane::max(vH, Lane::sub(pvHLoad[s], vGap));
+            vH = Lane::max(vH, vF);
+            vH = Lane::max(vH, vZero);
+            pvHStore[s] = vH;
+            vColMax = Lane::max(vColMax, vH);
+
+            vF = Lane::sub(vH, vGap);
+#endif
+            vH = pvHLoad[s];
+        }
+
+        //lazy F loop, carries the vertical gaps across lane boundaries
+        vF = Lane::shift(vF);
+        int s = 0;
+#ifdef AFFINE_GAP
+        while (Lane::anyGreater(vF, Lane::max(Lane::sub(pvHStore[s], vGapLazy), vZero))) {
+            pvHStore[s] = Lane::max(pvHStore[s], vF);
+            vColMax = Lane::max(vColMax, pvHStore[s]);
+            pvE[s] = Lane::max(pvE[s], Lane::sub(pvHStore[s], vGapOpen));
+            vF = Lane::sub(vF, vGapExtend);
+#else
+        while (Lane::anyGreater(vF, pvHStore[s])) {
+            pvHStore[s] = Lane::max(pvHStore[s], vF);
+            vColMax = Lane::max(vColMax, pvHStore[s]);
+            vF = Lane::sub(vF, vGap);
+#endif
+            if (++s >= segLen) {
+                vF = Lane::shift(vF);
+                s = 0;
+            }
+        }
+
+        vMax = Lane::max(vMax, vColMax);
+
+        cell_t lanes[L];
+        std::memcpy(lanes, &vColMax, sizeof(simd_t));
+        H.colMax[j + 1] = *std::max_element(lanes, lanes + L);
+
+        if (!scoreOnly) {
+            std::memcpy(H.cells + (size_t)j * segLen * L, pvHStore, sizeof(simd_t) * segLen);
+        } else if (H.colMax[j + 1] > 0 && H.colMax[j + 1] >= H.maxScore) {
+            //only columns that tie or beat the max so far can hold the max cell
+            if (H.colMax[j + 1] > H.maxScore) {
+                H.maxScore = H.colMax[j + 1];
+                H.maxCells.clear();
+            }
+            H.maxCells.push_back({firstRowWith<Lane>(pvHStore, segLen, H.maxScore), j + 1});
+        }
+    }
+
+    cell_t lanes[L];
+    std::memcpy(lanes, &vMax, sizeof(simd_t));
+    H.maxScore = *std::max_element(lanes, lanes + L);
+
+    _mm_free(profile);
+    _mm_free(pvHLoad);
+    _mm_free(pvHStore);
+#ifdef AFFINE_GAP
+    _mm_free(pvE);
+#endif
+
+    return H.maxScore < Lane::SATURATED;
+}
+
+//picks the same max cell as base_basic from the first max cell of every column that holds the max
+//base_basic walks tileDim blocks in row major order and row major inside each block,
+//and only takes strictly greater scores, so the first max in that order wins
+void pickMaxCell(const std::vector<std::pair<int, int>>& cells, int size2, int tileDim, int& maxI, int& maxJ) {
+    maxI = 0;
+    maxJ = 0;
+    long long bestKey[3] = {LLONG_MAX, LLONG_MAX, LLONG_MAX};
+    for (const std::pair<int, int>& cell : cells) {
+        int i = cell.first, j = cell.second;
+        long long key[3] = {(i - 1) / tileDim, (j - 1) / tileDim, (long long)i * (size2 + 1) + j};
+        if (std::lexicographical_compare(key, key + 3, bestKey, bestKey + 3)) {
+            std::copy(key, key + 3, bestKey);
+            maxI = i;
+            maxJ = j;
+        }
+    }
+}
+
+template <typename Lane>
+void findMaxPosition(const StripedMatrix<Lane>& H, int tileDim, int& maxI, int& maxJ) {
+    std::vector<std::pair<int, int>> cells;
+    if (H.maxScore > 0) {
+        for (int j = 1; j <= H.size2; j++) {
+            if (H.colMax[j] != H.maxScore) {
+                continue;
+            }
+            //first row in this column that hits the max
+            for (int i = 1; i <= H.size1; i++) {
+                if (H.at(i, j) == H.maxScore) {
+                    cells.push_back({i, j});
+                    break;
+                }
+            }
+        }
+    }
+    pickMaxCell(cells, H.size2, tileDim, maxI, maxJ);
+}
+
+template <typename Lane>
+std::pair<std::string, std::string> backtrack(const StripedMatrix<Lane>& score, const ScoringScheme& scheme,
+                                              const char* seq1, const char* seq2, int tileDim) {
+    int maxI, maxJ;
+    findMaxPosition(score, tileDim, maxI, maxJ);
+
+    //backtrack to find the aligned sequences
+    std::string alignedSeq1, alignedSeq2;
+#ifdef AFFINE_GAP
+    affineBacktrack([&](int i, int j) { return score.at(i, j); }, scheme, seq1, seq2, maxI, maxJ, alignedSeq1, alignedSeq2);
+#else
+    int i = maxI, j = maxJ;
+    //BACKTRACKING
+    while (i > 0 && j > 0 && score.at(i, j) > 0)
+    {
+        if (score.at(i, j) == score.at(i - 1, j - 1) + scheme.score(seq1[i - 1], seq2[j - 1]))
+        {
+            alignedSeq1 += seq1[i - 1];
+            alignedSeq2 += seq2[j - 1];
+            i--;
+            j--;
+        }
+        else if (score.at(i, j) == score.at(i - 1, j) + GAP_SCORE)
+        {
+            alignedSeq1 += seq1[i - 1];
+            alignedSeq2 += '-';
+            i--;
+        }
+        else // score[i][j] == score[i][j - 1] + GAP_SCORE
+        {
+            alignedSeq1 += '-';
+            alignedSeq2 += seq2[j - 1];
+            j--;
+        }
+    }
+#endif
+
+    //reverse the aligned sequences
+    std::reverse(alignedSeq1.begin(), alignedSeq1.end());
+    std::reverse(alignedSeq2.begin(), alignedSeq2.end());
+
+    return {alignedSeq1, alignedSeq2};
+}
+
+//striped over whole columns, so there are no blocks to skip, band and xDrop are only taken for the shared signature
+std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1, const char *seq2, size_t size2,
+                                                  const ScoringScheme& scheme, int tileDim, const Band& band, int xDrop) {
+    if (size1 == 0 || size2 == 0) {
+        return {"", ""};
+    }
+
+    {
+        StripedMatrix<Lane16> score16;
+        if (stripedFill(seq1, (int)size1, seq2, (int)size2, scheme, score16)) {
+            return backtrack(score16, scheme, seq1, seq2, tileDim);
+        }
+    }
+
+    //16 bit lanes saturated, redo with 32 bit lanes
+    StripedMatrix<Lane32> score32;
+    stripedFill(seq1, (int)size1, seq2, (int)size2, scheme, score32);
+    return backtrack(score32, scheme, seq1, seq2, tileDim);
+}
+
+template <typename Lane>
+ScoreResult stripedScore(const StripedMatrix<Lane>& H, bool secondBest, int tileDim) {
+    ScoreResult result = {H.maxScore, 0, 0, 0};
+    pickMaxCell(H.maxCells, H.size2, tileDim, result.maxI, result.maxJ);
+    if (secondBest) {
+        result.secondScore = maskedSecondBest(H.colMax, result.maxJ, secondBestMask(H.size1, H.size2));
+    }
+    return result;
+}
+
+//score only, two striped columns instead of all of them
+ScoreResult smithWatermanScore(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest,
+                               const ScoringScheme& scheme, int tileDim) {
+    if (size1 == 0 || size2 == 0) {
+        return {0, 0, 0, 0};
+    }
+
+    {
+        StripedMatrix<Lane16> score16;
+        if (stripedFill(seq1, (int)size1, seq2, (int)size2, scheme, score16, true)) {
+            return stripedScore(score16, secondBest, tileDim);
+        }
+    }
+
+    //16 bit lanes saturated, redo with 32 bit lanes
+    StripedMatrix<Lane32> score32;
+    stripedFill(seq1, (int)size1, seq2, (int)size2, scheme, score32, true);
+    return stripedScore(score32, secondBest, tileDim);
+}
@@ -3,14 +3,29 @@
 #include <bits/stdc++.h>
 #include "base_main.hpp"
 #include "../defines.hpp"
+#include "score_matrix.hpp"
+#include "score_only.hpp"
+#include "affine_gap.hpp"
+#include "query_profile.hpp"
+#include "tile_dim.hpp"
+#include "band_blocks.hpp"
+#include "xdrop_blocks.hpp"
 #include <omp.h>
 
-#define CHECK_CORE
+//prints the cpu of every thread once at the start
+// #define CHECK_CORE
+//pins thread n to the n-th cpu the process may run on, otherwise OMP_PROC_BIND / OMP_PLACES still apply
+// #define PIN_THREADS
 using namespace std;
 
 //start and end are inclusive
+//with AFFINE_GAP, gapE[i] is E of the last column done in row i and gapF[j] is F of the last row done in column j,
+//so a block picks up the gaps of the blocks to its left and above, unused otherwise
+//column j of the block is column j + profile_offset of the profile
+template <typename T>
 std::tuple<int, int, int> process_block(int start_i, int end_i, int start_j, int end_j, 
-                   std::vector<std::vector<int>>& matrix, const std::string& seq1, const std::string& seq2) {
+                   ScoreMatrix<T>& matrix, const char* seq1, const QueryProfile& profile, int profile_offset,
+                   int* gapE, int* gapF) {
 
     int maxScore = 0;
     int maxI = 0;
@@ -18,14 +33,19 @@ std::tuple<int, int, int> process_block(int start_i, int end_i, int start_j, int
 
     for (size_t i = start_i; i <= end_i; ++i)
     {
+        const int* profileRow = profile.row(seq1[i - 1]) + profile_offset;
         for (size_t j = start_j; j <= end_j; ++j)
         {
             
-            int matchScore = (seq1[i - 1] == seq2[j - 1]) ? MATCH_SCORE : MISMATCH_SCORE;
-            matrix[i][j] = std::max({0,
-                                    matrix[i - 1][j - 1] + matchScore,
-                                    matrix[i - 1][j] + GAP_SCORE,
-                                    matrix[i][j - 1] + GAP_SCORE});
+            int matchScore = profileRow[j];
+            #ifdef AFFINE_GAP
+                matrix[i][j] = gotohCell(matrix[i - 1][j - 1] + matchScore, matrix[i][j - 1], matrix[i - 1][j], gapE[i], gapF[j]);
+            #else
+                matrix[i][j] = std::max({0,
+                                        matrix[i - 1][j - 1] + matchScore,
+                                        matrix[i - 1][j] + GAP_SCORE,
+                                        matrix[i][j - 1] + GAP_SCORE});
+            #endif
             if (matrix[i][j] > maxScore)
             {
                 maxScore = matrix[i][j];
@@ -37,70 +57,256 @@ std::tuple<int, int, int> process_block(int start_i, int end_i, int start_j, int
     return std::make_tuple(maxScore, maxI, maxJ);
 }
 
-std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1, const char *seq2, size_t size2) {
+//one ready queue per thread
+//the owner takes from the back (the tile it just made ready, still in cache), other threads steal from the front
+struct TileQueue {
+    std::mutex lock;
+    std::deque<int> tiles;
+
+    void push(int tile) {
+        std::lock_guard<std::mutex> guard(lock);
+        tiles.push_back(tile);
+    }
+
+    bool pop(int& tile) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (tiles.empty()) {
+            return false;
+        }
+        tile = tiles.back();
+        tiles.pop_back();
+        return true;
+    }
+
+    bool steal(int& tile) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (tiles.empty()) {
+            return false;
+        }
+        tile = tiles.front();
+        tiles.pop_front();
+        return true;
+    }
+};
+
+//best cell seen by one thread, block is the row major block index
+//ties go to the lower block, so the merged max is the same cell base_basic finds
+struct ThreadMax {
+    int score = 0;
+    int block = INT_MAX;
+    int i = 0;
+    int j = 0;
+
+    void update(int blockScore, int blockIndex, int blockI, int blockJ) {
+        if (blockScore > score || (blockScore == score && blockScore > 0 && blockIndex < block)) {
+            score = blockScore;
+            block = blockIndex;
+            i = blockI;
+            j = blockJ;
+        }
+    }
+};
+
+#ifdef PIN_THREADS
+//pins the calling thread to the tid'th cpu the process is allowed to run on
+void pin_thread(int tid) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return;
+    }
+    int num_cpus = CPU_COUNT(&allowed);
+    int target = tid % num_cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            CPU_SET(cpu, &mask);
+            sched_setaffinity(0, sizeof(mask), &mask);
+            return;
+        }
+    }
+}
+#endif
+
+//runs every block of a num_blocks_seq1 x num_blocks_seq2 grid, run_block(block_num_x, block_num_y) computes one
+//and returns its (max, i, j)
+//with ranges only the blocks in them (band_blocks.hpp), the ones out of them count as done from the start
+//returns the merged max
+template <typename RunBlock>
+ThreadMax schedule_blocks(int num_blocks_seq1, int num_blocks_seq2, RunBlock run_block, const BlockRanges& ranges = BlockRanges()) {
+    int num_blocks = num_blocks_seq1 * num_blocks_seq2;
+
+    //x is in i direction, y is in j direction, block index is x * num_blocks_seq2 + y
+    //a block is ready once the blocks above and to the left are done, instead of waiting for the whole anti-diagonal
+    //deps counts the neighbours that are not done yet, whoever brings it to 0 queues the block
+    //a band block with neither of those in the band still reads the corner of the one above and to the left, so it waits on that
+    auto corner_dep = [&](int block_num_x, int block_num_y) { return ranges.cornerDep(block_num_x, block_num_y); };
+    std::unique_ptr<std::atomic<int>[]> deps(new std::atomic<int>[num_blocks]);
+    int num_run = 0;
+    std::vector<int> ready;
+    for (int block_num_x = 0; block_num_x < num_blocks_seq1; ++block_num_x) {
+        for (int block_num_y = 0; block_num_y < num_blocks_seq2; ++block_num_y) {
+            int block_deps = (block_num_x > 0 && ranges.has(block_num_x - 1, block_num_y)) +
+                             (block_num_y > 0 && ranges.has(block_num_x, block_num_y - 1)) + corner_dep(block_num_x, block_num_y);
+            deps[block_num_x * num_blocks_seq2 + block_num_y].store(block_deps, std::memory_order_relaxed);
+            if (ranges.has(block_num_x, block_num_y)) {
+                num_run++;
+                if (block_deps == 0) {
+                    ready.push_back(block_num_x * num_blocks_seq2 + block_num_y);
+                }
+            }
+        }
+    }
+    std::atomic<int> remaining(num_run);
+
+    int max_threads = omp_get_max_threads();
+    std::vector<TileQueue> queues(max_threads);
+    std::vector<ThreadMax> thread_max(max_threads);
+    for (int block : ready) {
+        queues[0].push(block);
+    }
+
+    //one parallel region for the whole matrix, the threads stay in the scheduler loop until every block is done
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int num_threads = omp_get_num_threads();
+        #ifdef PIN_THREADS
+            pin_thread(tid);
+        #endif
+        #ifdef CHECK_CORE
+            printf("Thread %d is running on CPU %d\n", tid, sched_getcpu());
+        #endif
+        ThreadMax& best = thread_max[tid];
+
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            int block;
+            bool found = queues[tid].pop(block);
+            for (int other = 1; !found && other < num_threads; ++other) {
+                found = queues[(tid + other) % num_threads].steal(block);
+            }
+            if (!found) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            int block_num_x = block / num_blocks_seq2;
+            int block_num_y = block % num_blocks_seq2;
+            std::tuple<int, int, int> block_out = run_block(block_num_x, block_num_y);
+            best.update(std::get<0>(block_out), block, std::get<1>(block_out), std::get<2>(block_out));
+
+            //release the neighbours, the acq_rel makes this block's cells visible to whoever runs them
+            if (block_num_x + 1 < num_blocks_seq1 && ranges.has(block_num_x + 1, block_num_y) &&
+                deps[block + num_blocks_seq2].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                queues[tid].push(block + num_blocks_seq2);
+            }
+            if (block_num_y + 1 < num_blocks_seq2 && ranges.has(block_num_x, block_num_y + 1) &&
+                deps[block + 1].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                queues[tid].push(block + 1);
+            }
+            if (block_num_x + 1 < num_blocks_seq1 && block_num_y + 1 < num_blocks_seq2 && ranges.has(block_num_x + 1, block_num_y + 1) &&
+                corner_dep(block_num_x + 1, block_num_y + 1) &&
+                deps[block + num_blocks_seq2 + 1].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                queues[tid].push(block + num_blocks_seq2 + 1);
+            }
+            remaining.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    //merge the per thread maxes once
+    ThreadMax merged;
+    for (const ThreadMax& best : thread_max) {
+        merged.update(best.score, best.block, best.i, best.j);
+    }
+    return merged;
+}
+
+template <typename T, int TileDim>
+std::pair<std::string, std::string> smithWatermanCells(const char *seq1, size_t size1, const char *seq2, size_t size2,
+                                                       const ScoringScheme& scheme, const Band& band, int xDrop) {
 
     //MATRIX ALLOCATION + TIMING HARNESS
-    std::vector<std::vector<int>> score(size1 + 1, std::vector<int>(size2 + 1, 0));
+    ScoreMatrix<T> score(size1 + 1, size2 + 1);
+    QueryProfile profile(scheme, seq1, size1, seq2, size2);
 
-    int maxScore = 0;
-    int maxI = 0, maxJ = 0;
-    std::tuple<int, int, int> block_out;
-    int num_blocks_seq1 = (size1 + BASELINE_TILE_DIM - 1) / BASELINE_TILE_DIM;
+    int num_blocks_seq1 = (size1 + TileDim - 1) / TileDim;
     //includes irregularly shaped blocks
-    int num_blocks_seq2 = (size2 + BASELINE_TILE_DIM - 1) / BASELINE_TILE_DIM;
-
-
-    //below, k, block_num_x, block_num_y start at 0
-    //k is the number of the anti-diagonal
-    //it is also the sum of the indexes of a block in it (if square)
-    for (int k = 0; k < num_blocks_seq1 + num_blocks_seq2 - 1; ++k) {
-                                            // -2 since its 0 indexed
-        // is going through the diagonal
-        // block_num_x + block_num_y = k
-
-        // x is in i direction
-        // y is in j direction
-        // the matrix is j major (column major)
-        // thesse diagonals are going up and to the right
-        #pragma omp parallel for schedule(dynamic)
-        for (int block_num_x = 0; block_num_x <= k; ++block_num_x) {
-            int block_num_y = k - block_num_x;
-            // Check if the bounds
-            // diagonals go up right, so need to check negative y, overbound x, and overbound y
-            if (block_num_y >= 0 && block_num_x < num_blocks_seq1 && block_num_y < num_blocks_seq2) {
-                
-                #ifdef CHECK_CORE
-                    int tid = omp_get_thread_num();
-                    int cpu = sched_getcpu();
-                    printf("Thread %d is running on CPU %d\n", tid, cpu);
-                #endif
-
-                int start_i = block_num_x * BASELINE_TILE_DIM + 1;
-                int start_j = block_num_y * BASELINE_TILE_DIM + 1;
-                int end_i = min(start_i + BASELINE_TILE_DIM - 1, (int)size1);
-                int end_j = min(start_j + BASELINE_TILE_DIM - 1, (int)size2);
-                // std::cout << start_i << "_" << end_i << "|" << start_j << "_" << end_j << " num_x = " << block_num_x << " num_y = " << block_num_y << std::endl;
-                block_out = process_block(start_i, end_i, start_j, end_j, score, seq1, seq2);
-                if (std::get<0>(block_out) > maxScore) {
-                    #pragma omp critical
-                    {
-                        maxScore = std::get<0>(block_out);
-                        maxI = std::get<1>(block_out);
-                        maxJ = std::get<2>(block_out);
-                    }
-                }
+    int num_blocks_seq2 = (size2 + TileDim - 1) / TileDim;
+
+    //gap scores on the block edges, only with AFFINE_GAP
+    //a row of blocks only ever runs one block at a time, and so does a column, so they can be shared without locks
+    std::vector<int> gapE, gapF;
+    #ifdef AFFINE_GAP
+        gapE.assign(size1 + 1, 0);
+        gapF.assign(size2 + 1, 0);
+    #endif
+
+    //with a band only the blocks it crosses (band_blocks.hpp)
+    BlockRanges ranges = {{}, {}, TileDim};
+    //with xDrop a block only runs if a block it reads is still live (xdrop_blocks.hpp), a skipped one is done as soon as its edges are 0,
+    //the scheduler releases its neighbours like any other block
+    XDropBlocks xdrop(xDrop, num_blocks_seq1, num_blocks_seq2, TileDim);
+    auto run_block = [&](int block_num_x, int block_num_y) {
+        int start_i = block_num_x * TileDim + 1;
+        int start_j = block_num_y * TileDim + 1;
+        int end_i = min(start_i + TileDim - 1, (int)size1);
+        int end_j = min(start_j + TileDim - 1, (int)size2);
+        #ifdef AFFINE_GAP
+            //F left in the column by a block the band has moved off since, the block above this one is 0
+            if (!ranges.has(block_num_x - 1, block_num_y)) {
+                std::fill(gapF.begin() + start_j, gapF.begin() + end_j + 1, 0);
+            }
+        #endif
+        if (!xdrop.enter(ranges, block_num_x, block_num_y)) {
+            xdrop.zeroEdges(score, block_num_x, block_num_y, size1, size2, gapE.data(), gapF.data());
+            return std::make_tuple(0, 0, 0);
+        }
+        std::tuple<int, int, int> block_out = process_block(start_i, end_i, start_j, end_j, score, seq1, profile, 0, gapE.data(), gapF.data());
+        xdrop.leave(score, block_num_x, block_num_y, std::get<0>(block_out), size1, size2);
+        return block_out;
+    };
+
+    //the blocks of block row x the band crosses, with the cells around them the band skips zeroed
+    auto band_row = [&](int block_num_x, int center) {
+        int block_lo, block_hi;
+        bandBlockRange(band, center, block_num_x, TileDim, num_blocks_seq2, block_lo, block_hi);
+        zeroBandEdges(score, block_num_x, block_lo, block_hi, block_num_x > 0 ? ranges.lo.back() : 0,
+                      block_num_x > 0 ? ranges.hi.back() : -1, TileDim, size1, size2);
+        ranges.lo.push_back(block_lo);
+        ranges.hi.push_back(block_hi);
+    };
+
+    ThreadMax merged;
+    if (band.on() && band.adaptive) {
+        //a block row's blocks are only known once the row above is done, and they depend on each other,
+        //so the rows run one block after another with no scheduler
+        for (int block_num_x = 0; block_num_x < num_blocks_seq1; ++block_num_x) {
+            band_row(block_num_x, merged.score > 0 ? merged.j - merged.i : band.center);
+            for (int block_num_y = ranges.lo.back(); block_num_y <= ranges.hi.back(); ++block_num_y) {
+                std::tuple<int, int, int> block_out = run_block(block_num_x, block_num_y);
+                merged.update(std::get<0>(block_out), block_num_x * num_blocks_seq2 + block_num_y,
+                              std::get<1>(block_out), std::get<2>(block_out));
             }
         }
-        // std::cout << std::endl;  // New line for each anti-diagonal
+    } else {
+        //a band that does not move has every row up front, so its blocks still overlap across rows
+        for (int block_num_x = 0; band.on() && block_num_x < num_blocks_seq1; ++block_num_x) {
+            band_row(block_num_x, band.center);
+        }
+        merged = schedule_blocks(num_blocks_seq1, num_blocks_seq2, run_block, ranges);
     }
+    int maxI = merged.i, maxJ = merged.j;
 
     //backtrack to find the aligned sequences
     std::string alignedSeq1, alignedSeq2;
+    #ifdef AFFINE_GAP
+        affineBacktrack([&](int i, int j) { return xdrop.cell(ranges, score, i, j); }, scheme, seq1, seq2, maxI, maxJ, alignedSeq1, alignedSeq2);
+    #else
     size_t i = maxI, j = maxJ;
     //BACKTRACKING
     while (i > 0 && j > 0 && score[i][j] > 0)
     {
-        if (score[i][j] == score[i - 1][j - 1] + ((seq1[i - 1] == seq2[j - 1]) ? MATCH_SCORE : MISMATCH_SCORE))
+        if (score[i][j] == score[i - 1][j - 1] + scheme.score(seq1[i - 1], seq2[j - 1]))
         {
             alignedSeq1 += seq1[i - 1];
             alignedSeq2 += seq2[j - 1];
@@ -120,10 +326,108 @@ std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1
             j--;
         }
     }
+    #endif
 
     //reverse sequences
     std::reverse(alignedSeq1.begin(), alignedSeq1.end());
     std::reverse(alignedSeq2.begin(), alignedSeq2.end());
 
     return {alignedSeq1, alignedSeq2}; // Return the aligned sequences
-}
\ No newline at end of file
+}
+
+std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1, const char *seq2, size_t size2,
+                                                  const ScoringScheme& scheme, int tileDim, const Band& band, int xDrop) {
+    return withTileDim(tileDim, [&](auto tile) {
+        //half the memory traffic when the scores fit
+        if (scoreFitsInt16(size1, size2, scheme.maxScore)) {
+            return smithWatermanCells<int16_t, decltype(tile)::value>(seq1, size1, seq2, size2, scheme, band, xDrop);
+        }
+        return smithWatermanCells<int, decltype(tile)::value>(seq1, size1, seq2, size2, scheme, band, xDrop);
+    });
+}
+
+//score only, no matrix
+//the blocks hand their edges on instead:
+//  boundary_row[j] is the bottom row of the last block done in that block column
+//  left_cols[x] is the right column of the last block done in block row x, with the corner above it in [0]
+//a block only runs after the blocks above and to the left of it, and the next block in its row and column only after it,
+//so every edge is read by the one block that needs it before it is overwritten
+template <int TileDim>
+ScoreResult smithWatermanScoreTiles(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest,
+                                    const ScoringScheme& scheme) {
+    QueryProfile profile(scheme, seq1, size1, seq2, size2);
+    int num_blocks_seq1 = (size1 + TileDim - 1) / TileDim;
+    int num_blocks_seq2 = (size2 + TileDim - 1) / TileDim;
+
+    std::vector<int> boundary_row(size2 + 1, 0);
+    std::vector<std::vector<int>> left_cols(num_blocks_seq1, std::vector<int>(TileDim + 1, 0));
+    //per thread, merged at the end like the max
+    std::vector<std::vector<int>> col_max(secondBest ? omp_get_max_threads() : 0, std::vector<int>(size2 + 1, 0));
+    //gap scores on the block edges, handed on the same way as the edges, only with AFFINE_GAP
+    std::vector<int> gapE, gapF;
+    #ifdef AFFINE_GAP
+        gapE.assign(size1 + 1, 0);
+        gapF.assign(size2 + 1, 0);
+    #endif
+
+    ThreadMax merged = schedule_blocks(num_blocks_seq1, num_blocks_seq2, [&](int block_num_x, int block_num_y) {
+        int start_i = block_num_x * TileDim + 1;
+        int start_j = block_num_y * TileDim + 1;
+        int rows = min(TileDim, (int)size1 - start_i + 1);
+        int cols = min(TileDim, (int)size2 - start_j + 1);
+        std::vector<int>& left = left_cols[block_num_x];
+
+        //one block of scratch per thread, row 0 and column 0 are the edges
+        ScoreMatrix<int> tile(TileDim + 1, TileDim + 1);
+        for (int c = 1; c <= cols; ++c) {
+            tile[0][c] = boundary_row[start_j + c - 1];
+        }
+        if (block_num_y > 0) {
+            for (int r = 0; r <= rows; ++r) {
+                tile[r][0] = left[r];
+            }
+        }
+
+        std::tuple<int, int, int> block_out = process_block(1, rows, 1, cols, tile, seq1 + start_i - 1, profile, start_j - 1,
+                                                            gapE.data() + start_i - 1, gapF.data() + start_j - 1);
+
+        for (int r = 0; r <= rows; ++r) {
+            left[r] = tile[r][cols];
+        }
+        for (int c = 1; c <= cols; ++c) {
+            boundary_row[start_j + c - 1] = tile[rows][c];
+        }
+        if (secondBest) {
+            std::vector<int>& thread_col_max = col_max[omp_get_thread_num()];
+            for (int c = 1; c <= cols; ++c) {
+                for (int r = 1; r <= rows; ++r) {
+                    thread_col_max[start_j + c - 1] = std::max(thread_col_max[start_j + c - 1], tile[r][c]);
+                }
+            }
+        }
+
+        if (std::get<0>(block_out) == 0) {
+            return block_out;
+        }
+        return std::make_tuple(std::get<0>(block_out), std::get<1>(block_out) + start_i - 1, std::get<2>(block_out) + start_j - 1);
+    });
+
+    ScoreResult result = {merged.score, merged.i, merged.j, 0};
+    if (secondBest) {
+        std::vector<int> colMax(size2 + 1, 0);
+        for (const std::vector<int>& thread_col_max : col_max) {
+            for (size_t j = 1; j <= size2; ++j) {
+                colMax[j] = std::max(colMax[j], thread_col_max[j]);
+            }
+        }
+        result.secondScore = maskedSecondBest(colMax, result.maxJ, secondBestMask(size1, size2));
+    }
+    return result;
+}
+
+ScoreResult smithWatermanScore(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest,
+                               const ScoringScheme& scheme, int tileDim) {
+    return withTileDim(tileDim, [&](auto tile) {
+        return smithWatermanScoreTiles<decltype(tile)::value>(seq1, size1, seq2, size2, secondBest, scheme);
+    });
+}
@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <iostream>
+#include <bits/stdc++.h>
+#include <immintrin.h>
+#include "base_main.hpp"
+#include "../defines.hpp"
+#include "score_matrix.hpp"
+#include "score_only.hpp"
+#include "affine_gap.hpp"
+#include "tile_dim.hpp"
+#include "diag_block.hpp"
+#include <omp.h>
+
+//#define CHECK_CORE
+using namespace std;
+
+//anti-diagonal wavefront implementation
+//inside a block, cells are stored anti-diagonal by anti-diagonal, so every cell of a diagonal is contiguous
+//and one SIMD vector is a whole strip of the diagonal (each cell only needs the 2 diagonals before it)
+//across blocks, there is one parallel region for the whole matrix:
+//  each thread owns every nth row of blocks and walks it left to right,
+//  a block only waits on the flag of the block above it (the block to the left is its own previous block)
+//so there is no barrier between block diagonals
+
+template <typename T, int Block>
+struct DiagBlocks {
+    T* cells;
+    int num_blocks_seq1;
+    int num_blocks_seq2;
+
+    T* block(int block_num_x, int block_num_y) const {
+        return cells + ((size_t)block_num_x * num_blocks_seq2 + block_num_y) * diagBlockCells(Block);
+    }
+
+    //i and j are 1 indexed like score[i][j] in base_basic
+    int at(int i, int j) const {
+        if (i == 0 || j == 0) {
+            return 0;
+        }
+        int block_num_x = (i - 1) / Block;
+        int block_num_y = (j - 1) / Block;
+        return block(block_num_x, block_num_y)[diag_index<Block>(i - block_num_x * Block, j - block_num_y * Block)];
+    }
+};
+
+//fills the halo of a block from the blocks above and to the left
+template <typename T, int Block>
+void fill_halo(const DiagBlocks<T, Block>& blocks, int block_num_x, int block_num_y, int rows, int cols) {
+    T* blk = blocks.block(block_num_x, block_num_y);
+
+    if (block_num_x == 0) {
+        for (int c = 0; c <= cols; c++) {
+            blk[diag_index<Block>(0, c)] = 0;
+        }
+    } else {
+        const T* above = blocks.block(block_num_x - 1, block_num_y);
+        for (int c = 0; c <= cols; c++) {
+            blk[diag_index<Block>(0, c)] = above[diag_index<Block>(Block, c)];
+        }
+    }
+
+    if (block_num_y == 0) {
+        for (int r = 1; r <= rows; r++) {
+            blk[diag_index<Block>(r, 0)] = 0;
+        }
+    } else {
+        const T* left = blocks.block(block_num_x, block_num_y - 1);
+        for (int r = 1; r <= rows; r++) {
+            blk[diag_index<Block>(r, 0)] = left[diag_index<Block>(r, Block)];
+        }
+    }
+}
+
+//with AFFINE_GAP a block also needs E and F, they are only kept while the block is computed:
+//gap_blk is per thread scratch laid out like a block, E first then F, with the halo taken from
+//gapE[i] (E of the last column done in row i) and gapF[j] (F of the last row done in column j)
+//a row of blocks is only ever worked on by one thread, and a column of blocks one block at a time, so they are shared without locks
+template <typename T, int Block>
+void load_gap_halo(T* gap_blk, int rows, int cols, const T* gapE, const T* gapF) {
+    T* blkE = gap_blk;
+    T* blkF = gap_blk + diagBlockCells(Block);
+    for (int r = 1; r <= rows; r++) {
+        blkE[diag_index<Block>(r, 0)] = gapE[r];
+    }
+    for (int c = 1; c <= cols; c++) {
+        blkF[diag_index<Block>(0, c)] = gapF[c];
+    }
+}
+
+//hands the right column of E and the bottom row of F on to the next blocks
+template <typename T, int Block>
+void store_gap_edges(const T* gap_blk, int rows, int cols, T* gapE, T* gapF) {
+    const T* blkE = gap_blk;
+    const T* blkF = gap_blk + diagBlockCells(Block);
+    for (int r = 1; r <= rows; r++) {
+        gapE[r] = blkE[diag_index<Block>(r, cols)];
+    }
+    for (int c = 1; c <= cols; c++) {
+        gapF[c] = blkF[diag_index<Block>(rows, c)];
+    }
+}
+
+//first cell of a block in row major order that holds value
+template <typename T, int Block>
+void first_cell_with(const T* blk, int rows, int cols, int value, int& r_out, int& c_out) {
+    for (int r = 1; r <= rows; r++) {
+        for (int c = 1; c <= cols; c++) {
+            if (blk[diag_index<Block>(r, c)] == value) {
+                r_out = r;
+                c_out = c;
+                return;
+            }
+        }
+    }
+}
+
+template <typename T, int Block>
+std::pair<std::string, std::string> smithWatermanCells(const char *seq1, size_t size1, const char *seq2, size_t size2,
+                                                       const ScoringScheme& scheme) {
+
+    int num_blocks_seq1 = (size1 + Block - 1) / Block;
+    int num_blocks_seq2 = (size2 + Block - 1) / Block;
+    int num_blocks = num_blocks_seq1 * num_blocks_seq2;
+
+    //MATRIX ALLOCATION
+    DiagBlocks<T, Block> blocks;
+    blocks.cells = (T*)ScoreArena::local().reserve(sizeof(T) * diagBlockCells(Block) * num_blocks);
+    blocks.num_blocks_seq1 = num_blocks_seq1;
+    blocks.num_blocks_seq2 = num_blocks_seq2;
+
+    //padded so the fixed length strips never read outside the sequences
+    std::string seq1_pad = encodeSequence(scheme, seq1, size1);
+    seq1_pad.append(Block, 0);
+    std::string seq2_rev = encodeSequence(scheme, seq2, size2);
+    std::reverse(seq2_rev.begin(), seq2_rev.end());
+    seq2_rev.insert(0, 2 * Block, 0);
+    seq2_rev.append(Block, 0);
+
+    std::vector<int> block_max(num_blocks, 0);
+    std::unique_ptr<std::atomic<int>[]> block_done(new std::atomic<int>[num_blocks]);
+    for (int b = 0; b < num_blocks; b++) {
+        block_done[b].store(0, std::memory_order_relaxed);
+    }
+
+    //gap scores on the block edges, only with AFFINE_GAP
+    std::vector<T> gapE, gapF;
+    #ifdef AFFINE_GAP
+        gapE.assign(size1 + 1, 0);
+        gapF.assign(size2 + 1, 0);
+    #endif
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int num_threads = omp_get_num_threads();
+        std::vector<T> gap_blk;
+        #ifdef AFFINE_GAP
+            gap_blk.assign(2 * diagBlockCells(Block), 0);
+        #endif
+
+        #ifdef CHECK_CORE
+            printf("Thread %d is running on CPU %d\n", tid, sched_getcpu());
+        #endif
+
+        for (int block_num_x = tid; block_num_x < num_blocks_seq1; block_num_x += num_threads) {
+            int start_i = block_num_x * Block + 1;
+            int rows = std::min(Block, (int)size1 - start_i + 1);
+
+            for (int block_num_y = 0; block_num_y < num_blocks_seq2; block_num_y++) {
+                int start_j = block_num_y * Block + 1;
+                int cols = std::min(Block, (int)size2 - start_j + 1);
+
+                //wait on the block above, owned by another thread
+                if (block_num_x > 0) {
+                    const std::atomic<int>& above = block_done[(block_num_x - 1) * num_blocks_seq2 + block_num_y];
+                    while (above.load(std::memory_order_acquire) == 0) {
+                        _mm_pause();
+                    }
+                }
+
+                fill_halo(blocks, block_num_x, block_num_y, rows, cols);
+                #ifdef AFFINE_GAP
+                    load_gap_halo<T, Block>(gap_blk.data(), rows, cols, gapE.data() + start_i - 1, gapF.data() + start_j - 1);
+                #endif
+                block_max[block_num_x * num_blocks_seq2 + block_num_y] =
+                    process_block_diag<T, Block>(blocks.block(block_num_x, block_num_y), gap_blk.data(), rows, cols, scheme,
+                                       seq1_pad.data() + start_i - 1, seq2_rev.data(), 2 * Block + (int)size2 - start_j + 1);
+                #ifdef AFFINE_GAP
+                    store_gap_edges<T, Block>(gap_blk.data(), rows, cols, gapE.data() + start_i - 1, gapF.data() + start_j - 1);
+                #endif
+
+                block_done[block_num_x * num_blocks_seq2 + block_num_y].store(1, std::memory_order_release);
+            }
+        }
+    }
+
+    //the max is picked like base_basic: first block in row major order with the max, then first cell in that block
+    int maxScore = 0;
+    int maxI = 0, maxJ = 0;
+    int maxBlock = -1;
+    for (int b = 0; b < num_blocks; b++) {
+        if (block_max[b] > maxScore) {
+            maxScore = block_max[b];
+            maxBlock = b;
+        }
+    }
+    if (maxBlock >= 0) {
+        int start_i = (maxBlock / num_blocks_seq2) * Block + 1;
+        int start_j = (maxBlock % num_blocks_seq2) * Block + 1;
+        int rows = std::min(Block, (int)size1 - start_i + 1);
+        int cols = std::min(Block, (int)size2 - start_j + 1);
+        int r = 0, c = 0;
+        first_cell_with<T, Block>(blocks.block(maxBlock / num_blocks_seq2, maxBlock % num_blocks_seq2), rows, cols, maxScore, r, c);
+        maxI = start_i + r - 1;
+        maxJ = start_j + c - 1;
+    }
+
+    //backtrack to find the aligned sequences
+    std::string alignedSeq1, alignedSeq2;
+    #ifdef AFFINE_GAP
+        affineBacktrack([&](int i, int j) { return blocks.at(i, j); }, scheme, seq1, seq2, maxI, maxJ, alignedSeq1, alignedSeq2);
+    #else
+    size_t i = maxI, j = maxJ;
+    //BACKTRACKING
+    while (i > 0 && j > 0 && blocks.at(i, j) > 0)
+    {
+        if (blocks.at(i, j) == blocks.at(i - 1, j - 1) + scheme.score(seq1[i - 1], seq2[j - 1]))
+        {
+            alignedSeq1 += seq1[i - 1];
+            alignedSeq2 += seq2[j - 1];
+            i--;
+            j--;
+        }
+        else if (blocks.at(i, j) == blocks.at(i - 1, j) + GAP_SCORE)
+        {
+            alignedSeq1 += seq1[i - 1];
+            alignedSeq2 += '-';
+            i--;
+        }
+        else // score[i][j] == score[i][j - 1] + GAP_SCORE
+        {
+            alignedSeq1 += '-';
+            alignedSeq2 += seq2[j - 1];
+            j--;
+        }
+    }
+    #endif
+
+    //reverse sequences
+    std::reverse(alignedSeq1.begin(), alignedSeq1.end());
+    std::reverse(alignedSeq2.begin(), alignedSeq2.end());
+
+    return {alignedSeq1, alignedSeq2}; // Return the aligned sequences
+}
+
+//band and xDrop are only taken for the shared signature, every block waits on the block above it
+std::pair<std::string, std::string> smithWaterman(const char *seq1, size_t size1, const char *seq2, size_t size2,
+                                                  const ScoringScheme& scheme, int tileDim, const Band& band, int xDrop) {
+    return withTileDim(tileDim, [&](auto tile) {
+        //narrower cells mean more cells per SIMD instruction
+        if (scoreFitsInt16(size1, size2, scheme.maxScore)) {
+            return smithWatermanCells<int16_t, decltype(tile)::value>(seq1, size1, seq2, size2, scheme);
+        }
+        return smithWatermanCells<int, decltype(tile)::value>(seq1, size1, seq2, size2, scheme);
+    });
+}
+
+//score only, no block storage
+//each thread computes its blocks in one scratch block, the edges are handed on instead:
+//  boundary_row[j] is the bottom row of the last block done in that block column, a block waits on the block above as before
+//  the right column of a block (with the corner above it) stays with the thread for the next block in its row
+template <typename T, int Block>
+ScoreResult smithWatermanScoreCells(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest,
+                                    const ScoringScheme& scheme) {
+
+    int num_blocks_seq1 = (size1 + Block - 1) / Block;
+    int num_blocks_seq2 = (size2 + Block - 1) / Block;
+    int num_blocks = num_blocks_seq1 * num_blocks_seq2;
+
+    std::string seq1_pad = encodeSequence(scheme, seq1, size1);
+    seq1_pad.append(Block, 0);
+    std::string seq2_rev = encodeSequence(scheme, seq2, size2);
+    std::reverse(seq2_rev.begin(), seq2_rev.end());
+    seq2_rev.insert(0, 2 * Block, 0);
+    seq2_rev.append(Block, 0);
+
+    std::vector<T> boundary_row(size2 + 1, 0);
+    std::unique_ptr<std::atomic<int>[]> block_done(new std::atomic<int>[num_blocks]);
+    for (int b = 0; b < num_blocks; b++) {
+        block_done[b].store(0, std::memory_order_relaxed);
+    }
+
+    //per thread: best (score, block, i, j) and column maxes, merged at the end
+    int max_threads = omp_get_max_threads();
+    std::vector<std::tuple<int, int, int, int>> thread_best(max_threads, std::make_tuple(0, INT_MAX, 0, 0));
+    std::vector<std::vector<int>> col_max(secondBest ? max_threads : 0, std::vector<int>(size2 + 1, 0));
+    std::vector<T> gapE, gapF;
+    #ifdef AFFINE_GAP
+        gapE.assign(size1 + 1, 0);
+        gapF.assign(size2 + 1, 0);
+    #endif
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int num_threads = omp_get_num_threads();
+        T* blk = (T*)ScoreArena::local().reserve(sizeof(T) * diagBlockCells(Block));
+        std::vector<T> gap_blk;
+        #ifdef AFFINE_GAP
+            gap_blk.assign(2 * diagBlockCells(Block), 0);
+        #endif
+        T left[Block + 1];
+        std::tuple<int, int, int, int>& best = thread_best[tid];
+
+        for (int block_num_x = tid; block_num_x < num_blocks_seq1; block_num_x += num_threads) {
+            int start_i = block_num_x * Block + 1;
+            int rows = std::min(Block, (int)size1 - start_i + 1);
+            std::fill(left, left + Block + 1, 0);
+
+            for (int block_num_y = 0; block_num_y < num_blocks_seq2; block_num_y++) {
+                int start_j = block_num_y * Block + 1;
+                int cols = std::min(Block, (int)size2 - start_j + 1);
+                int block = block_num_x * num_blocks_seq2 + block_num_y;
+
+                if (block_num_x > 0) {
+                    const std::atomic<int>& above = block_done[block - num_blocks_seq2];
+                    while (above.load(std::memory_order_acquire) == 0) {
+                        _mm_pause();
+                    }
+                }
+
+                for (int r = 0; r <= rows; r++) {
+                    blk[diag_index<Block>(r, 0)] = left[r];
+                }
+                for (int c = 1; c <= cols; c++) {
+                    blk[diag_index<Block>(0, c)] = boundary_row[start_j + c - 1];
+                }
+                #ifdef AFFINE_GAP
+                    load_gap_halo<T, Block>(gap_blk.data(), rows, cols, gapE.data() + start_i - 1, gapF.data() + start_j - 1);
+                #endif
+                int blockMax = process_block_diag<T, Block>(blk, gap_blk.data(), rows, cols, scheme, seq1_pad.data() + start_i - 1,
+                                                  seq2_rev.data(), 2 * Block + (int)size2 - start_j + 1);
+                #ifdef AFFINE_GAP
+                    store_gap_edges<T, Block>(gap_blk.data(), rows, cols, gapE.data() + start_i - 1, gapF.data() + start_j - 1);
+                #endif
+
+                for (int r = 0; r <= rows; r++) {
+                    left[r] = blk[diag_index<Block>(r, cols)];
+                }
+                for (int c = 1; c <= cols; c++) {
+                    boundary_row[start_j + c - 1] = blk[diag_index<Block>(rows, c)];
+                }
+                block_done[block].store(1, std::memory_order_release);
+
+                //a thread sees its blocks in row major order, so only a strictly greater block can be the first max
+                if (blockMax > std::get<0>(best)) {
+                    int r = 0, c = 0;
+                    first_cell_with<T, Block>(blk, rows, cols, blockMax, r, c);
+                    best = std::make_tuple(blockMax, block, start_i + r - 1, start_j + c - 1);
+                }
+                if (secondBest) {
+                    std::vector<int>& thread_col_max = col_max[tid];
+                    for (int c = 1; c <= cols; c++) {
+                        for (int r = 1; r <= rows; r++) {
+                            thread_col_max[start_j + c - 1] = std::max(thread_col_max[start_j + c - 1], (int)blk[diag_index<Block>(r, c)]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //same pick as the full version: the highest max, then the first block in row major order
+    ScoreResult result = {0, 0, 0, 0};
+    int maxBlock = INT_MAX;
+    for (const std::tuple<int, int, int, int>& thread : thread_best) {
+        if (std::get<0>(thread) > result.score || (std::get<0>(thread) == result.score && std::get<1>(thread) < maxBlock)) {
+            result.score = std::get<0>(thread);
+            maxBlock = std::get<1>(thread);
+            result.maxI = std::get<2>(thread);
+            result.maxJ = std::get<3>(thread);
+        }
+    }
+    if (secondBest) {
+        std::vector<int> colMax(size2 + 1, 0);
+        for (const std::vector<int>& thread_col_max : col_max) {
+            for (size_t j = 1; j <= size2; j++) {
+                colMax[j] = std::max(colMax[j], thread_col_max[j]);
+            }
+        }
+        result.secondScore = maskedSecondBest(colMax, result.maxJ, secondBestMask(size1, size2));
+    }
+    return result;
+}
+
+ScoreResult smithWatermanScore(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest,
+                               const ScoringScheme& scheme, int tileDim) {
+    return withTileDim(tileDim, [&](auto tile) {
+        if (scoreFitsInt16(size1, size2, scheme.maxScore)) {
+            return smithWatermanScoreCells<int16_t, decltype(tile)::value>(seq1, size1, seq2, size2, secondBest, scheme);
+        }
+        return smithWatermanScoreCells<int, decltype(tile)::value>(seq1, size1, seq2, size2, secondBest, scheme);
+    });
+}
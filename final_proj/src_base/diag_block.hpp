@@ -0,0 +1,204 @@
+#ifndef DIAG_BLOCK_HPP
+#define DIAG_BLOCK_HPP
+
+#include <algorithm>
+#include <cstring>
+#include "../defines.hpp"
+#include "../scoring.hpp"
+
+//one block of the anti-diagonal wavefront engine (base_wave_diag.cpp) from its halo, with the GCC vector extensions
+//also used by the syst hosts to recompute the tiles of a backtrack from the kernel's tile edges (src_syst/host_traceback.hpp)
+
+//a block is Block x Block cells, Block is the tile size (tile_dim.hpp), a template argument so the strips stay fixed length
+//each block keeps a halo: row 0 is the last row of the block above, column 0 is the last column of the block to the left
+//so r and c go from 0 to Block, and there are 2 * Block + 1 diagonals d = r + c
+//every diagonal gets a full diagSlot(Block) cells indexed by r, even though most diagonals are shorter,
+//so every diagonal is the same fixed length strip and the compiler does not need scalar remainder loops
+constexpr int diagSlot(int block) {
+    return block + 1;
+}
+constexpr int diagBlockCells(int block) {
+    return (2 * block + 1) * diagSlot(block);
+}
+
+//where (r, c) of a block is stored
+template <int Block>
+static inline int diag_index(int r, int c) {
+    return (r + c) * diagSlot(Block) + r;
+}
+
+//native vector width, a diagonal is split into Block / lanes of these
+//only AVX-512 has a cheap single lane shift for every cell width (vpermw/vpermd),
+//without it, it is faster to reload the previous diagonals shifted by one cell from the block
+#if defined(__AVX512BW__)
+    #define DIAG_VEC_BYTES 64
+    #define DIAG_SHIFT_IN_REGISTERS
+#elif defined(__AVX2__)
+    #define DIAG_VEC_BYTES 32
+#else
+    #define DIAG_VEC_BYTES 16
+#endif
+
+//computes one block, returns the max of the block
+//a whole diagonal is held in vectors (lane k of the diagonal is row r = k + 1), built with the GCC vector extensions
+//the last two diagonals stay in registers, the above/diagonal neighbours are the previous diagonals moved up a lane,
+//with the top halo cell shifted into lane 0
+//seq1_block is the codes of seq1 starting at the first row of the block
+//seq2_rev is the codes of seq2 reversed, so the seq2 codes of a diagonal are increasing with r too
+//both have to be padded, the whole strip of every diagonal reads its codes
+//a uniform scheme compares the codes, anything else looks every lane up in the substitution matrix
+//gap_blk is the E / F scratch with its halo loaded (load_gap_halo), only used with AFFINE_GAP
+//E is the same lane of the previous diagonal like the left cell, F is moved up a lane like the above cell
+template <typename T, int Block>
+int process_block_diag(T* blk, T* gap_blk, int rows, int cols, const ScoringScheme& scheme,
+                       const char* seq1_block, const char* seq2_rev, int seq2_rev_offset) {
+    //a block smaller than the native vector (8 cells of 16 bits on AVX2) takes a whole diagonal in one narrower vector
+    static const int VEC_BYTES = (Block * sizeof(T) < DIAG_VEC_BYTES) ? Block * sizeof(T) : DIAG_VEC_BYTES;
+    static const int LANES = VEC_BYTES / sizeof(T);
+    static const int PIECES = Block / LANES;
+    static_assert(Block % LANES == 0, "Block has to be a multiple of the vector lanes");
+    typedef T vec_t __attribute__((vector_size(VEC_BYTES)));
+    typedef char chars_t __attribute__((vector_size(LANES)));
+
+    vec_t rowOf[PIECES];
+    for (int k = 0; k < LANES; k++) {
+        for (int p = 0; p < PIECES; p++) {
+            rowOf[p][k] = p * LANES + k + 1;
+        }
+    }
+    #ifdef DIAG_SHIFT_IN_REGISTERS
+        vec_t shiftMask;
+        for (int k = 0; k < LANES; k++) {
+            shiftMask[k] = (k == 0) ? LANES : k - 1;
+        }
+    #endif
+    const vec_t zero = vec_t{} + 0;
+    const bool uniform = scheme.uniform;
+    const T matchScoreDiff = scheme.matchScore - scheme.mismatchScore;
+    const T mismatchScore = scheme.mismatchScore;
+
+    chars_t seq1Chars[PIECES];
+    std::memcpy(seq1Chars, seq1_block, Block);
+
+    //diagonals 0 and 1, only the halo cells in them matter
+    vec_t prev2[PIECES], prev[PIECES];
+    std::memcpy(prev2, blk + 0 * diagSlot(Block) + 1, sizeof(prev2));
+    std::memcpy(prev, blk + 1 * diagSlot(Block) + 1, sizeof(prev));
+    vec_t blockMax = zero;
+    #ifdef AFFINE_GAP
+        T* blkE = gap_blk;
+        T* blkF = gap_blk + diagBlockCells(Block);
+        vec_t prevE[PIECES], prevF[PIECES];
+        std::memcpy(prevE, blkE + 1 * diagSlot(Block) + 1, sizeof(prevE));
+        std::memcpy(prevF, blkF + 1 * diagSlot(Block) + 1, sizeof(prevF));
+    #endif
+
+    for (int d = 2; d <= rows + cols; d++) {
+        T* cur = blk + d * diagSlot(Block);
+        vec_t stored[PIECES];
+        std::memcpy(stored, cur + 1, sizeof(stored));
+        //column c = d - r, so seq2[start_j + c - 2] = seq2_rev[seq2_rev_offset - d + r]
+        chars_t seq2Chars[PIECES];
+        std::memcpy(seq2Chars, seq2_rev + seq2_rev_offset - d + 1, Block);
+        const T r_lo = std::max(1, d - cols);
+        const T r_hi = std::min(rows, d - 1);
+
+        #ifdef DIAG_SHIFT_IN_REGISTERS
+            //row 0 of the last two diagonals is the top halo
+            T carryAbove = blk[(d - 1) * diagSlot(Block)];
+            T carryDiag = blk[(d - 2) * diagSlot(Block)];
+        #endif
+        #ifdef AFFINE_GAP
+            T* curE = blkE + d * diagSlot(Block);
+            T* curF = blkF + d * diagSlot(Block);
+            vec_t storedE[PIECES], storedF[PIECES];
+            std::memcpy(storedE, curE + 1, sizeof(storedE));
+            std::memcpy(storedF, curF + 1, sizeof(storedF));
+            vec_t nextE[PIECES], nextF[PIECES];
+            #ifdef DIAG_SHIFT_IN_REGISTERS
+                T carryF = blkF[(d - 1) * diagSlot(Block)];
+            #endif
+        #endif
+
+        vec_t next[PIECES];
+        for (int p = 0; p < PIECES; p++) {
+            vec_t matchScore;
+            if (uniform) {
+                vec_t isMatch = __builtin_convertvector(seq1Chars[p] == seq2Chars[p], vec_t);
+                matchScore = (isMatch & matchScoreDiff) + mismatchScore;
+            } else {
+                for (int k = 0; k < LANES; k++) {
+                    matchScore[k] = scheme.sub[(unsigned char)seq1Chars[p][k]][(unsigned char)seq2Chars[p][k]];
+                }
+            }
+
+            //row r - 1 of the last two diagonals
+            #ifdef DIAG_SHIFT_IN_REGISTERS
+                vec_t above = __builtin_shuffle(prev[p], zero + carryAbove, shiftMask);
+                vec_t diag = __builtin_shuffle(prev2[p], zero + carryDiag, shiftMask);
+                carryAbove = prev[p][LANES - 1];
+                carryDiag = prev2[p][LANES - 1];
+            #else
+                vec_t above, diag;
+                std::memcpy(&above, blk + (d - 1) * diagSlot(Block) + p * LANES, sizeof(vec_t));
+                std::memcpy(&diag, blk + (d - 2) * diagSlot(Block) + p * LANES, sizeof(vec_t));
+            #endif
+
+            vec_t score = diag + matchScore;
+            score = (score > zero) ? score : zero;
+            #ifdef AFFINE_GAP
+                #ifdef DIAG_SHIFT_IN_REGISTERS
+                    vec_t aboveF = __builtin_shuffle(prevF[p], zero + carryF, shiftMask);
+                    carryF = prevF[p][LANES - 1];
+                #else
+                    vec_t aboveF;
+                    std::memcpy(&aboveF, blkF + (d - 1) * diagSlot(Block) + p * LANES, sizeof(vec_t));
+                #endif
+                vec_t gapE = prevE[p] + GAP_EXTEND;
+                vec_t gap = prev[p] + GAP_OPEN;
+                gapE = (gapE > gap) ? gapE : gap;
+                gapE = (gapE > zero) ? gapE : zero;
+                vec_t gapF = aboveF + GAP_EXTEND;
+                gap = above + GAP_OPEN;
+                gapF = (gapF > gap) ? gapF : gap;
+                gapF = (gapF > zero) ? gapF : zero;
+                score = (score > gapE) ? score : gapE;
+                score = (score > gapF) ? score : gapF;
+            #else
+                vec_t gap = above + GAP_SCORE;
+                score = (score > gap) ? score : gap;
+                gap = prev[p] + GAP_SCORE;
+                score = (score > gap) ? score : gap;
+            #endif
+
+            //cells outside the block (and the left halo) keep what is stored
+            vec_t inside = (rowOf[p] >= r_lo) & (rowOf[p] <= r_hi);
+            next[p] = inside ? score : stored[p];
+            #ifdef AFFINE_GAP
+                nextE[p] = inside ? gapE : storedE[p];
+                nextF[p] = inside ? gapF : storedF[p];
+            #endif
+
+            vec_t insideScore = inside ? score : zero;
+            blockMax = (blockMax > insideScore) ? blockMax : insideScore;
+        }
+        std::memcpy(cur + 1, next, sizeof(next));
+
+        std::memcpy(prev2, prev, sizeof(prev));
+        std::memcpy(prev, next, sizeof(next));
+        #ifdef AFFINE_GAP
+            std::memcpy(curE + 1, nextE, sizeof(nextE));
+            std::memcpy(curF + 1, nextF, sizeof(nextF));
+            std::memcpy(prevE, nextE, sizeof(nextE));
+            std::memcpy(prevF, nextF, sizeof(nextF));
+        #endif
+    }
+
+    int maxScore = 0;
+    for (int k = 0; k < LANES; k++) {
+        maxScore = std::max(maxScore, (int)blockMax[k]);
+    }
+    return maxScore;
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef QUERY_PROFILE_HPP
+#define QUERY_PROFILE_HPP
+
+#include <algorithm>
+#include <vector>
+#include "../scoring.hpp"
+
+//query profile for the row by row CPU baselines
+//row(c)[j] is the score of c against seq2[j - 1], so the inner loops over j do a lookup instead of comparing characters
+//there is only a row for every code that shows up in seq1, so DNA against a long seq2 is 5 rows and not SCORE_ALPHABET
+class QueryProfile {
+public:
+    QueryProfile(const ScoringScheme& scheme, const char* seq1, size_t size1, const char* seq2, size_t size2)
+        : scheme(scheme), width(size2 + 1) {
+        std::fill(rowOf, rowOf + SCORE_ALPHABET, -1);
+        int numRows = 0;
+        for (size_t i = 0; i < size1; ++i) {
+            unsigned char c = scheme.encode(seq1[i]);
+            if (rowOf[c] < 0) {
+                rowOf[c] = numRows++;
+            }
+        }
+
+        scores.resize((size_t)numRows * width);
+        for (int c = 0; c < SCORE_ALPHABET; ++c) {
+            if (rowOf[c] < 0) {
+                continue;
+            }
+            int* row = &scores[(size_t)rowOf[c] * width];
+            row[0] = 0;
+            for (size_t j = 1; j < width; ++j) {
+                row[j] = scheme.sub[c][scheme.encode(seq2[j - 1])];
+            }
+        }
+    }
+
+    //c has to be a character of seq1
+    const int* row(char c) const { return &scores[(size_t)rowOf[scheme.encode(c)] * width]; }
+
+private:
+    const ScoringScheme& scheme;
+    size_t width;
+    int rowOf[SCORE_ALPHABET];
+    std::vector<int> scores;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef SCORE_MATRIX_HPP
+#define SCORE_MATRIX_HPP
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "../defines.hpp"
+
+//flat score storage for the CPU baselines
+//the whole matrix is one 64 byte aligned block, every row is padded out to a multiple of 64 bytes
+//so rows start on a cache line and there is no per row allocation or pointer chasing
+
+#define SCORE_ALIGNMENT 64
+
+//owns the memory behind the score matrices
+//it only grows, so repeated calls of similar size never go back to the allocator
+//one per thread, so concurrent alignments do not share storage
+class ScoreArena {
+public:
+    ~ScoreArena() { std::free(data); }
+
+    void* reserve(size_t bytes) {
+        if (bytes > capacity) {
+            std::free(data);
+            //grow geometrically so slowly increasing sizes do not reallocate every call
+            size_t newCapacity = std::max(bytes, capacity * 2);
+            newCapacity = (newCapacity + SCORE_ALIGNMENT - 1) / SCORE_ALIGNMENT * SCORE_ALIGNMENT;
+            data = std::aligned_alloc(SCORE_ALIGNMENT, newCapacity);
+            if (data == nullptr) {
+                capacity = 0;
+                throw std::bad_alloc();
+            }
+            capacity = newCapacity;
+        }
+        return data;
+    }
+
+    static ScoreArena& local() {
+        static thread_local ScoreArena arena;
+        return arena;
+    }
+
+private:
+    void* data = nullptr;
+    size_t capacity = 0;
+};
+
+//(rows x cols) score matrix, cell type T is int16_t when the max possible score fits, int otherwise
+//only row 0 and column 0 are zeroed, every other cell has to be written before it is read
+template <typename T>
+class ScoreMatrix {
+public:
+    ScoreMatrix(size_t rows, size_t cols, ScoreArena& arena = ScoreArena::local()) : numRows(rows), numCols(cols) {
+        const size_t cellsPerLine = SCORE_ALIGNMENT / sizeof(T);
+        stride = (cols + cellsPerLine - 1) / cellsPerLine * cellsPerLine;
+        cells = (T*)arena.reserve(sizeof(T) * stride * rows);
+
+        std::memset(cells, 0, sizeof(T) * cols);
+        for (size_t i = 1; i < rows; ++i) {
+            cells[i * stride] = 0;
+        }
+    }
+
+    T* operator[](size_t i) { return cells + i * stride; }
+    const T* operator[](size_t i) const { return cells + i * stride; }
+
+    size_t rows() const { return numRows; }
+    size_t cols() const { return numCols; }
+
+private:
+    T* cells;
+    size_t stride;
+    size_t numRows;
+    size_t numCols;
+};
+
+//int16_t cells are only safe if no cell can go past INT16_MAX
+//every cell is at most the best substitution score for each matched pair, so the shorter sequence bounds it
+inline bool scoreFitsInt16(size_t size1, size_t size2, int maxScore = MATCH_SCORE) {
+    size_t shorter = size1 < size2 ? size1 : size2;
+    return shorter * std::max(maxScore, 1) <= INT16_MAX;
+}
+
+#endif
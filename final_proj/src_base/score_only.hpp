@@ -0,0 +1,103 @@
+#ifndef SCORE_ONLY_HPP
+#define SCORE_ONLY_HPP
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+#include "base_main.hpp"
+#include "../defines.hpp"
+#include "affine_gap.hpp"
+#include "query_profile.hpp"
+#include "tile_dim.hpp"
+
+//helpers for smithWatermanScore(), shared by the CPU baselines
+
+//ends closer than this to the best end (in seq2) are part of the best alignment, not a second one
+inline int secondBestMask(size_t size1, size_t size2) {
+    return std::max(SECOND_BEST_MIN_MASK, (int)(std::min(size1, size2) / 2));
+}
+
+//colMax[j] is the max of column j (1 indexed)
+//returns the best column max more than the mask away from maxJ
+inline int maskedSecondBest(const std::vector<int>& colMax, int maxJ, int mask) {
+    int second = 0;
+    for (int j = 1; j < (int)colMax.size(); ++j) {
+        if (j < maxJ - mask || j > maxJ + mask) {
+            second = std::max(second, colMax[j]);
+        }
+    }
+    return second;
+}
+
+//two rolling rows, no matrix (with AFFINE_GAP, plus the F row and the E of the current cell)
+//the max of every block of the current block row is merged once the block row is done,
+//so the end cell is the one the blocked baselines pick (first strictly greater in block order) at the same TileDim
+template <int TileDim>
+ScoreResult rollingRowScore(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest,
+                            const ScoringScheme& scheme) {
+    QueryProfile profile(scheme, seq1, size1, seq2, size2);
+    std::vector<int> above(size2 + 1, 0);
+    std::vector<int> row(size2 + 1, 0);
+    std::vector<int> colMax(secondBest ? size2 + 1 : 0, 0);
+    #ifdef AFFINE_GAP
+        std::vector<int> gapF(size2 + 1, 0);
+    #endif
+
+    ScoreResult result = {0, 0, 0, 0};
+
+    int num_blocks_seq2 = (size2 + TileDim - 1) / TileDim;
+    std::vector<std::tuple<int, int, int>> block_max(num_blocks_seq2, std::make_tuple(0, 0, 0));
+
+    for (size_t i = 1; i <= size1; ++i) {
+        #ifdef AFFINE_GAP
+            int gapE = 0;
+        #endif
+        const int* profileRow = profile.row(seq1[i - 1]);
+        for (size_t j = 1; j <= size2; ++j) {
+            int matchScore = profileRow[j];
+            #ifdef AFFINE_GAP
+                row[j] = gotohCell(above[j - 1] + matchScore, row[j - 1], above[j], gapE, gapF[j]);
+            #else
+                row[j] = std::max({0,
+                                   above[j - 1] + matchScore,
+                                   above[j] + GAP_SCORE,
+                                   row[j - 1] + GAP_SCORE});
+            #endif
+            std::tuple<int, int, int>& block = block_max[(j - 1) / TileDim];
+            if (row[j] > std::get<0>(block)) {
+                block = std::make_tuple(row[j], (int)i, (int)j);
+            }
+        }
+        if (secondBest) {
+            for (size_t j = 1; j <= size2; ++j) {
+                colMax[j] = std::max(colMax[j], row[j]);
+            }
+        }
+        std::swap(above, row);
+
+        if (i % TileDim == 0 || i == size1) {
+            for (std::tuple<int, int, int>& block : block_max) {
+                if (std::get<0>(block) > result.score) {
+                    result.score = std::get<0>(block);
+                    result.maxI = std::get<1>(block);
+                    result.maxJ = std::get<2>(block);
+                }
+                block = std::make_tuple(0, 0, 0);
+            }
+        }
+    }
+
+    if (secondBest) {
+        result.secondScore = maskedSecondBest(colMax, result.maxJ, secondBestMask(size1, size2));
+    }
+    return result;
+}
+
+inline ScoreResult rollingRowScore(const char *seq1, size_t size1, const char *seq2, size_t size2, bool secondBest,
+                                   const ScoringScheme& scheme, int tileDim) {
+    return withTileDim(tileDim, [&](auto tile) {
+        return rollingRowScore<decltype(tile)::value>(seq1, size1, seq2, size2, secondBest, scheme);
+    });
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef TILE_DIM_HPP
+#define TILE_DIM_HPP
+
+#include <type_traits>
+#include "../defines.hpp"
+
+//block sizes the blocked baselines are built for, the same ones the syst kernel can be synthesized at
+//a block loop takes its size as a template argument, so its bounds and block arrays are compile time constants,
+//and withTileDim() turns the size base_main -t asked for into that argument, so sweeping it is not a rebuild
+inline bool isTileDim(int tileDim) {
+    return tileDim == 8 || tileDim == 16 || tileDim == 32 || tileDim == 64;
+}
+
+//run(std::integral_constant<int, tileDim>()), anything but the sizes above runs at BASELINE_TILE_DIM
+template <typename Run>
+auto withTileDim(int tileDim, Run run) -> decltype(run(std::integral_constant<int, BASELINE_TILE_DIM>())) {
+    switch (tileDim) {
+        case 8: return run(std::integral_constant<int, 8>());
+        case 16: return run(std::integral_constant<int, 16>());
+        case 32: return run(std::integral_constant<int, 32>());
+        case 64: return run(std::integral_constant<int, 64>());
+        default: return run(std::integral_constant<int, BASELINE_TILE_DIM>());
+    }
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef XDROP_BLOCKS_HPP
+#define XDROP_BLOCKS_HPP
+
+#include <algorithm>
+#include <vector>
+#include "band_blocks.hpp"
+#include "score_matrix.hpp"
+
+//X-drop on the blocked engines that keep the whole ScoreMatrix, base_basic and base_wave
+//a block is dead once every cell on its edges (bottom row, right column) is more than xDrop below the best of it
+//and of every block it was reached from, and a block that only reads dead or skipped blocks is skipped
+//the best is the one along the dependencies rather than the global one so far, so the threads of base_wave
+//skip the same blocks whatever order they run them in, and base_basic skips those too
+//the XDROP kernel drops against the best before its tile row, so it skips other tiles and is not expected to match these
+//a skipped block gets zero edges like the ones a band skips, every other block reads them like it always does
+//alignments that start fresh behind dead blocks are lost, that is the X-drop trade
+
+struct XDropBlocks {
+    int xDrop;
+        //< 0 is off, every block runs
+    int num_blocks_seq2;
+    int tileDim;
+    std::vector<int> reach;
+        //per block (row major), the best of the block and every block it was reached from
+    std::vector<char> live;
+    std::vector<char> skipped;
+
+    XDropBlocks(int xDrop, int num_blocks_seq1, int num_blocks_seq2, int tileDim)
+        : xDrop(xDrop), num_blocks_seq2(num_blocks_seq2), tileDim(tileDim) {
+        if (on()) {
+            reach.assign((size_t)num_blocks_seq1 * num_blocks_seq2, 0);
+            live.assign((size_t)num_blocks_seq1 * num_blocks_seq2, 0);
+            skipped.assign((size_t)num_blocks_seq1 * num_blocks_seq2, 0);
+        }
+    }
+
+    bool on() const { return xDrop >= 0; }
+
+    //before block (x, y) runs, once the blocks it reads are done: false if it is skipped
+    //it reads the blocks above and to the left in ranges, and the corner one when neither is (BlockRanges::cornerDep)
+    //a block that reads none of them is where an alignment can start, so it always runs
+    bool enter(const BlockRanges& ranges, int block_num_x, int block_num_y) {
+        if (!on()) {
+            return true;
+        }
+        int block = block_num_x * num_blocks_seq2 + block_num_y;
+        bool reads = false;
+        bool fed = false;
+        auto from = [&](int dep) {
+            reads = true;
+            reach[block] = std::max(reach[block], reach[dep]);
+            fed = fed || live[dep];
+        };
+        if (block_num_x > 0 && ranges.has(block_num_x - 1, block_num_y)) {
+            from(block - num_blocks_seq2);
+        }
+        if (block_num_y > 0 && ranges.has(block_num_x, block_num_y - 1)) {
+            from(block - 1);
+        }
+        if (ranges.cornerDep(block_num_x, block_num_y)) {
+            from(block - num_blocks_seq2 - 1);
+        }
+        if (reads && !fed) {
+            skipped[block] = 1;
+            return false;
+        }
+        return true;
+    }
+
+    //after block (x, y) ran, blockMax is the best cell in it
+    template <typename T>
+    void leave(const ScoreMatrix<T>& matrix, int block_num_x, int block_num_y, int blockMax, size_t size1, size_t size2) {
+        if (!on()) {
+            return;
+        }
+        int block = block_num_x * num_blocks_seq2 + block_num_y;
+        int start_i = block_num_x * tileDim + 1;
+        int start_j = block_num_y * tileDim + 1;
+        int end_i = std::min(start_i + tileDim - 1, (int)size1);
+        int end_j = std::min(start_j + tileDim - 1, (int)size2);
+        int edgeMax = 0;
+        for (int j = start_j; j <= end_j; ++j) {
+            edgeMax = std::max(edgeMax, (int)matrix[end_i][j]);
+        }
+        for (int i = start_i; i <= end_i; ++i) {
+            edgeMax = std::max(edgeMax, (int)matrix[i][end_j]);
+        }
+        reach[block] = std::max(reach[block], blockMax);
+        live[block] = edgeMax >= reach[block] - xDrop;
+    }
+
+    //zeroes the edges of a block enter() skipped, and its E / F with AFFINE_GAP (gapE / gapF of process_block)
+    template <typename T>
+    void zeroEdges(ScoreMatrix<T>& matrix, int block_num_x, int block_num_y, size_t size1, size_t size2, int* gapE, int* gapF) const {
+        int start_i = block_num_x * tileDim + 1;
+        int start_j = block_num_y * tileDim + 1;
+        int end_i = std::min(start_i + tileDim - 1, (int)size1);
+        int end_j = std::min(start_j + tileDim - 1, (int)size2);
+        std::fill(matrix[end_i] + start_j, matrix[end_i] + end_j + 1, 0);
+        for (int i = start_i; i <= end_i; ++i) {
+            matrix[i][end_j] = 0;
+        }
+        #ifdef AFFINE_GAP
+            std::fill(gapE + start_i, gapE + end_i + 1, 0);
+            std::fill(gapF + start_j, gapF + end_j + 1, 0);
+        #endif
+    }
+
+    //cell (i, j) for the backtrack, 0 in a skipped block and in the ones the band skipped
+    template <typename T>
+    int cell(const BlockRanges& ranges, const ScoreMatrix<T>& matrix, int i, int j) const {
+        if (on() && i > 0 && j > 0 && skipped[((i - 1) / tileDim) * num_blocks_seq2 + (j - 1) / tileDim]) {
+            return 0;
+        }
+        return ranges.cell(matrix, i, j);
+    }
+};
+
+#endif
@@ -10,6 +10,8 @@
 #include "xrt/xrt_kernel.h"
 #include "xrt/xrt_bo.h"
 #include "../defines.hpp"
+#include "../scoring.hpp"
+#include "../src_syst/aligner_session.hpp"
 #include <chrono>
 #include <cmath>
 #include <numeric>    // For std::accumulate
@@ -107,134 +109,33 @@ void printUsage(const char* programName) {
     std::cout << "  -x <directory>      Specify directory where build_dir.hw.xilinx_u250_gen3x16_xdma_4_1_202210_1/SW_syst.link.xclbin is located" << std::endl;
     std::cout << "  -o [filename]       Output the full alignment results to a text file" << std::endl;
     std::cout << "                      (default: alignment_results.txt if no filename provided)" << std::endl;
-    std::cout << "  -s <tile_size>      Specify the tile dimension size (mandatory)" << std::endl;
+    std::cout << "  -s <tile_size>      Tile dimension the xclbin should have, read from the kernel if not given" << std::endl;
     std::cout << "  -h                  Display this help message" << std::endl;
 }
 
 // Function to run a single execution and return the time
+// The session keeps the programmed device and the buffers, so a run is only the transfers and the kernel
 double runSingleExecution(const std::string& seq1, const std::string& seq2, 
-                         xrt::device& myDevice, xrt::xclbin& xclbin, 
+                         AlignerSession& session, 
                          int tileDimension, bool printOutput = true,
                          const std::string& outputFile = "") {
-    // Define input sequences
-    int seqsize[2] = {static_cast<int>(seq1.length()), 
-                      static_cast<int>(seq2.length())}; // Original sequence lengths
-    
-    // Calculate padded sizes and number of tiles
-    int inputsize1 = ceilToMultiple(seqsize[0], tileDimension) + 1;
-    int inputsize2 = ceilToMultiple(seqsize[1], tileDimension) + 1;
-    int numTilesVar[2] = {
-        numTiles(seqsize[0], tileDimension), // Number of horizontal tiles
-        numTiles(seqsize[1], tileDimension)  // Number of vertical tiles
-    };
-    
-    if (printOutput) {
-        std::cout << "Input sizes: " << inputsize1 << " || " << inputsize2 << std::endl;
-        std::cout << "Tile counts: " << numTilesVar[0] << " || " << numTilesVar[1] << std::endl;
-    }
-    
-    // Allocate memory for sequences
-    char* seq1Buf = (char*)malloc(inputsize1 * sizeof(char));
-    char* seq2Buf = (char*)malloc(inputsize2 * sizeof(char));
-    
-    // Copy sequences
-    strcpy(seq1Buf, seq1.c_str());
-    strcpy(seq2Buf, seq2.c_str());
-    
-    // Output buffers for aligned sequences
-    char* alignedSeq1 = (char*)malloc((seqsize[0]+seqsize[1]) * sizeof(char));
-    char* alignedSeq2 = (char*)malloc((seqsize[0]+seqsize[1]) * sizeof(char));
-    
-    // Pointer for score buffer - size needs to include the boundary cells
-    int buffer_horz_size = numTilesVar[0] * (tileDimension + 1)  * 2;
-    int buffer_vert_size = numTilesVar[1];
-
-    // Allocate buffer
-    int* buffer = (int*)malloc(sizeof(int) * buffer_horz_size * buffer_vert_size);
-
-    // Print input with truncation
     if (printOutput) {
-        std::cout << "Sequence 1: " << truncateString(seq1Buf) << std::endl;
-        std::cout << "Sequence 2: " << truncateString(seq2Buf) << std::endl;
+        std::cout << "Input sizes: " << ceilToMultiple(seq1.length(), tileDimension) + 1 << " || "
+                  << ceilToMultiple(seq2.length(), tileDimension) + 1 << std::endl;
+        std::cout << "Tile counts: " << numTiles(seq1.length(), tileDimension) << " || "
+                  << numTiles(seq2.length(), tileDimension) << std::endl;
+        std::cout << "Sequence 1: " << truncateString(seq1) << std::endl;
+        std::cout << "Sequence 2: " << truncateString(seq2) << std::endl;
     }
 
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Input Load Complete" << std::endl;
-    #endif
-
-    auto uuid = myDevice.load_xclbin(xclbin);
-
-    xrt::kernel SW_basic_linear(myDevice, uuid, "SW_basic_linear");
-
-    xrt::run RunObj = xrt::run(SW_basic_linear);
-
-    // Make the buffers
-    auto seq1_bo = xrt::bo(myDevice, sizeof(char) * inputsize1, 
-                           SW_basic_linear.group_id(0));
-    auto seq2_bo = xrt::bo(myDevice, sizeof(char) * inputsize2, 
-                           SW_basic_linear.group_id(1));
-    auto buffer_bo = xrt::bo(myDevice, sizeof(int) * buffer_horz_size * buffer_vert_size, 
-                            xrt::bo::flags::device_only, SW_basic_linear.group_id(2));
-    auto seqsz_bo = xrt::bo(myDevice, sizeof(int) * 2, 
-                            SW_basic_linear.group_id(5));
-    auto tilenum_bo = xrt::bo(myDevice, sizeof(int) * 2, 
-                            SW_basic_linear.group_id(6));
-    auto align1_bo = xrt::bo(myDevice, sizeof(char) * (seqsize[0]+seqsize[1]), 
-                            SW_basic_linear.group_id(3));
-    auto align2_bo = xrt::bo(myDevice, sizeof(char) * (seqsize[0]+seqsize[1]), 
-                            SW_basic_linear.group_id(4));
-
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Buffers Created " << std::endl;
-    #endif
-
-    // Copy host data
+    std::string alignedSeq1, alignedSeq2;
     auto start = std::chrono::high_resolution_clock::now();
-    seq1_bo.write(seq1Buf, sizeof(char) * inputsize1, 0);
-    seq2_bo.write(seq2Buf, sizeof(char) * inputsize2, 0);
-    seqsz_bo.write(seqsize, sizeof(int) * 2, 0);
-    tilenum_bo.write(numTilesVar, sizeof(int) * 2, 0);
-    // DO NOT CALL WRITE OR SYNC FOR BUFFER
-    seq1_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-    seq2_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-    seqsz_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-    tilenum_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Buffers Written " << std::endl;
-    #endif
-
-    // Run the kernel
-    RunObj.set_arg(0, seq1_bo);
-    RunObj.set_arg(1, seq2_bo);
-    RunObj.set_arg(2, buffer_bo);
-    RunObj.set_arg(3, seqsz_bo);
-    RunObj.set_arg(4, tilenum_bo);
-    RunObj.set_arg(5, align1_bo);
-    RunObj.set_arg(6, align2_bo);
-    RunObj.start();
-    RunObj.wait();
-
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Execution Complete " << std::endl;
-    #endif    
-
-    // Read back the output
-    align1_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-    align2_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    if (!session.align(seq1, seq2, alignedSeq1, alignedSeq2)) {
+        std::cerr << session.refusal(seq1, seq2) << std::endl;
+        return -1.0;
+    }
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - start;
-    
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Execution Complete " << std::endl;
-    #endif  
-    
-    align1_bo.read(alignedSeq1);
-    align2_bo.read(alignedSeq2);
-
-    // Reverse the aligned sequences
-    std::reverse(alignedSeq1, alignedSeq1 + strlen(alignedSeq1));
-    std::reverse(alignedSeq2, alignedSeq2 + strlen(alignedSeq2));
 
     if (printOutput) {
         // Print results with truncation
@@ -247,7 +148,7 @@ double runSingleExecution(const std::string& seq1, const std::string& seq2,
         std::ofstream outFile(outputFile);
         if (outFile.is_open()) {
             // Calculate the full alignment length
-            size_t alignLen = strlen(alignedSeq1);
+            size_t alignLen = alignedSeq1.length();
             
             // Write header
             outFile << "Smith-Waterman Alignment Results" << std::endl;
@@ -315,13 +216,6 @@ double runSingleExecution(const std::string& seq1, const std::string& seq2,
         }
     }
 
-    // Free memory
-    std::free(seq1Buf);
-    std::free(seq2Buf);
-    std::free(alignedSeq1);
-    std::free(alignedSeq2);
-    std::free(buffer);
-
     return duration.count(); // Return execution time
 }
 
@@ -329,7 +223,7 @@ int main(int argc, char* argv[]) {
     std::string testFilePath = ""; // Must be set by -f flag
     std::string xclbinDir = "."; // Default to current directory
     std::string outputFile = ""; // Optional output file
-    int tileDimension = -1; // Must be set by -s flag
+    int tileDimension = -1; // -s, checked against the kernel's
     
     // FPGA-only implementation
     xrt::device myDevice; 
@@ -372,14 +266,6 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    if (tileDimension == -1) {
-        std::cerr << "Error: Tile dimension (-s) is mandatory." << std::endl;
-        printUsage(argv[0]);
-        return 1;
-    }
-    
-    std::cout << "Using tile dimension: " << tileDimension << std::endl;
-    
     // Construct the full xclbin path by appending the required path to the specified directory
     std::string fullXclbinPath;
     // Add trailing slash to directory if not present
@@ -453,7 +339,21 @@ int main(int argc, char* argv[]) {
     seqIds[0] = sequences[seq1Index].id;
     seqIds[1] = sequences[seq2Index].id;
     
-    double time = runSingleExecution(seq1, seq2, myDevice, xclbin, tileDimension, true, outputFile);
+    AlignerSession session(myDevice, xclbin);
+    const KernelConfig& config = session.kernelConfig();
+    std::cout << "Kernel: " << config.describe() << std::endl;
+    if (!config.mismatch().empty()) {
+        std::cerr << config.mismatch() << std::endl;
+        return 1;
+    }
+    // The tile size is the xclbin's, -s only says which one this run expects
+    if (tileDimension != -1 && tileDimension != config.tileDimension) {
+        std::cerr << "Error: -s " << tileDimension << " but the xclbin was built with tile size " << config.tileDimension << std::endl;
+        return 1;
+    }
+    tileDimension = config.tileDimension;
+    std::cout << "Using tile dimension: " << tileDimension << std::endl;
+    double time = runSingleExecution(seq1, seq2, session, tileDimension, true, outputFile);
     std::cout << "Total time taken: " << time << " seconds" << std::endl;
     
     std::cout << "Alignment completed." << std::endl;
@@ -9,6 +9,7 @@
 #include "xrt/xrt_kernel.h"
 #include "xrt/xrt_bo.h"
 #include "../defines.hpp"
+#include "../scoring.hpp"
 #include <chrono>
 #include <cmath>
 
@@ -206,6 +207,11 @@ int main(int argc, char* argv[]) {
                             SW_basic_linear.group_id(5));
     auto tilenum_bo = xrt::bo(myDevice, sizeof(int) * 2, 
                             SW_basic_linear.group_id(6));
+    auto scoring_bo = xrt::bo(myDevice, sizeof(int) * SCORING_WORDS, 
+                            SW_basic_linear.group_id(7));
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
+        //the default scores, packed the way the kernel reads them
     auto align1_bo = xrt::bo(myDevice, sizeof(char) * (seqsize[0]+seqsize[1]), 
                             SW_basic_linear.group_id(3));
     auto align2_bo = xrt::bo(myDevice, sizeof(char) * (seqsize[0]+seqsize[1]), 
@@ -221,11 +227,13 @@ int main(int argc, char* argv[]) {
     seq2_bo.write(seq2, sizeof(char) * inputsize2, 0);
     seqsz_bo.write(seqsize, sizeof(int) * 2, 0);
     tilenum_bo.write(numTilesVar, sizeof(int) * 2, 0);
+    scoring_bo.write(scoring, sizeof(int) * SCORING_WORDS, 0);
     //DO NOT CALL WRITE OR SYNC FOR BUFFER
     seq1_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     seq2_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     seqsz_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     tilenum_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    scoring_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
 
     #ifdef DEBUG
         std::cout << "Buffers Written " << std::endl;
@@ -239,6 +247,7 @@ int main(int argc, char* argv[]) {
     RunObj.set_arg(4, tilenum_bo);
     RunObj.set_arg(5, align1_bo);
     RunObj.set_arg(6, align2_bo);
+    RunObj.set_arg(7, scoring_bo);
     RunObj.start();
     RunObj.wait();
 
@@ -5,6 +5,18 @@
 #include <ap_int.h>
 #include <iostream>
 
+#ifdef AFFINE_GAP
+    #error "this kernel only does linear gaps (GAP_SCORE), use src_syst for AFFINE_GAP"
+#endif
+
+#ifdef PACKED_SEQ
+    #error "this kernel reads the sequences as chars, use src_syst for PACKED_SEQ"
+#endif
+
+#if SCORE_BITS <= 16
+    #error "this kernel keeps int scores in its buffer, use src_syst for a narrow SCORE_BITS"
+#endif
+
 void seq_buffer_load(char seq1_tilebuffer[TILE_DIMENSION], char seq2_tilebuffer[TILE_DIMENSION], char* seq1, char* seq2, int seq1_tile, int seq2_tile) {
     int seq1_start = seq1_tile * TILE_DIMENSION;
     int seq2_start = seq2_tile * TILE_DIMENSION;
@@ -82,8 +94,10 @@ extern "C" void SW_basic_linear(
     const int seqsize[2], const int tilenum[2], 
         //0 = seq1_len   //0 = ceil(seq1_len/TILE_SIZE)
         //1 = seq2_len   //1 = ceil(seq2_len/TILE_SIZE)
-    char* alignedSeq1, char* alignedSeq2) 
+    char* alignedSeq1, char* alignedSeq2,
         //maximum length of these is seq1_len+seq2_len (includes null term)
+    const int* scoring)
+        //packed ScoringScheme, SCORING_WORDS long
 
     //seq1 is on top, seq2 is on left
 
@@ -104,6 +118,8 @@ extern "C" void SW_basic_linear(
     #pragma HLS INTERFACE s_axilite port=alignedSeq1 bundle=control
     #pragma HLS INTERFACE m_axi port=alignedSeq2 offset=slave bundle=gmem4 depth=128
     #pragma HLS INTERFACE s_axilite port=alignedSeq2 bundle=control
+    #pragma HLS INTERFACE m_axi port=scoring offset=slave bundle=gmem7 depth=1280
+    #pragma HLS INTERFACE s_axilite port=scoring bundle=control
     #pragma HLS INTERFACE s_axilite port=return bundle=control
 
     //initalizing tile buffers
@@ -112,6 +128,11 @@ extern "C" void SW_basic_linear(
     char seq2_tilebuffer[TILE_DIMENSION];
     #pragma HLS ARRAY_PARTITION variable=seq2_tilebuffer complete
 
+    //scoring scheme, the match score is a lookup of both codes
+    int subMatrix[SCORE_ALPHABET][SCORE_ALPHABET];
+    unsigned char codeTable[256];
+    scoring_load(scoring, subMatrix, codeTable);
+
     //ceil of seqsize / TILEDIM
     int horz_tile_max = tilenum[0];
     int vert_tile_max = tilenum[1];
@@ -165,7 +186,7 @@ extern "C" void SW_basic_linear(
                 #pragma HLS PIPELINE
                 score_right_loop: for (int j = 1; j <= TILE_DIMENSION; j++) {
 
-                    int matchScore = (seq1_tilebuffer[j - 1] == seq2_tilebuffer[i - 1]) ? MATCH_SCORE : MISMATCH_SCORE;
+                    int matchScore = subMatrix[codeTable[(unsigned char)seq1_tilebuffer[j - 1]]][codeTable[(unsigned char)seq2_tilebuffer[i - 1]]];
                     score[i][j] = std::max(
                         0,
                         std::max(score[i - 1][j - 1] + matchScore,
@@ -243,9 +264,9 @@ extern "C" void SW_basic_linear(
     backtrack_loop: while (i > 0 && j > 0 && buffer[i * buffer_horz_size + j] != 0) {
     //#pragma HLS PIPELINE
         #ifdef DEBUG_BACKTRACK
-            std::cout << " |||  = " << ((seq1[j] == seq2[i]) ? MATCH_SCORE : MISMATCH_SCORE) << " dia  = " << buffer[(i-1) * buffer_horz_size + j-1] << " |  me " << buffer[i * buffer_horz_size + j] << std::endl;
+            std::cout << " |||  = " << subMatrix[codeTable[(unsigned char)seq1[j]]][codeTable[(unsigned char)seq2[i]]] << " dia  = " << buffer[(i-1) * buffer_horz_size + j-1] << " |  me " << buffer[i * buffer_horz_size + j] << std::endl;
         #endif
-        if (buffer[i * buffer_horz_size + j] == (buffer[(i-1) * buffer_horz_size + j-1] + ((seq1[j] == seq2[i]) ? MATCH_SCORE : MISMATCH_SCORE))) {
+        if (buffer[i * buffer_horz_size + j] == (buffer[(i-1) * buffer_horz_size + j-1] + subMatrix[codeTable[(unsigned char)seq1[j]]][codeTable[(unsigned char)seq2[i]]])) {
             alignedSeq1[idx] = seq1[j];
             alignedSeq2[idx] = seq2[i];
             i--;
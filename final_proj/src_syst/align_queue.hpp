@@ -0,0 +1,125 @@
+#ifndef ALIGN_QUEUE_HPP
+#define ALIGN_QUEUE_HPP
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+//keeps every slot of a backend busy, so pair N + 1 is written and started while pair N is still on the kernel
+//a backend has slots() slots (buffer sets), each with at most one pair in flight:
+//  bool submit(slot, seq1, seq2) writes the pair and starts it without waiting, false if it can't take the pair
+//  bool collect(slot, aligned1, aligned2) waits for the slot's pair and reads it back, false if it failed
+//AlignerSession is the device backend, SoftwareAlignBackend runs the same slots on CPU threads
+//push() only blocks once every slot is taken, and then only until the oldest pair is done,
+//its callback runs right there on the calling thread while the other slots keep the kernel busy
+template <typename Backend>
+class AlignQueue {
+public:
+    //called once per pushed pair, in push order, ok is false if the backend didn't take it or it failed
+    typedef std::function<void(size_t id, bool ok, const std::string& aligned1, const std::string& aligned2)> Callback;
+
+    //depth is how many pairs can be in flight at once, at most the backend's slots
+    AlignQueue(Backend& backend, Callback done, int depth = 0) : backend(backend), done(done) {
+        int numSlots = (depth > 0 && depth < backend.slots()) ? depth : backend.slots();
+        for (int slot = numSlots - 1; slot >= 0; slot--) {
+            freeSlots.push_back(slot);
+        }
+    }
+
+    ~AlignQueue() { drain(); }
+
+    //returns the id the callback gets for this pair
+    size_t push(const std::string& seq1, const std::string& seq2) {
+        size_t id = nextId++;
+        if (freeSlots.empty()) {
+            finishOldest();
+        }
+        int slot = freeSlots.back();
+        freeSlots.pop_back();
+        bool ok = backend.submit(slot, seq1, seq2);
+        inFlight.push_back({id, slot, ok});
+        return id;
+    }
+
+    //waits for every pair in flight
+    void drain() {
+        while (!inFlight.empty()) {
+            finishOldest();
+        }
+    }
+
+    size_t pending() const { return inFlight.size(); }
+
+private:
+    struct InFlight {
+        size_t id;
+        int slot;
+        bool ok;
+    };
+
+    void finishOldest() {
+        InFlight oldest = inFlight.front();
+        inFlight.pop_front();
+        aligned1.clear();
+        aligned2.clear();
+        if (oldest.ok) {
+            oldest.ok = backend.collect(oldest.slot, aligned1, aligned2);
+        }
+        freeSlots.push_back(oldest.slot);
+        done(oldest.id, oldest.ok, aligned1, aligned2);
+    }
+
+    Backend& backend;
+    Callback done;
+    std::vector<int> freeSlots;
+    std::deque<InFlight> inFlight;
+    size_t nextId = 0;
+    std::string aligned1;
+    std::string aligned2;
+};
+
+//stand in for AlignerSession with no XRT: every slot runs align on a thread of its own
+//align is anything with the AlignerSession::align() signature, e.g. a call of the kernel source
+class SoftwareAlignBackend {
+public:
+    typedef std::function<bool(const std::string& seq1, const std::string& seq2,
+                               std::string& aligned1, std::string& aligned2)> AlignFunction;
+
+    SoftwareAlignBackend(AlignFunction align, int numSlots = 2) : align(align), slotList(numSlots) {}
+
+    int slots() const { return (int)slotList.size(); }
+
+    bool submit(int slotIndex, const std::string& seq1, const std::string& seq2) {
+        Slot& slot = slotList[slotIndex];
+        slot.seq1 = seq1;
+        slot.seq2 = seq2;
+        slot.result = std::async(std::launch::async, [this, &slot]() {
+            return align(slot.seq1, slot.seq2, slot.aligned1, slot.aligned2);
+        });
+        return true;
+    }
+
+    bool collect(int slotIndex, std::string& aligned1, std::string& aligned2) {
+        Slot& slot = slotList[slotIndex];
+        bool ok = slot.result.get();
+        aligned1 = slot.aligned1;
+        aligned2 = slot.aligned2;
+        return ok;
+    }
+
+private:
+    struct Slot {
+        std::string seq1;
+        std::string seq2;
+        std::string aligned1;
+        std::string aligned2;
+        std::future<bool> result;
+    };
+
+    AlignFunction align;
+    std::vector<Slot> slotList;
+};
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef ALIGNER_SESSION_HPP
+#define ALIGNER_SESSION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_kernel.h"
+#include "xrt/xrt_bo.h"
+#include "../defines.hpp"
+#include "../scoring.hpp"
+#include "../packed_seq.hpp"
+#include "../sw_algo.hpp"
+#include "../cigar.hpp"
+#include "kernel_config.hpp"
+
+//everything a run of SW_basic_linear needs, kept across alignments
+//the xclbin is loaded once, the kernel and runs are made once and the scoring scheme is written once,
+//the buffer objects are only remade when a pair does not fit, doubling until it does
+//so after the first few pairs an alignment is writes, syncs and one start / wait, no allocation
+//every slot is its own run and set of buffers, so one slot's transfers can go while another's pair is on the kernel
+//(align_queue.hpp keeps the slots busy)
+//with more than one compute unit in the xclbin (v++ --connectivity.nk) slot s runs on compute unit s % computeUnits()
+//(cu_scheduler.hpp spreads pairs over them)
+//the tile size, score width and boundary planes are the xclbin's (kernelConfig()), not this host's defines.hpp
+class AlignerSession {
+public:
+    //the kernel the session runs
+    //ALIGN_STRINGS: SW_basic_linear, the aligned strings come back
+    //FORWARD_ONLY: SW_forward_linear, collectForward() gives back the end cell and the tile edges
+    //  and the backtrack is the host's (host_traceback.hpp)
+    //ALIGN_CIGAR: SW_cigar_linear, only the cigar runs come back and collect() expands them (cigar.hpp)
+    enum Mode { ALIGN_STRINGS, FORWARD_ONLY, ALIGN_CIGAR };
+
+    //initialBases pre-sizes the buffers for a pair of sequences that long
+    //numSlots 0 gives one slot per compute unit
+    AlignerSession(xrt::device& device, const xrt::xclbin& xclbin,
+                   const ScoringScheme& scheme = defaultScheme(), int initialBases = 1024, int numSlots = 1,
+                   Mode mode = ALIGN_STRINGS)
+        : device(device), scheme(scheme), mode(mode) {
+        uuid = device.load_xclbin(xclbin);
+        config = KernelConfig::query(device, uuid);
+        tileDimension = config.tileDimension;
+        std::string kernelName = mode == FORWARD_ONLY ? "SW_forward_linear" : (mode == ALIGN_CIGAR ? "SW_cigar_linear" : "SW_basic_linear");
+        int scoringArg = mode == FORWARD_ONLY ? 6 : 7;
+        std::vector<std::string> cuNames = computeUnitNames(xclbin, kernelName);
+        int scoring[SCORING_WORDS];
+        scheme.pack(scoring);
+        for (const std::string& cuName : cuNames) {
+            //one kernel per compute unit, so its buffers go in the memory banks that compute unit is linked to
+            ComputeUnit cu;
+            cu.kernel = xrt::kernel(device, uuid, cuNames.size() > 1 ? kernelName + ":{" + cuName + "}" : kernelName);
+            cu.scoring_bo = xrt::bo(device, sizeof(int) * SCORING_WORDS, cu.kernel.group_id(scoringArg));
+            cu.scoring_bo.write(scoring, sizeof(int) * SCORING_WORDS, 0);
+            cu.scoring_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+            cuList.push_back(cu);
+        }
+        if (numSlots <= 0) {
+            numSlots = (int)cuList.size();
+        }
+
+        std::string initial(initialBases, 'A');
+        int tiles = (initialBases + tileDimension - 1) / tileDimension;
+        KernelSeq initialSeq;
+        kernelSequence(initial, tiles * tileDimension, initialSeq);
+
+        slotList.resize(numSlots);
+        for (int slotIndex = 0; slotIndex < numSlots; slotIndex++) {
+            Slot& slot = slotList[slotIndex];
+            slot.cu = slotIndex % (int)cuList.size();
+            xrt::kernel& kernel = cuList[slot.cu].kernel;
+            slot.run = xrt::run(kernel);
+            slot.seqsize_bo = xrt::bo(device, sizeof(int) * 2, kernel.group_id(3));
+            slot.tilenum_bo = xrt::bo(device, sizeof(int) * 2, kernel.group_id(4));
+            slot.run.set_arg(3, slot.seqsize_bo);
+            slot.run.set_arg(4, slot.tilenum_bo);
+            slot.run.set_arg(scoringArg, cuList[slot.cu].scoring_bo);
+
+            reserve(slot, slot.seq1, initialSeq.bytes());
+            reserve(slot, slot.seq2, initialSeq.bytes());
+            if (mode == FORWARD_ONLY) {
+                //the host reads the edges back, so buffer can't be device only
+                slot.boundary.deviceOnly = false;
+                slot.result_bo = xrt::bo(device, sizeof(int) * 3, kernel.group_id(5));
+                slot.run.set_arg(5, slot.result_bo);
+            } else if (mode == ALIGN_CIGAR) {
+                slot.result_bo = xrt::bo(device, sizeof(int) * CIGAR_RESULT_WORDS, kernel.group_id(6));
+                slot.run.set_arg(6, slot.result_bo);
+            }
+            reserve(slot, slot.boundary, boundaryBytes(tiles, tiles));
+            if (mode == ALIGN_STRINGS) {
+                reserve(slot, slot.align1, 2 * initialBases);
+                reserve(slot, slot.align2, 2 * initialBases);
+            } else if (mode == ALIGN_CIGAR) {
+                reserve(slot, slot.cigar, sizeof(unsigned int) * 2 * initialBases);
+            }
+        }
+    }
+
+    int slots() const { return (int)slotList.size(); }
+    //the loaded xclbin, for other kernels of it
+    const xrt::uuid& xclbinUuid() const { return uuid; }
+    int computeUnits() const { return (int)cuList.size(); }
+    int computeUnit(int slotIndex) const { return slotList[slotIndex].cu; }
+    //what the xclbin was built with, a host that gets a non empty kernelConfig().mismatch() can't use this session
+    const KernelConfig& kernelConfig() const { return config; }
+    int tileSize() const { return tileDimension; }
+
+    //the compute units of kernelName in the xclbin, by cu name (SW_basic_linear_1, ...), at least one
+    static std::vector<std::string> computeUnitNames(const xrt::xclbin& xclbin, const std::string& kernelName) {
+        std::vector<std::string> names;
+        for (const auto& cu : xclbin.get_kernel(kernelName).get_cus()) {
+            std::string name = cu.get_name();
+            names.push_back(name.substr(name.find(':') + 1));
+                //the ip layout names them kernel:cu
+        }
+        if (names.empty()) {
+            names.push_back(kernelName);
+        }
+        return names;
+    }
+
+    //writes the pair to the slot's buffers and starts the kernel, does not wait for it
+    //false if the pair can't go to the kernel, see kernelSequence(), scoreBitsNeeded() and KernelConfig::mismatch()
+    bool submit(int slotIndex, const std::string& seq1Str, const std::string& seq2Str) {
+        Slot& slot = slotList[slotIndex];
+        if (!config.mismatch().empty() ||
+            scoreBitsNeeded(scheme, seq1Str.length(), seq2Str.length()) > config.scoreBits) {
+            return false;
+        }
+        int seqsize[2] = {(int)seq1Str.length(), (int)seq2Str.length()};
+        int tilenum[2] = {(seqsize[0] + tileDimension - 1) / tileDimension,
+                          (seqsize[1] + tileDimension - 1) / tileDimension};
+
+        if (!kernelSequence(seq1Str, tilenum[0] * tileDimension, slot.seq1_in) ||
+            !kernelSequence(seq2Str, tilenum[1] * tileDimension, slot.seq2_in)) {
+            return false;
+        }
+        slot.outputBytes = seqsize[0] + seqsize[1];
+        slot.tiles = (size_t)tilenum[0] * tilenum[1];
+        reserve(slot, slot.seq1, slot.seq1_in.bytes());
+        reserve(slot, slot.seq2, slot.seq2_in.bytes());
+        reserve(slot, slot.boundary, boundaryBytes(tilenum[0], tilenum[1]));
+        if (mode == ALIGN_STRINGS) {
+            reserve(slot, slot.align1, slot.outputBytes);
+            reserve(slot, slot.align2, slot.outputBytes);
+        } else if (mode == ALIGN_CIGAR) {
+            //a run can be a single step, so room for one a step, though only the runs written come back
+            reserve(slot, slot.cigar, sizeof(unsigned int) * slot.outputBytes);
+            slot.seq1Str = seq1Str;
+            slot.seq2Str = seq2Str;
+        }
+
+        //only the part of a buffer this pair uses is written and synced
+        slot.seq1.bo.write(slot.seq1_in.data(), slot.seq1_in.bytes(), 0);
+        slot.seq2.bo.write(slot.seq2_in.data(), slot.seq2_in.bytes(), 0);
+        slot.seqsize_bo.write(seqsize, sizeof(int) * 2, 0);
+        slot.tilenum_bo.write(tilenum, sizeof(int) * 2, 0);
+        //DO NOT CALL WRITE OR SYNC FOR BUFFER
+        slot.seq1.bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, slot.seq1_in.bytes(), 0);
+        slot.seq2.bo.sync(XCL_BO_SYNC_BO_TO_DEVICE, slot.seq2_in.bytes(), 0);
+        slot.seqsize_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+        slot.tilenum_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+
+        slot.run.start();
+        return true;
+    }
+
+    //waits for the slot's pair, aligned1 / aligned2 come back in order (the kernel writes them reversed)
+    //with ALIGN_CIGAR they are expanded from the runs
+    bool collect(int slotIndex, std::string& aligned1, std::string& aligned2) {
+        Slot& slot = slotList[slotIndex];
+        if (mode == ALIGN_CIGAR) {
+            int result[CIGAR_RESULT_WORDS];
+            collectCigar(slotIndex, result, slot.runs);
+            expandCigar(slot.seq1Str, slot.seq2Str, result, slot.runs.data(), aligned1, aligned2);
+            return true;
+        }
+        slot.run.wait();
+        readAligned(slot, slot.align1, aligned1);
+        readAligned(slot, slot.align2, aligned2);
+        return true;
+    }
+
+    //ALIGN_CIGAR only: waits for the slot's pair, result is SW_cigar_linear's and runs gets the runs as the kernel wrote them
+    //only result[5] runs are synced back, not the seq1_len + seq2_len words the buffer has room for
+    bool collectCigar(int slotIndex, int result[CIGAR_RESULT_WORDS], std::vector<unsigned int>& runs) {
+        Slot& slot = slotList[slotIndex];
+        slot.run.wait();
+        slot.result_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+        slot.result_bo.read(result, sizeof(int) * CIGAR_RESULT_WORDS, 0);
+        size_t runBytes = sizeof(unsigned int) * result[5];
+        runs.resize(result[5]);
+        if (runBytes > 0) {
+            slot.cigar.bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE, runBytes, 0);
+            slot.cigar.bo.read(runs.data(), runBytes, 0);
+        }
+        return true;
+    }
+
+    //FORWARD_ONLY only: waits for the slot's pair, best is SW_forward_linear's (score, end in seq1, end in seq2)
+    //and edges gets the tile edges out of buffer, only those, not the traceback pointers an xclbin with them writes after
+    bool collectForward(int slotIndex, int best[3], std::vector<char>& edges) {
+        Slot& slot = slotList[slotIndex];
+        slot.run.wait();
+        slot.result_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+        slot.result_bo.read(best, sizeof(int) * 3, 0);
+        size_t edgeBytes = (size_t)config.boundaryWordBytes() *
+                           alignBufferWords(slot.tiles, tileDimension, config.boundaryWordBytes() * 8, config.boundaryPlanes, 0);
+        edges.resize(edgeBytes);
+        slot.boundary.bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE, edgeBytes, 0);
+        slot.boundary.bo.read(edges.data(), edgeBytes, 0);
+        return true;
+    }
+
+    //why submit() turns a pair down
+    std::string refusal(const std::string& seq1Str, const std::string& seq2Str) const {
+        if (!config.mismatch().empty()) {
+            return config.mismatch();
+        }
+        int bits = scoreBitsNeeded(scheme, seq1Str.length(), seq2Str.length());
+        if (bits > config.scoreBits) {
+            return "needs " + std::to_string(bits) + " bit scores, the kernel has " + std::to_string(config.scoreBits);
+        }
+        return "PACKED_SEQ only takes A C G T N sequences";
+    }
+
+    //one pair start to end on slot 0
+    bool align(const std::string& seq1Str, const std::string& seq2Str, std::string& aligned1, std::string& aligned2) {
+        if (!submit(0, seq1Str, seq2Str)) {
+            return false;
+        }
+        return collect(0, aligned1, aligned2);
+    }
+
+    //how many times a buffer object had to be made, the pre-sized ones included
+    int bufferAllocations() const { return allocations; }
+
+private:
+    //a buffer object, the kernel argument it is bound to and how big it is
+    struct Buffer {
+        int arg;
+        bool deviceOnly;
+        xrt::bo bo;
+        size_t capacity;
+    };
+
+    struct ComputeUnit {
+        xrt::kernel kernel;
+        xrt::bo scoring_bo;
+            //read only, shared by every slot on this compute unit
+    };
+
+    struct Slot {
+        int cu = 0;
+        xrt::run run;
+        Buffer seq1 = {0, false, xrt::bo(), 0};
+        Buffer seq2 = {1, false, xrt::bo(), 0};
+        Buffer boundary = {2, true, xrt::bo(), 0};
+        Buffer align1 = {5, false, xrt::bo(), 0};
+        Buffer align2 = {6, false, xrt::bo(), 0};
+        xrt::bo seqsize_bo;
+        xrt::bo tilenum_bo;
+        Buffer cigar = {5, false, xrt::bo(), 0};
+        xrt::bo result_bo;
+            //FORWARD_ONLY's best or ALIGN_CIGAR's result
+        size_t tiles = 0;
+
+        //host side staging, reused like the buffer objects
+        KernelSeq seq1_in;
+        KernelSeq seq2_in;
+        std::vector<char> output;
+        size_t outputBytes = 0;
+        std::string seq1Str;
+        std::string seq2Str;
+        std::vector<unsigned int> runs;
+            //ALIGN_CIGAR, what collect() expands
+    };
+
+    size_t boundaryBytes(int horzTiles, int vertTiles) const {
+        return config.bufferBytes((size_t)horzTiles * vertTiles);
+            //with AFFINE_GAP the gap edges go after the score edges, with TRACEBACK_POINTERS the pointers after those
+    }
+
+    void reserve(Slot& slot, Buffer& buffer, size_t bytes) {
+        if (buffer.capacity > 0 && bytes <= buffer.capacity) {
+            return;
+        }
+        size_t capacity = std::max<size_t>(buffer.capacity, 64);
+        while (capacity < bytes) {
+            capacity *= 2;
+        }
+        xrt::kernel& kernel = cuList[slot.cu].kernel;
+        if (buffer.deviceOnly) {
+            buffer.bo = xrt::bo(device, capacity, xrt::bo::flags::device_only, kernel.group_id(buffer.arg));
+        } else {
+            buffer.bo = xrt::bo(device, capacity, kernel.group_id(buffer.arg));
+        }
+        buffer.capacity = capacity;
+        slot.run.set_arg(buffer.arg, buffer.bo);
+        allocations++;
+    }
+
+    void readAligned(Slot& slot, Buffer& buffer, std::string& aligned) {
+        slot.output.resize(slot.outputBytes + 1);
+        buffer.bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE, slot.outputBytes, 0);
+        buffer.bo.read(slot.output.data(), slot.outputBytes, 0);
+        slot.output[slot.outputBytes] = 0;
+        aligned.assign(slot.output.data());
+        std::reverse(aligned.begin(), aligned.end());
+    }
+
+    xrt::device& device;
+    xrt::uuid uuid;
+    KernelConfig config;
+    int tileDimension;
+    ScoringScheme scheme;
+    Mode mode;
+    std::atomic<int> allocations{0};
+        //slots on different compute units can be driven from different threads
+
+    std::vector<ComputeUnit> cuList;
+    std::vector<Slot> slotList;
+};
+
+#endif
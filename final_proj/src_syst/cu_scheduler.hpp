@@ -0,0 +1,144 @@
+#ifndef CU_SCHEDULER_HPP
+#define CU_SCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//spreads a batch of pairs over the compute units of a backend, longest job first
+//a pair costs tilenum[0] * tilenum[1] tiles, the kernel's run time goes with that
+//the pairs are sorted by it, biggest first, and every compute unit takes the next one as soon as it is free,
+//so the big pairs start early and the small ones fill in the gaps at the end instead of one big pair going last
+//the backend is the same as for AlignQueue (align_queue.hpp), one slot per compute unit:
+//AlignerSession with numSlots 0, or FakeCuBackend below
+template <typename Backend>
+class CuScheduler {
+public:
+    //called once per pair, id is its index in the batch
+    //calls come from the compute units' threads, one at a time, about in the order the pairs finish (finishOrder() has it exactly)
+    //the other compute units keep recording and taking pairs while a callback runs
+    typedef std::function<void(size_t id, bool ok, const std::string& aligned1, const std::string& aligned2)> Callback;
+    typedef std::pair<std::string, std::string> Pair;
+
+    //what one compute unit did in the last run()
+    struct CuStats {
+        int pairs = 0;
+        long tiles = 0;
+        double busySeconds = 0;
+            //from its submits to its collects, the time the compute unit had a pair
+    };
+
+    CuScheduler(Backend& backend, int tileDimension) : backend(backend), tileDimension(tileDimension) {}
+
+    //aligns every pair, returns when they are all done
+    void run(const std::vector<Pair>& pairs, Callback done) {
+        std::vector<size_t> order(pairs.size());
+        for (size_t id = 0; id < pairs.size(); id++) {
+            order[id] = id;
+        }
+        //stable, so pairs of the same size go in batch order
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return tiles(pairs[a]) > tiles(pairs[b]);
+        });
+
+        cuStats.assign(backend.slots(), CuStats());
+        finishedIds.clear();
+        std::atomic<size_t> next{0};
+        std::mutex statsMutex, callbackMutex;
+        auto start = std::chrono::high_resolution_clock::now();
+
+        //one thread per compute unit, it only waits on its own compute unit
+        std::vector<std::thread> workers;
+        for (int cu = 0; cu < backend.slots(); cu++) {
+            workers.emplace_back([&, cu]() {
+                std::string aligned1, aligned2;
+                for (size_t n = next++; n < order.size(); n = next++) {
+                    size_t id = order[n];
+                    const Pair& pair = pairs[id];
+                    auto busyStart = std::chrono::high_resolution_clock::now();
+                    bool ok = backend.submit(cu, pair.first, pair.second);
+                    aligned1.clear();
+                    aligned2.clear();
+                    if (ok) {
+                        ok = backend.collect(cu, aligned1, aligned2);
+                    }
+                    std::chrono::duration<double> busy = std::chrono::high_resolution_clock::now() - busyStart;
+
+                    {
+                        std::lock_guard<std::mutex> lock(statsMutex);
+                        cuStats[cu].pairs++;
+                        cuStats[cu].tiles += tiles(pair);
+                        cuStats[cu].busySeconds += busy.count();
+                        finishedIds.push_back(id);
+                    }
+                    //a slow callback only holds up the other callbacks, not the other compute units' next pairs
+                    std::lock_guard<std::mutex> lock(callbackMutex);
+                    done(id, ok, aligned1, aligned2);
+                }
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        std::chrono::duration<double> wall = std::chrono::high_resolution_clock::now() - start;
+        wallTime = wall.count();
+    }
+
+    int computeUnits() const { return backend.slots(); }
+    const CuStats& stats(int cu) const { return cuStats[cu]; }
+    double wallSeconds() const { return wallTime; }
+    //busy time over the run's wall time
+    double utilization(int cu) const { return wallTime > 0 ? cuStats[cu].busySeconds / wallTime : 0; }
+    //ids in the order they finished
+    const std::vector<size_t>& finishOrder() const { return finishedIds; }
+
+    long tiles(const Pair& pair) const {
+        long horzTiles = ((long)pair.first.length() + tileDimension - 1) / tileDimension;
+        long vertTiles = ((long)pair.second.length() + tileDimension - 1) / tileDimension;
+        return horzTiles * vertTiles;
+    }
+
+private:
+    Backend& backend;
+    int tileDimension;
+    std::vector<CuStats> cuStats;
+    std::vector<size_t> finishedIds;
+    double wallTime = 0;
+};
+
+//compute units that take secondsPerTile for every tile of a pair and align nothing, to check the scheduling without a card
+//submit() returns straight away, collect() sleeps until the pair would be done
+class FakeCuBackend {
+public:
+    FakeCuBackend(int numCus, int tileDimension, double secondsPerTile)
+        : tileDimension(tileDimension), secondsPerTile(secondsPerTile), finishAt(numCus) {}
+
+    int slots() const { return (int)finishAt.size(); }
+
+    bool submit(int cu, const std::string& seq1, const std::string& seq2) {
+        long horzTiles = ((long)seq1.length() + tileDimension - 1) / tileDimension;
+        long vertTiles = ((long)seq2.length() + tileDimension - 1) / tileDimension;
+        finishAt[cu] = std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(secondsPerTile * horzTiles * vertTiles));
+        return true;
+    }
+
+    bool collect(int cu, std::string& aligned1, std::string& aligned2) {
+        std::this_thread::sleep_until(finishAt[cu]);
+        return true;
+    }
+
+private:
+    int tileDimension;
+    double secondsPerTile;
+    std::vector<std::chrono::steady_clock::time_point> finishAt;
+};
+
+#endif
@@ -0,0 +1,263 @@
+#ifndef HOST_TRACEBACK_HPP
+#define HOST_TRACEBACK_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <string>
+#include <vector>
+#include "../defines.hpp"
+#include "../scoring.hpp"
+#include "../sw_algo.hpp"
+#include "../src_base/diag_block.hpp"
+#include "../src_base/score_matrix.hpp"
+#include "../src_base/tile_dim.hpp"
+
+//SW_basic_linear's backtrack on the CPU, for SW_forward_linear, which stops once its tiles are done
+//the kernel leaves every tile's edges in buffer, a tile the backtrack goes into is recomputed from them with
+//base_wave_diag's anti-diagonal SIMD block (diag_block.hpp) and walked with align_pair's compares,
+//so the alignment is the one SW_basic_linear would have written
+//a block's rows are seq1 and its columns seq2, the kernel's tile on its side: block (r, c) is tile cell (c, r),
+//and the block's E (from the column before) is the kernel's F, its F the kernel's E
+
+//the tile edges as the kernel left them in buffer, words of wordBytes (KernelConfig::boundaryWordBytes())
+//plane 0 is H, plane 1 the gap scores with AFFINE_GAP (F on the bottom, E on the right)
+struct TileEdges {
+    const char* buffer;
+    int wordBytes;
+    int tileDimension;
+    int horzTiles;
+    int vertTiles;
+
+    int word(size_t index) const {
+        const char* at = buffer + index * wordBytes;
+        if (wordBytes == 1) {
+            return *(const int8_t*)at;
+        }
+        if (wordBytes == 2) {
+            int16_t value;
+            std::memcpy(&value, at, sizeof(value));
+            return value;
+        }
+        int32_t value;
+        std::memcpy(&value, at, sizeof(value));
+        return value;
+    }
+
+    size_t slot(int plane, int vertTile, int horzTile) const {
+        size_t slotWords = (size_t)(tileDimension + 1) * 2;
+        return ((size_t)plane * vertTiles * horzTiles + (size_t)vertTile * horzTiles + horzTile) * slotWords;
+    }
+
+    //k = 0 is the bottom left corner, w = 0 the top right one
+    int bottom(int plane, int vertTile, int horzTile, int k) const { return word(slot(plane, vertTile, horzTile) + k); }
+    int right(int plane, int vertTile, int horzTile, int w) const {
+        return word(slot(plane, vertTile, horzTile) + tileDimension + 1 + w);
+    }
+};
+
+//endJ / endI are SW_forward_linear's best[1] / best[2], aligned1 / aligned2 come out in order
+template <typename T, int Block>
+void hostTracebackCells(const TileEdges& edges, const ScoringScheme& scheme, const std::string& seq1, const std::string& seq2,
+                        int endJ, int endI, std::string& aligned1, std::string& aligned2) {
+    const int size1 = (int)seq1.length();
+    const int size2 = (int)seq2.length();
+
+    //padded like smithWatermanCells, the fixed length strips read past the ends
+    std::string seq1_pad = encodeSequence(scheme, seq1.data(), size1);
+    seq1_pad.append(Block, 0);
+    std::string seq2_rev = encodeSequence(scheme, seq2.data(), size2);
+    std::reverse(seq2_rev.begin(), seq2_rev.end());
+    seq2_rev.insert(0, 2 * Block, 0);
+    seq2_rev.append(Block, 0);
+
+    std::vector<T> blk(diagBlockCells(Block), 0);
+    std::vector<T> gap_blk(2 * diagBlockCells(Block), 0);
+    #ifdef AFFINE_GAP
+        const T* blkE = gap_blk.data();
+        const T* blkF = gap_blk.data() + diagBlockCells(Block);
+    #endif
+
+    std::string reversed1, reversed2;
+    int i = endI;
+    int j = endJ;
+    int currentTileVert = -1;
+    int currentTileHorz = -1;
+    #ifdef AFFINE_GAP
+        int gapState = 0;
+            //like align_pair, 0 = on the score, 1 = in a gap coming from the left (E), 2 = in a gap coming from above (F)
+    #endif
+
+    while (i > 0 && j > 0) {
+        int checkTileVert = (i - 1) / Block;
+        int checkTileHorz = (j - 1) / Block;
+        if (checkTileVert != currentTileVert || checkTileHorz != currentTileHorz) {
+            currentTileVert = checkTileVert;
+            currentTileHorz = checkTileHorz;
+            int v = currentTileVert;
+            int h = currentTileHorz;
+            int rows = std::min(Block, size1 - h * Block);
+            int cols = std::min(Block, size2 - v * Block);
+
+            //the halo is boundary_fill's: row 0 is the left tile's right side, column 0 the bottom of the tile above
+            blk[diag_index<Block>(0, 0)] = (h == 0 || v == 0) ? 0 : edges.bottom(0, v - 1, h, 0);
+            for (int c = 1; c <= cols; c++) {
+                blk[diag_index<Block>(0, c)] = (h == 0) ? 0 : edges.right(0, v, h - 1, c);
+            }
+            for (int r = 1; r <= rows; r++) {
+                blk[diag_index<Block>(r, 0)] = (v == 0) ? 0 : edges.bottom(0, v - 1, h, r);
+            }
+            #ifdef AFFINE_GAP
+                for (int c = 1; c <= cols; c++) {
+                    gap_blk[diagBlockCells(Block) + diag_index<Block>(0, c)] = (h == 0) ? 0 : edges.right(1, v, h - 1, c);
+                }
+                for (int r = 1; r <= rows; r++) {
+                    gap_blk[diag_index<Block>(r, 0)] = (v == 0) ? 0 : edges.bottom(1, v - 1, h, r);
+                }
+            #endif
+            process_block_diag<T, Block>(blk.data(), gap_blk.data(), rows, cols, scheme,
+                                         seq1_pad.data() + h * Block, seq2_rev.data(), 2 * Block + size2 - v * Block);
+        }
+
+        //(ti, tj) in the kernel's tile, so the score at it is block (tj, ti)
+        int ti = i - currentTileVert * Block;
+        int tj = j - currentTileHorz * Block;
+        int currValue = blk[diag_index<Block>(tj, ti)];
+        if (currValue == 0) {
+            break;
+        }
+        int diagValue = blk[diag_index<Block>(tj - 1, ti - 1)];
+        int leftValue = blk[diag_index<Block>(tj - 1, ti)];
+        int subScore = scheme.score(seq1[j - 1], seq2[i - 1]);
+
+        #ifdef AFFINE_GAP
+            int aboveValue = blk[diag_index<Block>(tj, ti - 1)];
+            int currE = blkF[diag_index<Block>(tj, ti)];
+            int currF = blkE[diag_index<Block>(tj, ti)];
+            if (gapState == 0) {
+                if (currValue == diagValue + subScore) {
+                    gapState = 3; //diagonal move, just for this step
+                } else if (currValue == currE) {
+                    gapState = 1;
+                } else {
+                    gapState = 2;
+                }
+            }
+
+            if (gapState == 3) {
+                reversed1 += seq1[j - 1];
+                reversed2 += seq2[i - 1];
+                gapState = 0;
+                i--;
+                j--;
+            } else if (gapState == 1) {
+                reversed1 += seq1[j - 1];
+                reversed2 += '-';
+                if (currE == leftValue + GAP_OPEN) {
+                    gapState = 0;
+                }
+                j--;
+            } else {
+                reversed1 += '-';
+                reversed2 += seq2[i - 1];
+                if (currF == aboveValue + GAP_OPEN) {
+                    gapState = 0;
+                }
+                i--;
+            }
+        #else
+            if (currValue == diagValue + subScore) {
+                reversed1 += seq1[j - 1];
+                reversed2 += seq2[i - 1];
+                i--;
+                j--;
+            } else if (currValue == leftValue + GAP_SCORE) {
+                reversed1 += seq1[j - 1];
+                reversed2 += '-';
+                j--;
+            } else {
+                reversed1 += '-';
+                reversed2 += seq2[i - 1];
+                i--;
+            }
+        #endif
+    }
+    aligned1.assign(reversed1.rbegin(), reversed1.rend());
+    aligned2.assign(reversed2.rbegin(), reversed2.rend());
+}
+
+//picks the block size (the kernel's tile size) and the narrowest cells the pair's scores fit in, like smithWaterman()
+inline void hostTraceback(const TileEdges& edges, const ScoringScheme& scheme, const std::string& seq1, const std::string& seq2,
+                          int endJ, int endI, std::string& aligned1, std::string& aligned2) {
+    withTileDim(edges.tileDimension, [&](auto tile) {
+        if (scoreFitsInt16(seq1.length(), seq2.length(), scheme.maxScore)) {
+            hostTracebackCells<int16_t, decltype(tile)::value>(edges, scheme, seq1, seq2, endJ, endI, aligned1, aligned2);
+        } else {
+            hostTracebackCells<int, decltype(tile)::value>(edges, scheme, seq1, seq2, endJ, endI, aligned1, aligned2);
+        }
+    });
+}
+
+//AlignQueue backend (align_queue.hpp) with the forward pass on the kernel and the backtrack on CPU threads
+//Session is an AlignerSession opened with FORWARD_ONLY, every slot's backtrack runs on a thread of its own,
+//so while it walks one pair the kernel is already on the pairs of the other slots
+//a slot is only handed back to the queue once its backtrack is done, so there have to be more slots than compute units
+//for the kernel to never wait on the CPU
+template <typename Session>
+class OffloadAlignBackend {
+public:
+    OffloadAlignBackend(Session& session, const ScoringScheme& scheme = defaultScheme())
+        : session(session), scheme(scheme), slotList(session.slots()) {}
+
+    int slots() const { return (int)slotList.size(); }
+
+    //false on top of the session's refusals if the kernel's AFFINE_GAP is not this build's, the recompute is this build's
+    bool submit(int slotIndex, const std::string& seq1, const std::string& seq2) {
+        Slot& slot = slotList[slotIndex];
+        bool kernelAffine = session.kernelConfig().has(KERNEL_FEATURE_AFFINE_GAP);
+        if (kernelAffine != ((buildFeatures() & KERNEL_FEATURE_AFFINE_GAP) != 0) || !session.submit(slotIndex, seq1, seq2)) {
+            return false;
+        }
+        slot.seq1 = seq1;
+        slot.seq2 = seq2;
+        slot.result = std::async(std::launch::async, [this, &slot, slotIndex]() {
+            int best[3];
+            if (!session.collectForward(slotIndex, best, slot.edges)) {
+                return false;
+            }
+            int tileDimension = session.tileSize();
+            TileEdges edges = {slot.edges.data(), session.kernelConfig().boundaryWordBytes(), tileDimension,
+                               ((int)slot.seq1.length() + tileDimension - 1) / tileDimension,
+                               ((int)slot.seq2.length() + tileDimension - 1) / tileDimension};
+            hostTraceback(edges, scheme, slot.seq1, slot.seq2, best[1], best[2], slot.aligned1, slot.aligned2);
+            return true;
+        });
+        return true;
+    }
+
+    bool collect(int slotIndex, std::string& aligned1, std::string& aligned2) {
+        Slot& slot = slotList[slotIndex];
+        bool ok = slot.result.get();
+        aligned1 = slot.aligned1;
+        aligned2 = slot.aligned2;
+        return ok;
+    }
+
+private:
+    struct Slot {
+        std::string seq1;
+        std::string seq2;
+        std::vector<char> edges;
+            //the tile edges read back from buffer, reused like the session's buffers
+        std::string aligned1;
+        std::string aligned2;
+        std::future<bool> result;
+    };
+
+    Session& session;
+    ScoringScheme scheme;
+    std::vector<Slot> slotList;
+};
+
+#endif
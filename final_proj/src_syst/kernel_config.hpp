@@ -0,0 +1,94 @@
+#ifndef KERNEL_CONFIG_HPP
+#define KERNEL_CONFIG_HPP
+
+#include <string>
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_kernel.h"
+#include "xrt/xrt_bo.h"
+#include "../defines.hpp"
+#include "../sw_algo.hpp"
+
+//what the loaded xclbin was built with, read back from SW_kernel_config instead of taken from this host's defines.hpp
+//the tile size, the score width and the boundary planes only size the host's tiles and buffers, so they come from here
+//and one host drives an xclbin of any tile size; PACKED_SEQ changes what the host writes, so that has to match (mismatch())
+struct KernelConfig {
+    int tileDimension;
+    int scoreBits;
+    int boundaryPlanes;
+    int features;
+        //KERNEL_FEATURE_ bits
+
+    //one run of SW_kernel_config on the loaded xclbin
+    static KernelConfig query(xrt::device& device, const xrt::uuid& uuid) {
+        xrt::kernel kernel(device, uuid, "SW_kernel_config");
+        xrt::bo config_bo(device, sizeof(int) * KERNEL_CONFIG_WORDS, kernel.group_id(0));
+        xrt::run run(kernel);
+        run.set_arg(0, config_bo);
+        run.start();
+        run.wait();
+
+        int config[KERNEL_CONFIG_WORDS];
+        config_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+        config_bo.read(config);
+        return {config[0], config[1], config[2], config[3]};
+    }
+
+    bool has(int feature) const { return (features & feature) != 0; }
+
+    //bytes of a word of the kernel's tile edges buffer, its boundary_t
+    int boundaryWordBytes() const {
+        return scoreBits <= 8 ? 1 : (scoreBits <= 16 ? 2 : 4);
+    }
+
+    //the kernel's TRACEBACK_BITS, 0 without TRACEBACK_POINTERS
+    int tracebackBits() const {
+        if (!has(KERNEL_FEATURE_TRACEBACK_POINTERS)) {
+            return 0;
+        }
+        return has(KERNEL_FEATURE_AFFINE_GAP) ? 4 : 2;
+    }
+
+    //bytes of SW_basic_linear's buffer for a pair of `tiles` tiles, alignBufferWords() for this kernel
+    size_t bufferBytes(size_t tiles) const {
+        return (size_t)boundaryWordBytes() * alignBufferWords(tiles, tileDimension, boundaryWordBytes() * 8, boundaryPlanes, tracebackBits());
+    }
+
+    //empty if this host can drive the kernel, what is wrong otherwise
+    std::string mismatch() const {
+        if (tileDimension <= 0 || boundaryPlanes <= 0) {
+            return "SW_kernel_config gave tile size " + std::to_string(tileDimension) + ", is the xclbin from this tree?";
+        }
+        if (has(KERNEL_FEATURE_PACKED_SEQ) != ((buildFeatures() & KERNEL_FEATURE_PACKED_SEQ) != 0)) {
+            return has(KERNEL_FEATURE_PACKED_SEQ) ? "the kernel takes PACKED_SEQ sequences, this host was built without it"
+                                                  : "this host was built with PACKED_SEQ, the kernel takes chars";
+        }
+        return "";
+    }
+
+    std::string describe() const {
+        std::string text = "tile " + std::to_string(tileDimension) + ", " + std::to_string(scoreBits) + " bit scores";
+        if (has(KERNEL_FEATURE_AFFINE_GAP)) {
+            text += ", AFFINE_GAP";
+        }
+        if (has(KERNEL_FEATURE_PACKED_SEQ)) {
+            text += ", PACKED_SEQ";
+        }
+        if (has(KERNEL_FEATURE_STRIP_SYSTOLIC)) {
+            text += ", STRIP_SYSTOLIC";
+        } else if (has(KERNEL_FEATURE_TILE_DATAFLOW)) {
+            text += ", TILE_DATAFLOW";
+        }
+        if (has(KERNEL_FEATURE_TRACEBACK_POINTERS)) {
+            text += ", TRACEBACK_POINTERS";
+        }
+        if (has(KERNEL_FEATURE_BANDED)) {
+            text += ", BANDED";
+        }
+        if (has(KERNEL_FEATURE_XDROP)) {
+            text += ", XDROP";
+        }
+        return text;
+    }
+};
+
+#endif
@@ -9,6 +9,9 @@
 #include "xrt/xrt_kernel.h"
 #include "xrt/xrt_bo.h"
 #include "../defines.hpp"
+#include "../scoring.hpp"
+#include "aligner_session.hpp"
+#include "../batch_arena.hpp"
 #include <chrono>
 #include <cmath>
 #include <numeric>    // For std::accumulate
@@ -76,146 +79,114 @@ void printUsage(const char* programName) {
     std::cout << "  -f <filename>       Specify input file (default: ../datasets/eval_dataset.txt)" << std::endl;
     std::cout << "  -x <directory>      Specify directory where build_dir.hw.xilinx_u250_gen3x16_xdma_4_1_202210_1/SW_syst.link.xclbin is located" << std::endl;
     std::cout << "  -b <num_runs>       Run benchmark with specified number of iterations (default: 1)" << std::endl;
-    std::cout << "  -s <tile_size>      Specify the tile dimension size (mandatory)" << std::endl;
+    std::cout << "  -s <tile_size>      Tile dimension the xclbin should have, read from the kernel if not given" << std::endl;
+    std::cout << "  -p                  Align every pair of the file in one SW_batch_linear launch, then one launch a pair, and compare" << std::endl;
     std::cout << "  -h                  Display this help message" << std::endl;
 }
 
 // Function to run a single execution and return the time
-double runSingleExecution(TestCase& testCase, xrt::device& myDevice, xrt::xclbin& xclbin, int tileDimension, bool printOutput = true) {
-    // Define input sequences from the selected test case
-    int seqsize[2] = {static_cast<int>(testCase.seq1.length()), 
-                      static_cast<int>(testCase.seq2.length())}; // Original sequence lengths
-    
-    // Calculate padded sizes and number of tiles
-    int inputsize1 = ceilToMultiple(seqsize[0], tileDimension) + 1;
-    int inputsize2 = ceilToMultiple(seqsize[1], tileDimension) + 1;
-    int numTilesVar[2] = {
-        numTiles(seqsize[0], tileDimension), // Number of horizontal tiles
-        numTiles(seqsize[1], tileDimension)  // Number of vertical tiles
-    };
-    
+// The session keeps the programmed device and the buffers, so a run is only the transfers and the kernel
+double runSingleExecution(TestCase& testCase, AlignerSession& session, int tileDimension, bool printOutput = true) {
     if (printOutput) {
-        std::cout << "Input sizes: " << inputsize1 << " || " << inputsize2 << std::endl;
-        std::cout << "Tile counts: " << numTilesVar[0] << " || " << numTilesVar[1] << std::endl;
+        std::cout << "Input sizes: " << ceilToMultiple(testCase.seq1.length(), tileDimension) + 1 << " || "
+                  << ceilToMultiple(testCase.seq2.length(), tileDimension) + 1 << std::endl;
+        std::cout << "Tile counts: " << numTiles(testCase.seq1.length(), tileDimension) << " || "
+                  << numTiles(testCase.seq2.length(), tileDimension) << std::endl;
+        std::cout << "Sequence 1: " << truncateString(testCase.seq1) << std::endl;
+        std::cout << "Sequence 2: " << truncateString(testCase.seq2) << std::endl;
     }
-    
-    // Allocate memory for sequences
-    char* seq1 = (char*)malloc(inputsize1 * sizeof(char));
-    char* seq2 = (char*)malloc(inputsize2 * sizeof(char));
-    
-    // Copy sequences from test case
-    strcpy(seq1, testCase.seq1.c_str());
-    strcpy(seq2, testCase.seq2.c_str());
-    
-    // Output buffers for aligned sequences
-    char* alignedSeq1 = (char*)malloc((seqsize[0]+seqsize[1]) * sizeof(char));
-    char* alignedSeq2 = (char*)malloc((seqsize[0]+seqsize[1]) * sizeof(char));
-    
-    // Pointer for score buffer - size needs to include the boundary cells
-    int buffer_horz_size = numTilesVar[0] * (tileDimension + 1)  * 2;
-    int buffer_vert_size = numTilesVar[1];
 
-    // Allocate buffer
-    int* buffer = (int*)malloc(sizeof(int) * buffer_horz_size * buffer_vert_size);
+    std::string alignedSeq1, alignedSeq2;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!session.align(testCase.seq1, testCase.seq2, alignedSeq1, alignedSeq2)) {
+        std::cerr << session.refusal(testCase.seq1, testCase.seq2) << std::endl;
+        return -1.0;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
 
-    // Print input with truncation
     if (printOutput) {
-        std::cout << "Sequence 1: " << truncateString(seq1) << std::endl;
-        std::cout << "Sequence 2: " << truncateString(seq2) << std::endl;
+        // Print results with truncation
+        std::cout << "Aligned 1 : " << truncateString(alignedSeq1) << std::endl;
+        std::cout << "Aligned 2 : " << truncateString(alignedSeq2) << std::endl;
     }
 
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Input Load Complete" << std::endl;
-    #endif
-
-    auto uuid = myDevice.load_xclbin(xclbin);
-
-    xrt::kernel SW_basic_linear(myDevice, uuid, "SW_basic_linear");
-
-    xrt::run RunObj = xrt::run(SW_basic_linear);
+    return duration.count(); // Return execution time
+}
 
-    // Make the buffers
-    auto seq1_bo = xrt::bo(myDevice, sizeof(char) * inputsize1, 
-                           SW_basic_linear.group_id(0));
-    auto seq2_bo = xrt::bo(myDevice, sizeof(char) * inputsize2, 
-                           SW_basic_linear.group_id(1));
-    auto buffer_bo = xrt::bo(myDevice, sizeof(int) * buffer_horz_size * buffer_vert_size, 
-                            xrt::bo::flags::device_only, SW_basic_linear.group_id(2));
-    auto seqsz_bo = xrt::bo(myDevice, sizeof(int) * 2, 
-                            SW_basic_linear.group_id(5));
-    auto tilenum_bo = xrt::bo(myDevice, sizeof(int) * 2, 
-                            SW_basic_linear.group_id(6));
-    auto align1_bo = xrt::bo(myDevice, sizeof(char) * (seqsize[0]+seqsize[1]), 
-                            SW_basic_linear.group_id(3));
-    auto align2_bo = xrt::bo(myDevice, sizeof(char) * (seqsize[0]+seqsize[1]), 
-                            SW_basic_linear.group_id(4));
+// Every pair of the file in one SW_batch_linear launch, then one SW_basic_linear launch a pair through the session
+// the batch pads to the kernel's tile size like the session does
+int runBatchComparison(std::vector<TestCase>& testCases, xrt::device& myDevice, AlignerSession& session) {
+    const KernelConfig& config = session.kernelConfig();
+    BatchArena batch(config.tileDimension, config.scoreBits, config.boundaryPlanes, config.tracebackBits());
+    for (const TestCase& testCase : testCases) {
+        if (!batch.add(testCase.seq1, testCase.seq2)) {
+            std::cerr << session.refusal(testCase.seq1, testCase.seq2) << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Batch of " << batch.pairs() << " pairs" << std::endl;
 
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Buffers Created " << std::endl;
-    #endif
+    xrt::kernel SW_batch_linear(myDevice, session.xclbinUuid(), "SW_batch_linear");
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
 
-    // Copy host data
     auto start = std::chrono::high_resolution_clock::now();
-    seq1_bo.write(seq1, sizeof(char) * inputsize1, 0);
-    seq2_bo.write(seq2, sizeof(char) * inputsize2, 0);
-    seqsz_bo.write(seqsize, sizeof(int) * 2, 0);
-    tilenum_bo.write(numTilesVar, sizeof(int) * 2, 0);
-    // DO NOT CALL WRITE OR SYNC FOR BUFFER
-    seq1_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-    seq2_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-    seqsz_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-    tilenum_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    auto arena_bo = xrt::bo(myDevice, std::max<size_t>(batch.arena.bytes(), 1), SW_batch_linear.group_id(0));
+    auto pairs_bo = xrt::bo(myDevice, sizeof(int) * batch.pairTable.size(), SW_batch_linear.group_id(1));
+    auto buffer_bo = xrt::bo(myDevice, config.boundaryWordBytes() * batch.bufferWords(), xrt::bo::flags::device_only, SW_batch_linear.group_id(3));
+    auto align1_bo = xrt::bo(myDevice, batch.outputBytes, SW_batch_linear.group_id(4));
+    auto align2_bo = xrt::bo(myDevice, batch.outputBytes, SW_batch_linear.group_id(5));
+    auto results_bo = xrt::bo(myDevice, sizeof(int) * BATCH_RESULT_WORDS * batch.pairs(), SW_batch_linear.group_id(6));
+    auto scoring_bo = xrt::bo(myDevice, sizeof(int) * SCORING_WORDS, SW_batch_linear.group_id(7));
 
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Buffers Written " << std::endl;
-    #endif
+    arena_bo.write(batch.arena.data(), batch.arena.bytes(), 0);
+    pairs_bo.write(batch.pairTable.data(), sizeof(int) * batch.pairTable.size(), 0);
+    scoring_bo.write(scoring, sizeof(int) * SCORING_WORDS, 0);
+    //DO NOT CALL WRITE OR SYNC FOR BUFFER
+    arena_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    pairs_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    scoring_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
 
-    // Run the kernel
-    RunObj.set_arg(0, seq1_bo);
-    RunObj.set_arg(1, seq2_bo);
-    RunObj.set_arg(2, buffer_bo);
-    RunObj.set_arg(3, seqsz_bo);
-    RunObj.set_arg(4, tilenum_bo);
-    RunObj.set_arg(5, align1_bo);
-    RunObj.set_arg(6, align2_bo);
+    xrt::run RunObj = xrt::run(SW_batch_linear);
+    RunObj.set_arg(0, arena_bo);
+    RunObj.set_arg(1, pairs_bo);
+    RunObj.set_arg(2, batch.pairs());
+    RunObj.set_arg(3, buffer_bo);
+    RunObj.set_arg(4, align1_bo);
+    RunObj.set_arg(5, align2_bo);
+    RunObj.set_arg(6, results_bo);
+    RunObj.set_arg(7, scoring_bo);
     RunObj.start();
     RunObj.wait();
 
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Execution Complete " << std::endl;
-    #endif    
-
-    // Read back the output
+    std::vector<char> alignedArena1(batch.outputBytes), alignedArena2(batch.outputBytes);
+    std::vector<int> resultTable(BATCH_RESULT_WORDS * batch.pairs());
     align1_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
     align2_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> duration = end - start;
-    
-    #ifdef DEBUG
-        if (printOutput) std::cout << "Execution Complete " << std::endl;
-    #endif  
-    
-    align1_bo.read(alignedSeq1);
-    align2_bo.read(alignedSeq2);
-
-    // Reverse the aligned sequences
-    std::reverse(alignedSeq1, alignedSeq1 + strlen(alignedSeq1));
-    std::reverse(alignedSeq2, alignedSeq2 + strlen(alignedSeq2));
+    results_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+    align1_bo.read(alignedArena1.data());
+    align2_bo.read(alignedArena2.data());
+    results_bo.read(resultTable.data());
+    std::chrono::duration<double> batchTime = std::chrono::high_resolution_clock::now() - start;
 
-    if (printOutput) {
-        // Print results with truncation
-        std::cout << "Aligned 1 : " << truncateString(alignedSeq1) << std::endl;
-        std::cout << "Aligned 2 : " << truncateString(alignedSeq2) << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+    int mismatches = 0;
+    for (int p = 0; p < batch.pairs(); p++) {
+        std::string aligned1, aligned2;
+        session.align(testCases[p].seq1, testCases[p].seq2, aligned1, aligned2);
+        if (aligned1 != BatchArena::aligned(alignedArena1, resultTable.data(), p) ||
+            aligned2 != BatchArena::aligned(alignedArena2, resultTable.data(), p)) {
+            std::cout << "Test case " << p << ": batch and single pair outputs differ" << std::endl;
+            mismatches++;
+        }
     }
+    std::chrono::duration<double> singleTime = std::chrono::high_resolution_clock::now() - start;
 
-    // Free memory
-    std::free(seq1);
-    std::free(seq2);
-    std::free(alignedSeq1);
-    std::free(alignedSeq2);
-    std::free(buffer);
-
-    return duration.count(); // Return execution time
+    std::cout << "Batch launch: " << batchTime.count() << " seconds" << std::endl;
+    std::cout << "One launch a pair: " << singleTime.count() << " seconds" << std::endl;
+    std::cout << (batch.pairs() - mismatches) << "/" << batch.pairs() << " pairs match" << std::endl;
+    return mismatches == 0 ? 0 : 1;
 }
 
 //#define DEBUG
@@ -225,7 +196,8 @@ int main(int argc, char* argv[]) {
     std::string testFilePath = "../datasets/eval_dataset.txt"; // Default path
     std::string xclbinDir = "."; // Default to current directory
     int benchmarkRuns = 1; // Default to running once
-    int tileDimension = -1; // Must be set by -s flag
+    int tileDimension = -1; // -s, checked against the kernel's
+    bool batchComparison = false; // -p aligns the whole file in one batch launch
     
     // FPGA-only implementation
     xrt::device myDevice; 
@@ -253,6 +225,8 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
             i++; // Skip the next argument since we've processed it
+        } else if (std::string(argv[i]) == "-p") {
+            batchComparison = true;
         } else if (std::string(argv[i]) == "-h") {
             printUsage(argv[0]);
             return 0;
@@ -262,15 +236,6 @@ int main(int argc, char* argv[]) {
         }
     }
     
-    // Check if tile dimension was specified
-    if (tileDimension == -1) {
-        std::cerr << "Error: Tile dimension (-s) is mandatory." << std::endl;
-        printUsage(argv[0]);
-        return 1;
-    }
-    
-    std::cout << "Using tile dimension: " << tileDimension << std::endl;
-    
     // Construct the full xclbin path by appending the required path to the specified directory
     std::string fullXclbinPath;
     // Add trailing slash to directory if not present
@@ -302,6 +267,26 @@ int main(int argc, char* argv[]) {
     // Get the selected test case
     TestCase selectedTest = testCases[testCaseIndex];
     std::cout << "Running test case " << testCaseIndex << std::endl;
+
+    // Program the device once, every run below reuses the kernel, run and buffers
+    AlignerSession session(myDevice, xclbin);
+    const KernelConfig& config = session.kernelConfig();
+    std::cout << "Kernel: " << config.describe() << std::endl;
+    if (!config.mismatch().empty()) {
+        std::cerr << config.mismatch() << std::endl;
+        return 1;
+    }
+    // The tile size is the xclbin's, -s only says which one this run expects
+    if (tileDimension != -1 && tileDimension != config.tileDimension) {
+        std::cerr << "Error: -s " << tileDimension << " but the xclbin was built with tile size " << config.tileDimension << std::endl;
+        return 1;
+    }
+    tileDimension = config.tileDimension;
+    std::cout << "Using tile dimension: " << tileDimension << std::endl;
+    
+    if (batchComparison) {
+        return runBatchComparison(testCases, myDevice, session);
+    }
     
     // If benchmarking mode is enabled
     if (benchmarkRuns > 1) {
@@ -313,7 +298,7 @@ int main(int argc, char* argv[]) {
         // Run the test multiple times
         for (int i = 0; i < benchmarkRuns; i++) {
             std::cout << "Run " << (i + 1) << "/" << benchmarkRuns << ": ";
-            double time = runSingleExecution(selectedTest, myDevice, xclbin, tileDimension, i == 0); // Only print output for the first run
+            double time = runSingleExecution(selectedTest, session, tileDimension, i == 0); // Only print output for the first run
             executionTimes.push_back(time);
             std::cout << "Time: " << time << " seconds" << std::endl;
             std::cout << "--------------------------------" << std::endl;
@@ -343,7 +328,7 @@ int main(int argc, char* argv[]) {
         std::cout << "  Standard deviation: " << stdDev << " seconds" << std::endl;
     } else {
         // Run a single execution
-        double time = runSingleExecution(selectedTest, myDevice, xclbin, tileDimension, true);
+        double time = runSingleExecution(selectedTest, session, tileDimension, true);
         std::cout << "Total time taken: " << time << " seconds" << std::endl;
     }
     
@@ -9,6 +9,12 @@
 #include "xrt/xrt_kernel.h"
 #include "xrt/xrt_bo.h"
 #include "../defines.hpp"
+#include "../scoring.hpp"
+#include "../packed_seq.hpp"
+#include "aligner_session.hpp"
+#include "align_queue.hpp"
+#include "cu_scheduler.hpp"
+#include "host_traceback.hpp"
 #include <chrono>
 #include <cmath>
 
@@ -83,12 +89,109 @@ std::vector<TestCase> loadTestCases(const std::string& filename = "../datasets/s
     return testCases;
 }
 
+// Every test case of the file through backend's queue, checked against its expected alignment
+template <typename Backend>
+int queueAllTestCases(const std::vector<TestCase>& testCases, Backend& backend, AlignerSession& session, int depth) {
+    int passed = 0;
+    AlignQueue<Backend> queue(backend,
+        [&](size_t id, bool ok, const std::string& aligned1, const std::string& aligned2) {
+            const TestCase& testCase = testCases[id];
+            if (!ok) {
+                std::cout << "Test case " << id << ": " << session.refusal(testCase.seq1, testCase.seq2) << std::endl;
+            } else if (aligned1 == testCase.expectedAligned1 && aligned2 == testCase.expectedAligned2) {
+                passed++;
+            } else {
+                std::cout << "Test case " << id << ": output does not match expected result" << std::endl;
+                std::cout << "  Aligned 1 : " << truncateString(aligned1) << std::endl;
+                std::cout << "  Aligned 2 : " << truncateString(aligned2) << std::endl;
+            }
+        }, depth);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const TestCase& testCase : testCases) {
+        queue.push(testCase.seq1, testCase.seq2);
+    }
+    queue.drain();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+
+    std::cout << passed << "/" << testCases.size() << " test cases passed, " << depth << " in flight" << std::endl;
+    std::cout << "Total time taken: " << duration.count() << " seconds" << std::endl;
+    return (passed == (int)testCases.size()) ? 0 : 1;
+}
+
+// Every test case of the file through the queue
+// depth pairs are in flight at once, each with its own run and buffers, so writing the next pair,
+// the kernel and checking the ones before it all overlap
+// with FORWARD_ONLY the kernel only does the forward pass and the backtracks run on CPU threads (host_traceback.hpp)
+// with ALIGN_CIGAR only the cigar runs come back from the kernel and the host expands them
+int runAllTestCases(const std::vector<TestCase>& testCases, xrt::device& myDevice, xrt::xclbin& xclbin,
+                    const ScoringScheme& scheme, int depth, AlignerSession::Mode mode) {
+    AlignerSession session(myDevice, xclbin, scheme, 1024, depth, mode);
+    if (!session.kernelConfig().mismatch().empty()) {
+        std::cerr << session.kernelConfig().mismatch() << std::endl;
+        return 1;
+    }
+    if (mode != AlignerSession::FORWARD_ONLY) {
+        return queueAllTestCases(testCases, session, session, depth);
+    }
+    if (session.kernelConfig().has(KERNEL_FEATURE_AFFINE_GAP) != ((buildFeatures() & KERNEL_FEATURE_AFFINE_GAP) != 0)) {
+        std::cerr << "-o recomputes the tiles with this host's AFFINE_GAP, build it with the xclbin's defines.hpp" << std::endl;
+        return 1;
+    }
+    OffloadAlignBackend<AlignerSession> offload(session, scheme);
+    return queueAllTestCases(testCases, offload, session, depth);
+}
+
+// Every test case of the file spread over the xclbin's compute units, longest first, see cu_scheduler.hpp
+// prints what each compute unit did
+int dispatchAllTestCases(const std::vector<TestCase>& testCases, xrt::device& myDevice, xrt::xclbin& xclbin,
+                         const ScoringScheme& scheme) {
+    AlignerSession session(myDevice, xclbin, scheme, 1024, 0);
+    if (!session.kernelConfig().mismatch().empty()) {
+        std::cerr << session.kernelConfig().mismatch() << std::endl;
+        return 1;
+    }
+    CuScheduler<AlignerSession> scheduler(session, session.tileSize());
+    std::vector<CuScheduler<AlignerSession>::Pair> pairs;
+    for (const TestCase& testCase : testCases) {
+        pairs.push_back({testCase.seq1, testCase.seq2});
+    }
+
+    int passed = 0;
+    scheduler.run(pairs, [&](size_t id, bool ok, const std::string& aligned1, const std::string& aligned2) {
+        const TestCase& testCase = testCases[id];
+        if (!ok) {
+            std::cout << "Test case " << id << ": " << session.refusal(testCase.seq1, testCase.seq2) << std::endl;
+        } else if (aligned1 == testCase.expectedAligned1 && aligned2 == testCase.expectedAligned2) {
+            passed++;
+        } else {
+            std::cout << "Test case " << id << ": output does not match expected result" << std::endl;
+        }
+    });
+
+    std::cout << passed << "/" << testCases.size() << " test cases passed on " << scheduler.computeUnits()
+              << " compute units" << std::endl;
+    for (int cu = 0; cu < scheduler.computeUnits(); cu++) {
+        std::cout << "  CU " << cu << ": " << scheduler.stats(cu).pairs << " pairs, " << scheduler.stats(cu).tiles
+                  << " tiles, busy " << scheduler.stats(cu).busySeconds << " s, utilization "
+                  << 100 * scheduler.utilization(cu) << "%" << std::endl;
+    }
+    std::cout << "Total time taken: " << scheduler.wallSeconds() << " seconds" << std::endl;
+    return (passed == (int)testCases.size()) ? 0 : 1;
+}
+
 //#define DEBUG
 int main(int argc, char* argv[]) {
     // Default test case index
     int testCaseIndex = 0;
     char mode = 'S'; // Default to SW emulation
     std::string testFilePath = "../datasets/sequence_test_cases.txt"; // Default path
+    bool scoreOnly = false; // -s runs SW_score_linear instead, no alignment
+    ScoringScheme scheme = matchMismatchScheme(); // -m picks another one, no new xclbin needed
+    bool allTestCases = false; // -a runs every test case of the file through the queue, or over every compute unit if there are more
+    int queueDepth = 2; // -q sets how many pairs of -a are in flight at once
+    AlignerSession::Mode sessionMode = AlignerSession::ALIGN_STRINGS; // -o makes -a do the backtracks on the host, -c bring back cigar runs
     
     //INPUTS
     //H = hw emu
@@ -101,9 +204,26 @@ int main(int argc, char* argv[]) {
     for (int i = 1; i < argc; i++) {
         if (std::string(argv[i]) == "-F" || std::string(argv[i]) == "-H" || std::string(argv[i]) == "-S") {
             mode = argv[i][1]; // Get the mode (F, H, or S)
+        } else if (std::string(argv[i]) == "-s") {
+            scoreOnly = true;
         } else if (std::string(argv[i]) == "-f" && i + 1 < argc) {
             testFilePath = argv[i + 1]; // Get the file path
             i++; // Skip the next argument since we've processed it
+        } else if (std::string(argv[i]) == "-a") {
+            allTestCases = true;
+        } else if (std::string(argv[i]) == "-o") {
+            sessionMode = AlignerSession::FORWARD_ONLY;
+        } else if (std::string(argv[i]) == "-c") {
+            sessionMode = AlignerSession::ALIGN_CIGAR;
+        } else if (std::string(argv[i]) == "-q" && i + 1 < argc) {
+            queueDepth = std::max(1, std::atoi(argv[i + 1]));
+            i++;
+        } else if (std::string(argv[i]) == "-m" && i + 1 < argc) {
+            // default, dna, blosum62 or a matrix file
+            if (!scoringSchemeByName(argv[i + 1], scheme)) {
+                return 1;
+            }
+            i++;
         } else {
             // Assume this is the test case index
             testCaseIndex = std::atoi(argv[i]);
@@ -136,6 +256,13 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (allTestCases && sessionMode == AlignerSession::ALIGN_STRINGS && AlignerSession::computeUnitNames(xclbin, "SW_basic_linear").size() > 1) {
+        return dispatchAllTestCases(testCases, myDevice, xclbin, scheme);
+    }
+    if (allTestCases) {
+        return runAllTestCases(testCases, myDevice, xclbin, scheme, queueDepth, sessionMode);
+    }
+    
     if (testCaseIndex < 0 || testCaseIndex >= static_cast<int>(testCases.size())) {
         std::cerr << "Invalid test case index. Valid range: 0-" << (testCases.size() - 1) << std::endl;
         return 1;
@@ -145,16 +272,26 @@ int main(int argc, char* argv[]) {
     TestCase selectedTest = testCases[testCaseIndex];
     std::cout << "Running test case " << testCaseIndex << std::endl;
 
+    // The tile size and score width are the xclbin's, whatever this host was built with
+    auto uuid = myDevice.load_xclbin(xclbin);
+    KernelConfig config = KernelConfig::query(myDevice, uuid);
+    std::cout << "Kernel: " << config.describe() << std::endl;
+    if (!config.mismatch().empty()) {
+        std::cerr << config.mismatch() << std::endl;
+        return 1;
+    }
+    int tileDimension = config.tileDimension;
+
     // Define input sequences from the selected test case
     int seqsize[2] = {static_cast<int>(selectedTest.seq1.length()), 
                       static_cast<int>(selectedTest.seq2.length())}; // Original sequence lengths
     
     // Calculate padded sizes and number of tiles
-    int inputsize1 = ceilToMultiple(seqsize[0], TILE_DIMENSION) + 1;
-    int inputsize2 = ceilToMultiple(seqsize[1], TILE_DIMENSION) + 1;
+    int inputsize1 = ceilToMultiple(seqsize[0], tileDimension) + 1;
+    int inputsize2 = ceilToMultiple(seqsize[1], tileDimension) + 1;
     int numTilesVar[2] = {
-        numTiles(seqsize[0], TILE_DIMENSION), // Number of horizontal tiles
-        numTiles(seqsize[1], TILE_DIMENSION)  // Number of vertical tiles
+        numTiles(seqsize[0], tileDimension), // Number of horizontal tiles
+        numTiles(seqsize[1], tileDimension)  // Number of vertical tiles
     };
     
     std::cout << "Input sizes: " << inputsize1 << " || " << inputsize2 << std::endl;
@@ -167,17 +304,90 @@ int main(int argc, char* argv[]) {
     // Copy sequences from test case
     strcpy(seq1, selectedTest.seq1.c_str());
     strcpy(seq2, selectedTest.seq2.c_str());
+
+    // What the kernel reads for the sequences, packed with PACKED_SEQ
+    KernelSeq seq1_in, seq2_in;
+    if (!kernelSequence(selectedTest.seq1, numTilesVar[0] * tileDimension, seq1_in) ||
+        !kernelSequence(selectedTest.seq2, numTilesVar[1] * tileDimension, seq2_in)) {
+        std::cerr << "PACKED_SEQ only takes A C G T N sequences" << std::endl;
+        return 1;
+    }
+    // The kernel's scores are SCORE_BITS wide, the pair's best possible score has to fit
+    int scoreBits = scoreBitsNeeded(scheme, selectedTest.seq1.length(), selectedTest.seq2.length());
+    std::cout << "Score bits: " << scoreBits << " needed, " << config.scoreBits << " in the kernel" << std::endl;
+    if (scoreBits > config.scoreBits) {
+        std::cerr << "Scores of this pair don't fit in SCORE_BITS" << std::endl;
+        return 1;
+    }
+
+    // Scoring scheme, packed the way the kernels read it
+    int scoring[SCORING_WORDS];
+    scheme.pack(scoring);
     
+    if (scoreOnly) {
+        // Score only: one boundary row plus a max per seq2 row (and the F row with AFFINE_GAP), no alignment buffers
+        int score_buffer_size = numTilesVar[0] * tileDimension + 1 + numTilesVar[1] * tileDimension +
+                                (config.boundaryPlanes - 1) * (numTilesVar[0] * tileDimension + 1);
+        int result[4];
+
+        xrt::kernel SW_score_linear(myDevice, uuid, "SW_score_linear");
+        xrt::run RunObj = xrt::run(SW_score_linear);
+
+        auto seq1_bo = xrt::bo(myDevice, seq1_in.bytes(), SW_score_linear.group_id(0));
+        auto seq2_bo = xrt::bo(myDevice, seq2_in.bytes(), SW_score_linear.group_id(1));
+        auto buffer_bo = xrt::bo(myDevice, config.boundaryWordBytes() * score_buffer_size,
+                                 xrt::bo::flags::device_only, SW_score_linear.group_id(2));
+        auto seqsz_bo = xrt::bo(myDevice, sizeof(int) * 2, SW_score_linear.group_id(3));
+        auto tilenum_bo = xrt::bo(myDevice, sizeof(int) * 2, SW_score_linear.group_id(4));
+        auto result_bo = xrt::bo(myDevice, sizeof(int) * 4, SW_score_linear.group_id(5));
+        auto scoring_bo = xrt::bo(myDevice, sizeof(int) * SCORING_WORDS, SW_score_linear.group_id(6));
+
+        auto start = std::chrono::high_resolution_clock::now();
+        seq1_bo.write(seq1_in.data(), seq1_in.bytes(), 0);
+        seq2_bo.write(seq2_in.data(), seq2_in.bytes(), 0);
+        seqsz_bo.write(seqsize, sizeof(int) * 2, 0);
+        tilenum_bo.write(numTilesVar, sizeof(int) * 2, 0);
+        scoring_bo.write(scoring, sizeof(int) * SCORING_WORDS, 0);
+        seq1_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+        seq2_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+        seqsz_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+        tilenum_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+        scoring_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+
+        RunObj.set_arg(0, seq1_bo);
+        RunObj.set_arg(1, seq2_bo);
+        RunObj.set_arg(2, buffer_bo);
+        RunObj.set_arg(3, seqsz_bo);
+        RunObj.set_arg(4, tilenum_bo);
+        RunObj.set_arg(5, result_bo);
+        RunObj.set_arg(6, scoring_bo);
+        RunObj.start();
+        RunObj.wait();
+
+        result_bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> duration = end - start;
+        result_bo.read(result);
+
+        std::cout << "Score     : " << result[0] << " ending at (" << result[1] << ", " << result[2] << ")" << std::endl;
+        std::cout << "Second    : " << result[3] << std::endl;
+
+        std::free(seq1);
+        std::free(seq2);
+        std::cout << "Total time taken: " << duration.count() << " seconds" << std::endl;
+        return 0;
+    }
+
     // Output buffers for aligned sequences
     char* alignedSeq1 = (char*)malloc((seqsize[0]+seqsize[1]) * sizeof(char));
     char* alignedSeq2 = (char*)malloc((seqsize[0]+seqsize[1]) * sizeof(char));
     
     // Pointer for score buffer - size needs to include the boundary cells
-    int buffer_horz_size = numTilesVar[0] * (TILE_DIMENSION + 1)  * 2;
-    int buffer_vert_size = numTilesVar[1];
+    size_t buffer_bytes = config.bufferBytes((size_t)numTilesVar[0] * numTilesVar[1]);
+        //with AFFINE_GAP the gap edges go after the score edges, with TRACEBACK_POINTERS the pointers after those
 
     //WE WANT TO REMOVE THESE MALLOCS LATER
-    int* buffer = (int*)malloc(sizeof(int) * buffer_horz_size * buffer_vert_size);
+    char* buffer = (char*)malloc(buffer_bytes);
 
     // Print input with truncation
     std::cout << "Sequence 1: " << truncateString(seq1) << std::endl;
@@ -187,24 +397,24 @@ int main(int argc, char* argv[]) {
         std::cout << "Input Load Complete" << std::endl;
     #endif
 
-    auto uuid = myDevice.load_xclbin(xclbin);
-
     xrt::kernel SW_basic_linear(myDevice, uuid, "SW_basic_linear");
 
     xrt::run RunObj = xrt::run(SW_basic_linear);
 
 
     //make the funny buffers
-    auto seq1_bo = xrt::bo(myDevice, sizeof(char) * inputsize1, 
+    auto seq1_bo = xrt::bo(myDevice, seq1_in.bytes(), 
                            SW_basic_linear.group_id(0));
-    auto seq2_bo = xrt::bo(myDevice, sizeof(char) * inputsize2, 
+    auto seq2_bo = xrt::bo(myDevice, seq2_in.bytes(), 
                            SW_basic_linear.group_id(1));
-    auto buffer_bo = xrt::bo(myDevice, sizeof(int) * buffer_horz_size * buffer_vert_size, 
+    auto buffer_bo = xrt::bo(myDevice, buffer_bytes, 
                             xrt::bo::flags::device_only, SW_basic_linear.group_id(2));
     auto seqsz_bo = xrt::bo(myDevice, sizeof(int) * 2, 
                             SW_basic_linear.group_id(5));
     auto tilenum_bo = xrt::bo(myDevice, sizeof(int) * 2, 
                             SW_basic_linear.group_id(6));
+    auto scoring_bo = xrt::bo(myDevice, sizeof(int) * SCORING_WORDS, 
+                            SW_basic_linear.group_id(7));
     auto align1_bo = xrt::bo(myDevice, sizeof(char) * (seqsize[0]+seqsize[1]), 
                             SW_basic_linear.group_id(3));
     auto align2_bo = xrt::bo(myDevice, sizeof(char) * (seqsize[0]+seqsize[1]), 
@@ -216,15 +426,17 @@ int main(int argc, char* argv[]) {
 
     //copy host data
     auto start = std::chrono::high_resolution_clock::now();
-    seq1_bo.write(seq1, sizeof(char) * inputsize1, 0);
-    seq2_bo.write(seq2, sizeof(char) * inputsize2, 0);
+    seq1_bo.write(seq1_in.data(), seq1_in.bytes(), 0);
+    seq2_bo.write(seq2_in.data(), seq2_in.bytes(), 0);
     seqsz_bo.write(seqsize, sizeof(int) * 2, 0);
     tilenum_bo.write(numTilesVar, sizeof(int) * 2, 0);
+    scoring_bo.write(scoring, sizeof(int) * SCORING_WORDS, 0);
     //DO NOT CALL WRITE OR SYNC FOR BUFFER
     seq1_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     seq2_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     seqsz_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
     tilenum_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    scoring_bo.sync(XCL_BO_SYNC_BO_TO_DEVICE);
 
     #ifdef DEBUG
         std::cout << "Buffers Written " << std::endl;
@@ -238,6 +450,7 @@ int main(int argc, char* argv[]) {
     RunObj.set_arg(4, tilenum_bo);
     RunObj.set_arg(5, align1_bo);
     RunObj.set_arg(6, align2_bo);
+    RunObj.set_arg(7, scoring_bo);
     RunObj.start();
     RunObj.wait();
 
@@ -1,33 +1,104 @@
 #include "../defines.hpp"
 #include "../sw_algo.hpp"
+#include "../traceback_ptr.hpp"
+#include "../band.hpp"
 #include <algorithm>
 #include <hls_stream.h>
 #include <ap_int.h>
 #include <iostream>
 #include <cstring>
 
+#if TILE_DIMENSION != 8 && TILE_DIMENSION != 16 && TILE_DIMENSION != 32 && TILE_DIMENSION != 64
+    #error "TILE_DIMENSION has to be 8, 16, 32 or 64, the sizes the hosts and the CPU baselines know"
+#endif
+
+//every score in the kernel, SCORE_BITS wide: the PEs, the streams between them and the tile arrays
+//the hosts only send a pair whose best possible score fits (scoreBitsNeeded in scoring.hpp), and no cell is ever above the best,
+//so nothing here can wrap
+typedef ap_int<SCORE_BITS> score_t;
+
+//std::max wants both sides the same type, and ap_int sums come out wider than their operands
+inline score_t score_max(score_t a, score_t b) {
+    return (a > b) ? a : b;
+}
+
+//the characters of one tile of a sequence
+//packed, the PACKED_TILE_WORDS words the tile is in are read in a row (one beat of the widened port) and the tile is unpacked from them
+void seq_tile_load(char tilebuffer[TILE_DIMENSION], seq_in_t* seq, int tile)
+{
+    int start = tile * TILE_DIMENSION;
+
+    #ifdef PACKED_SEQ
+        //same order as the 2 bit codes of packed_seq.hpp
+        const char letters[4] = {'A', 'C', 'G', 'T'};
+        unsigned int words[PACKED_TILE_WORDS];
+        #pragma HLS ARRAY_PARTITION variable=words complete
+        int first = start / PACKED_BLOCK_BASES * PACKED_BLOCK_WORDS;
+        word_load_loop: for (int w = 0; w < PACKED_TILE_WORDS; w++) {
+            #pragma HLS PIPELINE II=1
+            words[w] = seq[first + w];
+        }
+
+        int offset = start % PACKED_BLOCK_BASES;
+        unpack_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+            #pragma HLS UNROLL
+            int k = offset + i;
+            int block = k / PACKED_BLOCK_BASES * PACKED_BLOCK_WORDS;
+            int b = k % PACKED_BLOCK_BASES;
+            bool isN = (words[block + PACKED_BLOCK_WORDS - 1] >> b) & 1;
+            unsigned int code = (words[block + b / PACKED_BASES_PER_WORD] >> (2 * (b % PACKED_BASES_PER_WORD))) & 3;
+            tilebuffer[i] = isN ? 'N' : letters[code];
+        }
+    #else
+        charbuffer_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+            #pragma HLS UNROLL // factor=8
+            tilebuffer[i] = seq[i + start];
+        }
+    #endif
+}
+
+//the characters are kept for the output strings, the PEs only see the codes of seq1
 void seq_buffer_load(char seq1_tilebuffer[TILE_DIMENSION], char seq2_tilebuffer[TILE_DIMENSION], 
-                     char* seq1, char* seq2, int seq1_tile, int seq2_tile) 
+                     unsigned char seq1_codebuffer[TILE_DIMENSION], const unsigned char codeTable[256],
+                     seq_in_t* seq1, seq_in_t* seq2, int seq1_tile, int seq2_tile) 
 {
-    int seq1_start = seq1_tile * TILE_DIMENSION;
-    int seq2_start = seq2_tile * TILE_DIMENSION;
-    
-    charbuffer_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
-        #pragma HLS UNROLL // factor=8
-        seq1_tilebuffer[i] = seq1[i+seq1_start];
-        seq2_tilebuffer[i] = seq2[i+seq2_start];
+    seq_tile_load(seq1_tilebuffer, seq1, seq1_tile);
+    seq_tile_load(seq2_tilebuffer, seq2, seq2_tile);
+
+    code_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+        #pragma HLS UNROLL
+        seq1_codebuffer[i] = codeTable[(unsigned char)seq1_tilebuffer[i]];
     } 
 }
 
-void boundary_fill(int score[TILE_DIMENSION+1][TILE_DIMENSION+1], int horz_tile_num, int vert_tile_num, 
-                   volatile int* buffer, int buffer_horz_size, int leftSideBoundaryBuffer[TILE_DIMENSION+1]) 
+//query profile of a tile row: tileProfile[r][c] is the score of code c (from seq1) against row r of the seq2 tile
+//every PE gets its own row, so the match score is one lookup with the seq1 code instead of a compare
+//only depends on the seq2 tile, so it is built once per tile row (and when the backtrack changes tile row)
+void profile_load(score_t tileProfile[TILE_DIMENSION][SCORE_ALPHABET], score_t subMatrix[SCORE_ALPHABET][SCORE_ALPHABET],
+                  const unsigned char codeTable[256], seq_in_t* seq2, int seq2_tile)
+{
+    char seq2_tile_chars[TILE_DIMENSION];
+    #pragma HLS ARRAY_PARTITION variable=seq2_tile_chars complete
+    seq_tile_load(seq2_tile_chars, seq2, seq2_tile);
+
+    profile_row_loop: for (int r = 0; r < TILE_DIMENSION; r++) {
+        unsigned char seq2Code = codeTable[(unsigned char)seq2_tile_chars[r]];
+        profile_col_loop: for (int c = 0; c < SCORE_ALPHABET; c++) {
+            #pragma HLS PIPELINE II=1
+            tileProfile[r][c] = subMatrix[c][seq2Code];
+        }
+    }
+}
+
+void boundary_fill(score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1], int horz_tile_num, int vert_tile_num, 
+                   volatile boundary_t* buffer, int buffer_horz_size, score_t leftSideBoundaryBuffer[TILE_DIMENSION+1]) 
 {
     //left side boundary buffer holds TILE_DIM + 1 of the left tile
 
     //each buffer location stores your bottom and rtght sides
     //bottom is stored first, then right
-    volatile int* precalBufferPoint = &buffer[(vert_tile_num - 1) * buffer_horz_size +   //look at the bottom boundary of guy abive you
-                              horz_tile_num * TILE_DIM_TIMES_2];
+    volatile boundary_t* precalBufferPoint = &buffer[(vert_tile_num - 1) * buffer_horz_size +   //look at the bottom boundary of guy abive you
+                              horz_tile_num * TILE_BOUNDARY_SLOT];
 
     if (horz_tile_num == 0 || vert_tile_num == 0) {
         score[0][0] = 0;
@@ -57,135 +128,359 @@ void boundary_fill(int score[TILE_DIMENSION+1][TILE_DIMENSION+1], int horz_tile_
     }
 } 
 
-void score_buffer_store(int score[TILE_DIMENSION+1][TILE_DIMENSION+1], int horz_tile_num, int vert_tile_num, 
-                        volatile int* buffer, int buffer_horz_size, int leftSideBoundaryBuffer[TILE_DIMENSION]) 
+void score_buffer_store(score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1], int horz_tile_num, int vert_tile_num, 
+                        volatile boundary_t* buffer, int buffer_horz_size, score_t leftSideBoundaryBuffer[TILE_DIMENSION]) 
 {
-    memcpy((void*)&buffer[(vert_tile_num) * buffer_horz_size + 
-                           horz_tile_num * TILE_DIM_TIMES_2],
-                           score[TILE_DIMENSION], 
-                           (TILE_DIMENSION + 1)  * sizeof(int));
-        //stores the bottom
+    store_bottom_loop: for (int i = 0; i <= TILE_DIMENSION; i++) {
+        #pragma HLS PIPELINE II=1
+        buffer[(vert_tile_num) * buffer_horz_size + horz_tile_num * TILE_BOUNDARY_SLOT + i] = score[TILE_DIMENSION][i];
+    }
+        //stores the bottom, a loop since score_t and the buffer words are not the same width
     store_loop_outer: for (int i = 0; i <= TILE_DIMENSION; i++) {
         leftSideBoundaryBuffer[i] = score[i][TILE_DIMENSION]; 
             //leftside buffer
         buffer[vert_tile_num * buffer_horz_size +
-                horz_tile_num * TILE_DIM_TIMES_2 + TILE_DIMENSION + 1 + i] = score[i][TILE_DIMENSION];
+                horz_tile_num * TILE_BOUNDARY_SLOT + TILE_DIMENSION + 1 + i] = score[i][TILE_DIMENSION];
                 //right size storage
     }
 }  
 
+//score only versions of boundary_fill / score_buffer_store
+//there is one boundary row instead of the tile edges buffer: boundaryRow[j] is the bottom of the tile row above at column j
+//the corner above the left column is taken from the left tile, since the left tile has already overwritten it in the row
+//Row is the row in buffer (volatile boundary_t*) or the on chip line (score_t*, ONCHIP_BOUNDARY_LEN)
+template <typename Row>
+void boundary_fill_row(score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1], int horz_tile_num, int vert_tile_num,
+                       Row boundaryRow, score_t leftSideBoundaryBuffer[TILE_DIMENSION+1])
+{
+    if (horz_tile_num == 0) {
+        score[0][0] = 0;
+    } else {
+        score[0][0] = leftSideBoundaryBuffer[0];
+    }
+
+    boundary_fill_row_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+        #pragma HLS UNROLL
+        if (horz_tile_num == 0) {
+            score[i][0] = 0;
+        } else {
+            score[i][0] = leftSideBoundaryBuffer[i];
+        }
+
+        if (vert_tile_num == 0) {
+            score[0][i] = 0;
+        } else {
+            score[0][i] = boundaryRow[horz_tile_num * TILE_DIMENSION + i];
+        }
+    }
+}
+
+template <typename Row>
+void score_row_store(score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1], int horz_tile_num,
+                     Row boundaryRow, score_t leftSideBoundaryBuffer[TILE_DIMENSION+1])
+{
+    row_store_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+        boundaryRow[horz_tile_num * TILE_DIMENSION + i] = score[TILE_DIMENSION][i];
+            //bottom
+    }
+    left_store_loop: for (int i = 0; i <= TILE_DIMENSION; i++) {
+        #pragma HLS UNROLL
+        leftSideBoundaryBuffer[i] = score[i][TILE_DIMENSION];
+            //right side, with the corner above it
+    }
+}
+
+#ifdef AFFINE_GAP
+//the gap scores go next to the score edges:
+//  gapBuffer is laid out like buffer, with F in place of the bottom row and E in place of the right column
+//  leftSideGapBuffer holds E of the right column of the left tile
+//only F is needed on the top edge and E on the left edge, the corner is never read
+void gap_boundary_fill(score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1], score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1],
+                       int horz_tile_num, int vert_tile_num, volatile boundary_t* gapBuffer, int buffer_horz_size,
+                       score_t leftSideGapBuffer[TILE_DIMENSION+1])
+{
+    volatile boundary_t* precalGapPoint = &gapBuffer[(vert_tile_num - 1) * buffer_horz_size + horz_tile_num * TILE_BOUNDARY_SLOT];
+
+    gap_boundary_fill_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+        #pragma HLS UNROLL
+        if (horz_tile_num == 0) {
+            gapE[i][0] = 0;
+        } else {
+            gapE[i][0] = leftSideGapBuffer[i];
+        }
+
+        if (vert_tile_num == 0) {
+            gapF[0][i] = 0;
+        } else {
+            gapF[0][i] = precalGapPoint[i];
+        }
+    }
+}
+
+void gap_buffer_store(score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1], score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1],
+                      int horz_tile_num, int vert_tile_num, volatile boundary_t* gapBuffer, int buffer_horz_size,
+                      score_t leftSideGapBuffer[TILE_DIMENSION+1])
+{
+    gap_store_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+        gapBuffer[vert_tile_num * buffer_horz_size + horz_tile_num * TILE_BOUNDARY_SLOT + i] = gapF[TILE_DIMENSION][i];
+            //bottom F
+        leftSideGapBuffer[i] = gapE[i][TILE_DIMENSION];
+        gapBuffer[vert_tile_num * buffer_horz_size +
+                  horz_tile_num * TILE_BOUNDARY_SLOT + TILE_DIMENSION + 1 + i] = gapE[i][TILE_DIMENSION];
+            //right E
+    }
+}
+
+//score only versions, gapRow is the F row under the tile row above
+template <typename Row>
+void gap_boundary_fill_row(score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1], score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1],
+                           int horz_tile_num, int vert_tile_num, Row gapRow, score_t leftSideGapBuffer[TILE_DIMENSION+1])
+{
+    gap_boundary_fill_row_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+        #pragma HLS UNROLL
+        if (horz_tile_num == 0) {
+            gapE[i][0] = 0;
+        } else {
+            gapE[i][0] = leftSideGapBuffer[i];
+        }
+
+        if (vert_tile_num == 0) {
+            gapF[0][i] = 0;
+        } else {
+            gapF[0][i] = gapRow[horz_tile_num * TILE_DIMENSION + i];
+        }
+    }
+}
+
+template <typename Row>
+void gap_row_store(score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1], score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1],
+                   int horz_tile_num, Row gapRow, score_t leftSideGapBuffer[TILE_DIMENSION+1])
+{
+    gap_row_store_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+        gapRow[horz_tile_num * TILE_DIMENSION + i] = gapF[TILE_DIMENSION][i];
+        leftSideGapBuffer[i] = gapE[i][TILE_DIMENSION];
+    }
+}
+#endif
+
 void shift_right(char* array, int seqsize) {
     // Shift elements from end to start, discarding the last one
     memmove(&array[1], &array[0], seqsize * sizeof(char));
     array[0] = 0;
 }
 
+#ifdef TRACEBACK_POINTERS
+//the pointer of a cell (traceback_ptr.hpp), the same compares the backtrack makes: diag, then left (E), then up (F), 0 stops
+//with AFFINE_GAP, left / above are the scores the gaps open from, a gap that opens here gets its TRACE_ bit
+inline int trace_pointer(score_t myScore, score_t diagScore, score_t leftScore
+#ifdef AFFINE_GAP
+                         , score_t left, score_t above, score_t aboveScore
+#endif
+                         )
+{
+    int trace = TRACE_STOP;
+    if (myScore != 0) {
+        trace = (myScore == diagScore) ? TRACE_DIAG : ((myScore == leftScore) ? TRACE_LEFT : TRACE_UP);
+    }
+    #ifdef AFFINE_GAP
+        if (leftScore == left + GAP_OPEN) {
+            trace |= TRACE_E_OPEN;
+        }
+        if (aboveScore == above + GAP_OPEN) {
+            trace |= TRACE_F_OPEN;
+        }
+    #endif
+    return trace;
+}
+
+//cell col of a row into the word it goes in, a new word starts every TRACEBACK_CELLS_PER_WORD cells
+inline unsigned int trace_pack(unsigned int word, int col, int trace)
+{
+    int slot = col % TRACEBACK_CELLS_PER_WORD;
+    return (slot == 0 ? 0u : word) | ((unsigned int)trace << (slot * TRACEBACK_BITS));
+}
+#endif
+
+//with AFFINE_GAP, F comes down from the PE above next to the score, and E stays in a register going across the row
+//gapRowE / gapRowF get this row's E and F for the tile edges and the backtrack
 void PE(int vert_tile_num, int horz_tile_num, int rowID, //where am i
-    hls::stream<int> &aboveSideIn, hls::stream<int> &downOut, //who do i talk to 
-    int rowHead[TILE_DIMENSION+1], char* seq1, char seq2Char, //where is the data
+    hls::stream<score_t> &aboveSideIn, hls::stream<score_t> &downOut, //who do i talk to 
+    score_t rowHead[TILE_DIMENSION+1], unsigned char* seq1Code, const score_t profileRow[SCORE_ALPHABET], //where is the data
     const int seqsize1, const int seqsize2, //how big is stuff
-    int maxArrBuffer[2], int firstColDiag, int firstColLeft) //extras
+    int maxArrBuffer[2], score_t firstColDiag, score_t firstColLeft //extras
+#ifdef AFFINE_GAP
+    , hls::stream<score_t> &aboveGapIn, hls::stream<score_t> &downGapOut,
+    score_t gapRowE[TILE_DIMENSION+1], score_t gapRowF[TILE_DIMENSION+1], score_t firstColGap
+#endif
+#ifdef TRACEBACK_POINTERS
+    , unsigned int traceRow[TRACEBACK_ROW_WORDS]
+#endif
+    )
 {
     //#pragma HLS INLINE
     
     int maxind;
         //it needs to write to maxind, but not read
-    int max = 0;
+    score_t max = 0;
         //but it does need to know the previous max
 
-    int left = firstColLeft; //take from score
-    int diag = firstColDiag;
+    score_t left = firstColLeft; //take from score
+    score_t diag = firstColDiag;
+    #ifdef AFFINE_GAP
+        score_t leftGap = firstColGap; //E of the left cell
+    #endif
+
+    bool rowValid = rowID + vert_tile_num * TILE_DIMENSION <= seqsize2;
+    #ifdef TRACEBACK_POINTERS
+        unsigned int traceWord = 0;
+    #endif
 
+    //II=1: the only thing one cell needs from the cell before it in the same cycle is left (and E),
+    //so everything that comes from above or from diag is worked out first and the left chain is one add and one compare
+    //max / maxind are a chain of their own, a 0 never beats max so they don't need to know if the cell is valid
     main_PE_inner_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
-        #pragma HLS PIPELINE II=3
+        #pragma HLS PIPELINE II=1
 
-        int above = aboveSideIn.read();
+        score_t above = aboveSideIn.read();
+        #ifdef AFFINE_GAP
+            score_t aboveGap = aboveGapIn.read();
+        #endif
         //if we are within seq2 and seq1
-        if ((rowID + vert_tile_num * TILE_DIMENSION <= seqsize2) && (i + horz_tile_num * TILE_DIMENSION <= seqsize1)) {
-            
-            int matchScore = (seq2Char == seq1[i-1]) ? MATCH_SCORE : MISMATCH_SCORE;
-                //get data
+        bool valid = rowValid && (i + horz_tile_num * TILE_DIMENSION <= seqsize1);
 
-            int diagScore = diag + matchScore;
-            int aboveScore = above + GAP_SCORE;
-            int leftScore = left + GAP_SCORE;
+        score_t diagScore = diag + profileRow[seq1Code[i-1]];
+            //get data, the profile row is this PE's seq2 character against every code
+        #ifdef AFFINE_GAP
+            //Gotoh, both gaps either open from the score or extend, clamped at 0 like the score
+            score_t aboveScore = score_max(0, score_max(above + GAP_OPEN, aboveGap + GAP_EXTEND));
+            score_t upScore = score_max(diagScore, aboveScore);
+            score_t leftScore = score_max(0, score_max(left + GAP_OPEN, leftGap + GAP_EXTEND));
+        #else
+            score_t upScore = score_max(0, score_max(diagScore, above + GAP_SCORE));
+            score_t leftScore = left + GAP_SCORE;
+        #endif
+        score_t myScore = valid ? score_max(upScore, leftScore) : score_t(0);
+            //upScore is already >= 0
 
-            int gapScore = std::max(aboveScore, leftScore);
-            int myScore = std::max(0, std::max(diagScore, gapScore));
-            //do score calc
-            downOut.write(myScore);
+        downOut.write(myScore);
+        #ifdef AFFINE_GAP
+            downGapOut.write(valid ? aboveScore : score_t(0));
+            leftGap = valid ? leftScore : score_t(0);
+        #endif
+        if (valid) {
+            //why write if invalid location
             rowHead[i] = myScore;
-            //write to row
-
-            left = myScore;
-            diag = above;
-            //update internal scratchpad            
-
-            if (myScore > max) {
-                max = myScore;
-                maxind = horz_tile_num * TILE_DIMENSION + i;
+            #ifdef AFFINE_GAP
+                gapRowF[i] = aboveScore;
+                gapRowE[i] = leftScore;
+            #endif
+        }
+        #ifdef TRACEBACK_POINTERS
+            //the move the backtrack takes out of this cell, packed into the row's words as the cells go by
+            traceWord = trace_pack(traceWord, i - 1, trace_pointer(myScore, diagScore, leftScore
+            #ifdef AFFINE_GAP
+                , left, above, aboveScore
+            #endif
+                ));
+            if ((i - 1) % TRACEBACK_CELLS_PER_WORD == TRACEBACK_CELLS_PER_WORD - 1 || i == TILE_DIMENSION) {
+                traceRow[(i - 1) / TRACEBACK_CELLS_PER_WORD] = traceWord;
             }
+        #endif
 
-        } else {
-            //rowHead[i] = 0;
-                //why write if invalid location
-            downOut.write(0);
+        left = myScore;
+        diag = above;
+            //past the end of seq1 every cell after this one is invalid too, so a 0 here changes nothing
+
+        if (myScore > max) {
+            max = myScore;
+            maxind = horz_tile_num * TILE_DIMENSION + i;
         }
     }
     maxArrBuffer[0] = maxind;
     maxArrBuffer[1] = max;
 }
 
-void PE_start(int rowHead[TILE_DIMENSION+1], hls::stream<int> &downOut) {
+void PE_start(score_t rowHead[TILE_DIMENSION+1], hls::stream<score_t> &downOut) {
     #pragma HLS inline off
     //#pragma HLS INLINE
     PE_start_inner_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
-        #pragma HLS PIPELINE II=3
+        #pragma HLS PIPELINE II=1
         downOut.write(rowHead[i]);
     }
 }
 
-void PE_end(hls::stream<int> &aboveSideIn) {
+void PE_end(hls::stream<score_t> &aboveSideIn) {
     #pragma HLS INLINE off
     PE_end_inner_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
-        #pragma HLS PIPELINE II=3
+        #pragma HLS PIPELINE II=1
         aboveSideIn.read();
     }
 }
 
-void systolic_loop(int score[TILE_DIMENSION+1][TILE_DIMENSION+1], char* seq1_buffer, char* seq2_buffer, const int seqsize1_buffer, const int seqsize2_buffer, 
-                   int maxArrBuffer[TILE_DIMENSION][2], int vert_tile_num, int horz_tile_num, int firstColDiag[TILE_DIMENSION], int firstColLeft[TILE_DIMENSION]) 
+void systolic_loop(score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1], unsigned char* seq1_codebuffer, score_t tileProfile[TILE_DIMENSION][SCORE_ALPHABET],
+                   const int seqsize1_buffer, const int seqsize2_buffer, 
+                   int maxArrBuffer[TILE_DIMENSION][2], int vert_tile_num, int horz_tile_num, score_t firstColDiag[TILE_DIMENSION], score_t firstColLeft[TILE_DIMENSION]
+#ifdef AFFINE_GAP
+                   , score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1], score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1], score_t firstColGap[TILE_DIMENSION]
+#endif
+#ifdef TRACEBACK_POINTERS
+                   , unsigned int traceTile[TILE_DIMENSION][TRACEBACK_ROW_WORDS]
+#endif
+                   ) 
 {
     #pragma HLS INLINE off
     #pragma HLS DATAFLOW //disable_start_propagation
-    hls::stream<int> streams[TILE_DIMENSION+1];
+    hls::stream<score_t> streams[TILE_DIMENSION+1];
     #pragma HLS STREAM variable=streams depth=3 type=fifo
     #pragma HLS ARRAY_PARTITION variable=streams type=complete
+    #ifdef AFFINE_GAP
+        //F goes down its own chain of streams, in step with the scores
+        hls::stream<score_t> gapStreams[TILE_DIMENSION+1];
+        #pragma HLS STREAM variable=gapStreams depth=3 type=fifo
+        #pragma HLS ARRAY_PARTITION variable=gapStreams type=complete
+    #endif
     
     PE_start(score[0], streams[0]);
+    #ifdef AFFINE_GAP
+        PE_start(gapF[0], gapStreams[0]);
+    #endif
     //if i put this in its own function it fuckin crashes
     systolic_inner_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
         #pragma HLS UNROLL
         PE( vert_tile_num, horz_tile_num, i, 
             streams[i-1], streams[i],
-            score[i], seq1_buffer, seq2_buffer[i-1],
+            score[i], seq1_codebuffer, tileProfile[i-1],
                 //this passes the correct row head pointer
             seqsize1_buffer, seqsize2_buffer,
-            maxArrBuffer[i-1], firstColDiag[i-1], firstColLeft[i-1]); 
+            maxArrBuffer[i-1], firstColDiag[i-1], firstColLeft[i-1]
+        #ifdef AFFINE_GAP
+            , gapStreams[i-1], gapStreams[i], gapE[i], gapF[i], firstColGap[i-1]
+        #endif
+        #ifdef TRACEBACK_POINTERS
+            , traceTile[i-1]
+        #endif
+            ); 
     }
     PE_end(streams[TILE_DIMENSION]);
+    #ifdef AFFINE_GAP
+        PE_end(gapStreams[TILE_DIMENSION]);
+    #endif
 }
 
-//this function handles loading and calculating the file, NOT STORING, and NOT UPDATING MAX VALUE
-void process_tile(char* seq1, char* seq2, int score[TILE_DIMENSION+1][TILE_DIMENSION+1], const int seqsize[2], volatile int* buffer,
-                  int buffer_horz_size, int leftSideBoundaryBuffer[TILE_DIMENSION+1], int horz_tile_num, int vert_tile_num,
-                  int maxArrBuffer[TILE_DIMENSION][2], char seq1_tilebuffer[TILE_DIMENSION], char seq2_tilebuffer[TILE_DIMENSION]) 
+//runs the systolic array over a tile, score[0][*] and score[*][0] have to be filled already
+//with AFFINE_GAP so do gapF[0][*] and gapE[*][0]
+void compute_tile(score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1], const int seqsize[2], int horz_tile_num, int vert_tile_num,
+                  int maxArrBuffer[TILE_DIMENSION][2], unsigned char seq1_codebuffer[TILE_DIMENSION],
+                  score_t tileProfile[TILE_DIMENSION][SCORE_ALPHABET]
+#ifdef AFFINE_GAP
+                  , score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1], score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1]
+#endif
+#ifdef TRACEBACK_POINTERS
+                  , unsigned int traceTile[TILE_DIMENSION][TRACEBACK_ROW_WORDS]
+#endif
+                  )
 {
     #pragma HLS INLINE off
-    //load the sequence data
-    seq_buffer_load(seq1_tilebuffer, seq2_tilebuffer, seq1, seq2, horz_tile_num, vert_tile_num);
-    boundary_fill(score, horz_tile_num, vert_tile_num, buffer, buffer_horz_size, leftSideBoundaryBuffer);
-
     const int seqsize1_buffer = seqsize[0];
     const int seqsize2_buffer = seqsize[1];
         //have to rebuffer due to dataflow issues
@@ -193,15 +488,9 @@ void process_tile(char* seq1, char* seq2, int score[TILE_DIMENSION+1][TILE_DIMEN
     #ifdef DEBUG_SCORE
         std::cout << std::endl;
         std::cout << std::endl;
-        std::cout << "seq1_tilebuffer: ";
-        for (int i = 0; i < TILE_DIMENSION && seq1_tilebuffer[i] != '\0'; ++i) {
-            std::cout << seq1_tilebuffer[i];
-        }
-        std::cout << std::endl;
-
-        std::cout << "seq2_tilebuffer: ";
-        for (int i = 0; i < TILE_DIMENSION && seq2_tilebuffer[i] != '\0'; ++i) {
-            std::cout << seq2_tilebuffer[i];
+        std::cout << "seq1_codebuffer: ";
+        for (int i = 0; i < TILE_DIMENSION; ++i) {
+            std::cout << (int)seq1_codebuffer[i] << " ";
         }
         std::cout << std::endl;
     #endif
@@ -209,8 +498,8 @@ void process_tile(char* seq1, char* seq2, int score[TILE_DIMENSION+1][TILE_DIMEN
     //since each PE needs the initial diagonal, they need to access the first index of the row above them.
     //but this messes up the dataflow pragma, since it enters the other guy's space.
     //so copy the first column of score into a buffer, EXCEPT for the upper left corner
-    int firstColDiag[TILE_DIMENSION];
-    int firstColLeft[TILE_DIMENSION];
+    score_t firstColDiag[TILE_DIMENSION];
+    score_t firstColLeft[TILE_DIMENSION];
     #pragma HLS ARRAY_PARTITION variable=firstColDiag complete
     #pragma HLS ARRAY_PARTITION variable=firstColLeft complete
         //needed to avoid dataflow error
@@ -220,11 +509,688 @@ void process_tile(char* seq1, char* seq2, int score[TILE_DIMENSION+1][TILE_DIMEN
         firstColLeft[i] = score[i+1][0];
     }
 
-    systolic_loop(score, seq1_tilebuffer, seq2_tilebuffer, seqsize1_buffer, seqsize2_buffer,
-                  maxArrBuffer, vert_tile_num, horz_tile_num, firstColDiag, firstColLeft);
+    #ifdef AFFINE_GAP
+        score_t firstColGap[TILE_DIMENSION];
+        #pragma HLS ARRAY_PARTITION variable=firstColGap complete
+        first_col_gap_load: for (int i = 0; i < TILE_DIMENSION; i++) {
+            #pragma HLS UNROLL
+            firstColGap[i] = gapE[i+1][0];
+        }
+    #endif
 
+    systolic_loop(score, seq1_codebuffer, tileProfile, seqsize1_buffer, seqsize2_buffer,
+                  maxArrBuffer, vert_tile_num, horz_tile_num, firstColDiag, firstColLeft
+              #ifdef AFFINE_GAP
+                  , gapE, gapF, firstColGap
+              #endif
+              #ifdef TRACEBACK_POINTERS
+                  , traceTile
+              #endif
+                  );
 }
 
+//this function handles loading and calculating the file, NOT STORING, and NOT UPDATING MAX VALUE
+void process_tile(seq_in_t* seq1, seq_in_t* seq2, score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1], const int seqsize[2], volatile boundary_t* buffer,
+                  int buffer_horz_size, score_t leftSideBoundaryBuffer[TILE_DIMENSION+1], int horz_tile_num, int vert_tile_num,
+                  int maxArrBuffer[TILE_DIMENSION][2], char seq1_tilebuffer[TILE_DIMENSION], char seq2_tilebuffer[TILE_DIMENSION],
+                  unsigned char seq1_codebuffer[TILE_DIMENSION], const unsigned char codeTable[256],
+                  score_t tileProfile[TILE_DIMENSION][SCORE_ALPHABET], bool onchip, score_t boundaryLine[ONCHIP_BOUNDARY_LEN+1]
+#ifdef AFFINE_GAP
+                  , score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1], score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1],
+                  volatile boundary_t* gapBuffer, score_t leftSideGapBuffer[TILE_DIMENSION+1], score_t gapLine[ONCHIP_BOUNDARY_LEN+1]
+#endif
+#ifdef TRACEBACK_POINTERS
+                  , unsigned int traceTile[TILE_DIMENSION][TRACEBACK_ROW_WORDS]
+#endif
+                  ) 
+{
+    #pragma HLS INLINE off
+    //load the sequence data, tileProfile has to be the profile of this tile row already
+    seq_buffer_load(seq1_tilebuffer, seq2_tilebuffer, seq1_codebuffer, codeTable, seq1, seq2, horz_tile_num, vert_tile_num);
+    //the row above from the on chip line if seq1 fits in it, from buffer if not
+    if (onchip) {
+        boundary_fill_row(score, horz_tile_num, vert_tile_num, boundaryLine, leftSideBoundaryBuffer);
+    } else {
+        boundary_fill(score, horz_tile_num, vert_tile_num, buffer, buffer_horz_size, leftSideBoundaryBuffer);
+    }
+    #ifdef AFFINE_GAP
+        if (onchip) {
+            gap_boundary_fill_row(gapE, gapF, horz_tile_num, vert_tile_num, gapLine, leftSideGapBuffer);
+        } else {
+            gap_boundary_fill(gapE, gapF, horz_tile_num, vert_tile_num, gapBuffer, buffer_horz_size, leftSideGapBuffer);
+        }
+    #endif
+    compute_tile(score, seqsize, horz_tile_num, vert_tile_num, maxArrBuffer, seq1_codebuffer, tileProfile
+             #ifdef AFFINE_GAP
+                 , gapE, gapF
+             #endif
+             #ifdef TRACEBACK_POINTERS
+                 , traceTile
+             #endif
+                 );
+}
+
+#ifdef TILE_DATAFLOW
+//a tile row as a pipeline of three stages, so the next tile is loaded while this one is on the systolic array
+//and the one before is stored: load -> compute -> store, everything handed on goes through a stream in tile order
+//the left column is the only thing one tile needs from the one before, so it stays in the compute stage
+//the loader reads the tile row above out of buffer and the store writes this tile row, never the same words
+//with onchip (seq1 fits in ONCHIP_BOUNDARY_LEN) the row above is in the compute stage's line instead and the loader skips it
+
+//per tile: the seq1 codes, then the bottom of the tile above (corner first), with AFFINE_GAP its F row too
+void tile_row_load(seq_in_t* seq1, const unsigned char codeTable[256], volatile boundary_t* buffer, int buffer_horz_size,
+                   int vert_tile_num, int horz_tile_lo, int horz_tile_hi, bool onchip,
+                   hls::stream<unsigned char> &codeStream, hls::stream<score_t> &topStream
+#ifdef AFFINE_GAP
+                   , volatile boundary_t* gapBuffer, hls::stream<score_t> &topGapStream
+#endif
+                   )
+{
+    load_tile_loop: for (int horz_tile_num = horz_tile_lo; horz_tile_num <= horz_tile_hi; horz_tile_num++) {
+        char seq1_tilebuffer[TILE_DIMENSION];
+        #pragma HLS ARRAY_PARTITION variable=seq1_tilebuffer complete
+        seq_tile_load(seq1_tilebuffer, seq1, horz_tile_num);
+        load_code_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+            #pragma HLS PIPELINE II=1
+            codeStream.write(codeTable[(unsigned char)seq1_tilebuffer[i]]);
+        }
+        if (onchip) {
+            continue;
+        }
+
+        //same as boundary_fill, the top row is 0 on the first tile row and so is the corner on the first tile
+        int aboveOffset = (vert_tile_num - 1) * buffer_horz_size + horz_tile_num * TILE_BOUNDARY_SLOT;
+        load_top_loop: for (int i = 0; i <= TILE_DIMENSION; i++) {
+            #pragma HLS PIPELINE II=1
+            bool zero = (vert_tile_num == 0) || (i == 0 && horz_tile_num == 0);
+            topStream.write(zero ? 0 : buffer[aboveOffset + i]);
+        }
+        #ifdef AFFINE_GAP
+            load_top_gap_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+                #pragma HLS PIPELINE II=1
+                topGapStream.write(vert_tile_num == 0 ? 0 : gapBuffer[aboveOffset + i]);
+            }
+        #endif
+    }
+}
+
+//per tile: the bottom row then the right column (what score_buffer_store writes), then the max of every PE
+//with onchip the top comes from boundaryLine (gapLine) and the bottom goes back to it, the same way as boundary_fill_row
+//rowCorner is the cell above the left column of the first tile, skip_tile_edges' corner (0 without BANDED / XDROP)
+void tile_row_compute(int seqsize1, int seqsize2, int vert_tile_num, int horz_tile_lo, int horz_tile_hi, score_t rowCorner,
+                      score_t tileProfile[TILE_DIMENSION][SCORE_ALPHABET], bool onchip, score_t boundaryLine[ONCHIP_BOUNDARY_LEN+1],
+                      hls::stream<unsigned char> &codeStream, hls::stream<score_t> &topStream,
+                      hls::stream<score_t> &edgeStream, hls::stream<int> &maxStream
+#ifdef AFFINE_GAP
+                      , score_t gapLine[ONCHIP_BOUNDARY_LEN+1], hls::stream<score_t> &topGapStream, hls::stream<score_t> &gapEdgeStream
+#endif
+#ifdef TRACEBACK_POINTERS
+                      , hls::stream<unsigned int> &traceStream
+#endif
+                      )
+{
+    const int seqsize[2] = {seqsize1, seqsize2};
+    score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1];
+    #pragma HLS ARRAY_PARTITION variable=score complete dim=1
+    #pragma HLS BIND_STORAGE variable=score type=RAM_2P impl=AUTO
+    unsigned char seq1_codebuffer[TILE_DIMENSION];
+    #pragma HLS ARRAY_PARTITION variable=seq1_codebuffer complete
+    int maxArrBuffer[TILE_DIMENSION][2];
+    #pragma HLS ARRAY_PARTITION variable=maxArrBuffer complete
+    score_t leftSide[TILE_DIMENSION+1];
+    #pragma HLS ARRAY_PARTITION variable=leftSide complete
+    #ifdef AFFINE_GAP
+        score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1];
+        #pragma HLS ARRAY_PARTITION variable=gapE complete dim=1
+        #pragma HLS BIND_STORAGE variable=gapE type=RAM_2P impl=AUTO
+        score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1];
+        #pragma HLS ARRAY_PARTITION variable=gapF complete dim=1
+        #pragma HLS BIND_STORAGE variable=gapF type=RAM_2P impl=AUTO
+        score_t leftGap[TILE_DIMENSION+1];
+        #pragma HLS ARRAY_PARTITION variable=leftGap complete
+    #endif
+    #ifdef TRACEBACK_POINTERS
+        unsigned int traceTile[TILE_DIMENSION][TRACEBACK_ROW_WORDS];
+        #pragma HLS ARRAY_PARTITION variable=traceTile complete dim=1
+    #endif
+
+    //the tile before the first one is 0 bar the corner, it is either the left edge or one the band skipped
+    leftSide[0] = rowCorner;
+    left_init_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+        #pragma HLS UNROLL
+        leftSide[i] = 0;
+        #ifdef AFFINE_GAP
+            leftGap[i] = 0;
+        #endif
+    }
+
+    compute_tile_loop: for (int horz_tile_num = horz_tile_lo; horz_tile_num <= horz_tile_hi; horz_tile_num++) {
+        read_code_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+            #pragma HLS PIPELINE II=1
+            seq1_codebuffer[i] = codeStream.read();
+        }
+        int lineOffset = horz_tile_num * TILE_DIMENSION;
+        read_top_loop: for (int i = 0; i <= TILE_DIMENSION; i++) {
+            #pragma HLS PIPELINE II=1
+            if (!onchip) {
+                score[0][i] = topStream.read();
+            } else if (i == 0) {
+                score[0][0] = (horz_tile_num == 0) ? score_t(0) : leftSide[0];
+            } else {
+                score[0][i] = (vert_tile_num == 0) ? score_t(0) : boundaryLine[lineOffset + i];
+            }
+        }
+        left_fill_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+            #pragma HLS UNROLL
+            score[i][0] = (horz_tile_num == 0) ? score_t(0) : leftSide[i];
+        }
+        #ifdef AFFINE_GAP
+            read_top_gap_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+                #pragma HLS PIPELINE II=1
+                if (onchip) {
+                    gapF[0][i] = (vert_tile_num == 0) ? score_t(0) : gapLine[lineOffset + i];
+                } else {
+                    gapF[0][i] = topGapStream.read();
+                }
+                gapE[i][0] = (horz_tile_num == 0) ? score_t(0) : leftGap[i];
+            }
+        #endif
+        compute_tile(score, seqsize, horz_tile_num, vert_tile_num, maxArrBuffer, seq1_codebuffer, tileProfile
+                 #ifdef AFFINE_GAP
+                     , gapE, gapF
+                 #endif
+                 #ifdef TRACEBACK_POINTERS
+                     , traceTile
+                 #endif
+                     );
+
+        write_bottom_loop: for (int i = 0; i <= TILE_DIMENSION; i++) {
+            #pragma HLS PIPELINE II=1
+            edgeStream.write(score[TILE_DIMENSION][i]);
+            if (onchip && i > 0) {
+                boundaryLine[lineOffset + i] = score[TILE_DIMENSION][i];
+            }
+        }
+        write_right_loop: for (int i = 0; i <= TILE_DIMENSION; i++) {
+            #pragma HLS PIPELINE II=1
+            edgeStream.write(score[i][TILE_DIMENSION]);
+            leftSide[i] = score[i][TILE_DIMENSION];
+        }
+        #ifdef AFFINE_GAP
+            write_gap_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+                #pragma HLS PIPELINE II=1
+                gapEdgeStream.write(gapF[TILE_DIMENSION][i]);
+                gapEdgeStream.write(gapE[i][TILE_DIMENSION]);
+                if (onchip) {
+                    gapLine[lineOffset + i] = gapF[TILE_DIMENSION][i];
+                }
+                leftGap[i] = gapE[i][TILE_DIMENSION];
+            }
+        #endif
+        write_max_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+            #pragma HLS PIPELINE II=1
+            maxStream.write(maxArrBuffer[i][0]);
+            maxStream.write(maxArrBuffer[i][1]);
+        }
+        #ifdef TRACEBACK_POINTERS
+            write_trace_loop: for (int i = 0; i < TILE_DIMENSION * TRACEBACK_ROW_WORDS; i++) {
+                #pragma HLS PIPELINE II=1
+                traceStream.write(traceTile[i / TRACEBACK_ROW_WORDS][i % TRACEBACK_ROW_WORDS]);
+            }
+        #endif
+    }
+}
+
+//writes the tile edges where score_buffer_store would, and reduces the row to its first best cell
+//rowBest: 0 = score, 1 = j, 2 = i, score 0 if nothing in the row is above 0
+//with XDROP, rowLive: the first and last tile with a cell of its bottom row or right column at xdropFloor or above,
+//first > last if there is none
+void tile_row_store(volatile boundary_t* buffer, int buffer_horz_size, int vert_tile_num, int horz_tile_max,
+                    int horz_tile_lo, int horz_tile_hi, hls::stream<score_t> &edgeStream, hls::stream<int> &maxStream, int rowBest[3]
+#ifdef AFFINE_GAP
+                    , volatile boundary_t* gapBuffer, hls::stream<score_t> &gapEdgeStream
+#endif
+#ifdef TRACEBACK_POINTERS
+                    , volatile boundary_t* traceBuffer, hls::stream<unsigned int> &traceStream
+#endif
+#ifdef XDROP
+                    , int xdropFloor, int rowLive[2]
+#endif
+                    )
+{
+    int maxScore = 0;
+    int maxI = 0, maxJ = 0;
+    #ifdef XDROP
+        int firstLive = horz_tile_hi + 1, lastLive = horz_tile_lo - 1;
+    #endif
+    store_tile_loop: for (int horz_tile_num = horz_tile_lo; horz_tile_num <= horz_tile_hi; horz_tile_num++) {
+        int slot = vert_tile_num * buffer_horz_size + horz_tile_num * TILE_BOUNDARY_SLOT;
+        #ifdef XDROP
+            score_t edgeMax = 0;
+        #endif
+        store_edge_loop: for (int i = 0; i < TILE_BOUNDARY_SLOT; i++) {
+            #pragma HLS PIPELINE II=1
+            score_t edge = edgeStream.read();
+            buffer[slot + i] = edge;
+            #ifdef XDROP
+                //not the two corners, those are the neighbours' cells
+                if (i != 0 && i != TILE_DIMENSION + 1) {
+                    edgeMax = score_max(edgeMax, edge);
+                }
+            #endif
+        }
+        #ifdef XDROP
+            if (edgeMax >= xdropFloor) {
+                if (firstLive > horz_tile_num) {
+                    firstLive = horz_tile_num;
+                }
+                lastLive = horz_tile_num;
+            }
+        #endif
+        #ifdef AFFINE_GAP
+            store_gap_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+                #pragma HLS PIPELINE II=1
+                gapBuffer[slot + i] = gapEdgeStream.read();
+                gapBuffer[slot + TILE_DIMENSION + 1 + i] = gapEdgeStream.read();
+            }
+        #endif
+        //same order and compare as max_from_PE_loop
+        store_max_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+            #pragma HLS PIPELINE II=1
+            int maxind = maxStream.read();
+            int max = maxStream.read();
+            if (maxScore < max) {
+                maxScore = max;
+                maxI = i + vert_tile_num * TILE_DIMENSION + 1;
+                maxJ = maxind;
+            }
+        }
+        #ifdef TRACEBACK_POINTERS
+            int traceSlot = (vert_tile_num * horz_tile_max + horz_tile_num) * TILE_DIMENSION * TRACEBACK_ROW_WORDS;
+            store_trace_loop: for (int i = 0; i < TILE_DIMENSION * TRACEBACK_ROW_WORDS; i++) {
+                #pragma HLS PIPELINE II=1
+                traceBuffer[traceSlot + i] = traceStream.read();
+            }
+        #endif
+    }
+    rowBest[0] = maxScore;
+    rowBest[1] = maxJ;
+    rowBest[2] = maxI;
+    #ifdef XDROP
+        rowLive[0] = firstLive;
+        rowLive[1] = lastLive;
+    #endif
+}
+
+//one tile row, the three stages above run at the same time, tiles horz_tile_lo to horz_tile_hi of it
+void tile_row_dataflow(seq_in_t* seq1, const unsigned char codeTable[256], volatile boundary_t* buffer, int buffer_horz_size,
+                       int seqsize1, int seqsize2, int vert_tile_num, int horz_tile_max, int horz_tile_lo, int horz_tile_hi,
+                       score_t rowCorner,
+                       score_t tileProfile[TILE_DIMENSION][SCORE_ALPHABET], int rowBest[3],
+                       bool onchip, score_t boundaryLine[ONCHIP_BOUNDARY_LEN+1]
+#ifdef AFFINE_GAP
+                       , volatile boundary_t* gapBuffer, score_t gapLine[ONCHIP_BOUNDARY_LEN+1]
+#endif
+#ifdef TRACEBACK_POINTERS
+                       , volatile boundary_t* traceBuffer
+#endif
+#ifdef XDROP
+                       , int xdropFloor, int rowLive[2]
+#endif
+                       )
+{
+    #pragma HLS INLINE off
+    #pragma HLS DATAFLOW
+    //two tiles deep, so the loader can be a whole tile ahead of the compute and the compute one ahead of the store
+    hls::stream<unsigned char> codeStream;
+    #pragma HLS STREAM variable=codeStream depth=32
+    hls::stream<score_t> topStream;
+    #pragma HLS STREAM variable=topStream depth=34
+    hls::stream<score_t> edgeStream;
+    #pragma HLS STREAM variable=edgeStream depth=68
+    hls::stream<int> maxStream;
+    #pragma HLS STREAM variable=maxStream depth=64
+
+    #ifdef AFFINE_GAP
+        hls::stream<score_t> topGapStream;
+        #pragma HLS STREAM variable=topGapStream depth=32
+        hls::stream<score_t> gapEdgeStream;
+        #pragma HLS STREAM variable=gapEdgeStream depth=64
+    #endif
+    #ifdef TRACEBACK_POINTERS
+        hls::stream<unsigned int> traceStream;
+        #pragma HLS STREAM variable=traceStream depth=2*TILE_DIMENSION*TRACEBACK_ROW_WORDS
+    #endif
+
+    tile_row_load(seq1, codeTable, buffer, buffer_horz_size, vert_tile_num, horz_tile_lo, horz_tile_hi, onchip, codeStream, topStream
+              #ifdef AFFINE_GAP
+                  , gapBuffer, topGapStream
+              #endif
+                  );
+    tile_row_compute(seqsize1, seqsize2, vert_tile_num, horz_tile_lo, horz_tile_hi, rowCorner, tileProfile, onchip, boundaryLine,
+                     codeStream, topStream,
+                     edgeStream, maxStream
+                 #ifdef AFFINE_GAP
+                     , gapLine, topGapStream, gapEdgeStream
+                 #endif
+                 #ifdef TRACEBACK_POINTERS
+                     , traceStream
+                 #endif
+                     );
+    tile_row_store(buffer, buffer_horz_size, vert_tile_num, horz_tile_max, horz_tile_lo, horz_tile_hi, edgeStream, maxStream, rowBest
+               #ifdef AFFINE_GAP
+                   , gapBuffer, gapEdgeStream
+               #endif
+               #ifdef TRACEBACK_POINTERS
+                   , traceBuffer, traceStream
+               #endif
+               #ifdef XDROP
+                   , xdropFloor, rowLive
+               #endif
+                   );
+}
+#endif
+
+#ifdef STRIP_SYSTOLIC
+//a strip (tile row) on one column of TILE_DIMENSION PEs that stays up for the whole strip:
+//seq1 goes past the PEs a character a cycle, left to right, every PE keeps its left / diag going from one tile to the next,
+//so the array fills and drains once a strip instead of once a tile
+//the tile edges the backtrack needs still go to buffer the way score_buffer_store lays them out:
+//the bottom row comes out of the last PE as a stream, the right columns come from every PE at the last column of a tile
+//the row above is always read back from buffer (no ONCHIP_BOUNDARY_LEN line): strip_store writes it and strip_feed reads it,
+//and a line shared by two stages of the dataflow would have to be a ping-pong the size of the line
+
+//per column of the strip: the seq1 code and the score above it (the bottom of the strip above), F above it with AFFINE_GAP
+//corners: the score above the last column of every tile, the corner of that tile's right column
+void strip_feed(seq_in_t* seq1, const unsigned char codeTable[256], volatile boundary_t* buffer, int buffer_horz_size,
+                int vert_tile_num, int horz_tile_lo, int horz_tile_hi, hls::stream<unsigned char> &codeOut, hls::stream<score_t> &aboveOut,
+                hls::stream<score_t> &cornerOut
+#ifdef AFFINE_GAP
+                , volatile boundary_t* gapBuffer, hls::stream<score_t> &aboveGapOut
+#endif
+                )
+{
+    feed_tile_loop: for (int horz_tile_num = horz_tile_lo; horz_tile_num <= horz_tile_hi; horz_tile_num++) {
+        char seq1_tilebuffer[TILE_DIMENSION];
+        #pragma HLS ARRAY_PARTITION variable=seq1_tilebuffer complete
+        seq_tile_load(seq1_tilebuffer, seq1, horz_tile_num);
+        int aboveOffset = (vert_tile_num - 1) * buffer_horz_size + horz_tile_num * TILE_BOUNDARY_SLOT;
+
+        feed_col_loop: for (int k = 1; k <= TILE_DIMENSION; k++) {
+            #pragma HLS PIPELINE II=1
+            codeOut.write(codeTable[(unsigned char)seq1_tilebuffer[k - 1]]);
+            int above = (vert_tile_num == 0) ? 0 : buffer[aboveOffset + k];
+            aboveOut.write(above);
+            if (k == TILE_DIMENSION) {
+                cornerOut.write(above);
+            }
+            #ifdef AFFINE_GAP
+                aboveGapOut.write(vert_tile_num == 0 ? 0 : gapBuffer[aboveOffset + k]);
+            #endif
+        }
+    }
+}
+
+//one PE of the strip, row rowID of the tile row, same cell as PE
+//at the last column of every tile it hands on its score (and E) for the right column, and its max over that tile, then starts a new max
+//the strip is tiles horz_tile_lo to horz_tile_hi, diag starts as the cell above and to the left of its first cell
+void PE_strip(int vert_tile_num, int horz_tile_lo, int horz_tile_hi, int rowID, score_t diagStart,
+              hls::stream<score_t> &aboveSideIn, hls::stream<score_t> &downOut,
+              hls::stream<unsigned char> &codeIn, hls::stream<unsigned char> &codeOut,
+              const score_t profileRow[SCORE_ALPHABET], const int seqsize1, const int seqsize2,
+              hls::stream<score_t> &edgeOut, hls::stream<int> &maxOut
+#ifdef AFFINE_GAP
+              , hls::stream<score_t> &aboveGapIn, hls::stream<score_t> &downGapOut, hls::stream<score_t> &gapEdgeOut
+#endif
+#ifdef TRACEBACK_POINTERS
+              , hls::stream<unsigned int> &traceOut
+#endif
+              )
+{
+    score_t left = 0; //the left boundary of the strip is 0
+    score_t diag = diagStart;
+    score_t max = 0;
+    int maxind = 0;
+    #ifdef AFFINE_GAP
+        score_t leftGap = 0;
+    #endif
+    bool rowValid = rowID + vert_tile_num * TILE_DIMENSION <= seqsize2;
+    #ifdef TRACEBACK_POINTERS
+        unsigned int traceWord = 0;
+    #endif
+
+    //same II=1 split as PE: the left chain is one add and one compare, max runs on its own
+    strip_PE_loop: for (int j = horz_tile_lo * TILE_DIMENSION + 1; j <= (horz_tile_hi + 1) * TILE_DIMENSION; j++) {
+        #pragma HLS PIPELINE II=1
+
+        score_t above = aboveSideIn.read();
+        unsigned char code = codeIn.read();
+        codeOut.write(code);
+        bool valid = rowValid && j <= seqsize1;
+
+        score_t diagScore = diag + profileRow[code];
+        #ifdef AFFINE_GAP
+            score_t aboveGap = aboveGapIn.read();
+            score_t aboveScore = valid ? score_max(0, score_max(above + GAP_OPEN, aboveGap + GAP_EXTEND)) : score_t(0);
+            score_t upScore = score_max(diagScore, aboveScore);
+            score_t leftScore = valid ? score_max(0, score_max(left + GAP_OPEN, leftGap + GAP_EXTEND)) : score_t(0);
+            leftGap = leftScore;
+        #else
+            score_t upScore = score_max(0, score_max(diagScore, above + GAP_SCORE));
+            score_t leftScore = left + GAP_SCORE;
+        #endif
+        score_t myScore = valid ? score_max(upScore, leftScore) : score_t(0);
+        #ifdef TRACEBACK_POINTERS
+            //PE's packing, a tile's row of words goes out as the words fill up
+            traceWord = trace_pack(traceWord, (j - 1) % TILE_DIMENSION, trace_pointer(myScore, diagScore, leftScore
+            #ifdef AFFINE_GAP
+                , left, above, aboveScore
+            #endif
+                ));
+            if ((j - 1) % TRACEBACK_CELLS_PER_WORD == TRACEBACK_CELLS_PER_WORD - 1 || j % TILE_DIMENSION == 0) {
+                traceOut.write(traceWord);
+            }
+        #endif
+        left = myScore;
+        diag = above;
+
+        if (myScore > max) {
+            max = myScore;
+            maxind = j;
+        }
+        downOut.write(myScore);
+        #ifdef AFFINE_GAP
+            downGapOut.write(aboveScore);
+        #endif
+
+        if (j % TILE_DIMENSION == 0) {
+            edgeOut.write(myScore);
+            #ifdef AFFINE_GAP
+                gapEdgeOut.write(leftScore);
+            #endif
+            maxOut.write(maxind);
+            maxOut.write(max);
+            max = 0;
+        }
+    }
+}
+
+//takes what comes out of the bottom of the array and the right columns of every PE,
+//writes them to buffer a tile at a time in score_buffer_store's layout and reduces the row like tile_row_store (rowLive too)
+void strip_store(volatile boundary_t* buffer, int buffer_horz_size, int vert_tile_num, int horz_tile_max,
+                 int horz_tile_lo, int horz_tile_hi, hls::stream<score_t> &bottomIn, hls::stream<unsigned char> &codeIn, hls::stream<score_t> &cornerIn,
+                 hls::stream<score_t> edgeIn[TILE_DIMENSION], hls::stream<int> maxIn[TILE_DIMENSION], int rowBest[3]
+#ifdef AFFINE_GAP
+                 , volatile boundary_t* gapBuffer, hls::stream<score_t> &bottomGapIn, hls::stream<score_t> gapEdgeIn[TILE_DIMENSION]
+#endif
+#ifdef TRACEBACK_POINTERS
+                 , volatile boundary_t* traceBuffer, hls::stream<unsigned int> traceIn[TILE_DIMENSION]
+#endif
+#ifdef XDROP
+                 , int xdropFloor, int rowLive[2]
+#endif
+                 )
+{
+    int maxScore = 0;
+    int maxI = 0, maxJ = 0;
+    #ifdef XDROP
+        int firstLive = horz_tile_hi + 1, lastLive = horz_tile_lo - 1;
+    #endif
+    int corner = 0; //bottom left corner of the tile, the last bottom score of the tile before it
+    strip_store_loop: for (int horz_tile_num = horz_tile_lo; horz_tile_num <= horz_tile_hi; horz_tile_num++) {
+        int slot = vert_tile_num * buffer_horz_size + horz_tile_num * TILE_BOUNDARY_SLOT;
+        #ifdef XDROP
+            score_t edgeMax = 0;
+        #endif
+        buffer[slot] = corner;
+        strip_bottom_loop: for (int k = 1; k <= TILE_DIMENSION; k++) {
+            #pragma HLS PIPELINE II=1
+            int bottom = bottomIn.read();
+            codeIn.read();
+                //seq1 is done with once it is past the last PE
+            buffer[slot + k] = bottom;
+            corner = bottom;
+            #ifdef AFFINE_GAP
+                gapBuffer[slot + k] = bottomGapIn.read();
+            #endif
+            #ifdef XDROP
+                edgeMax = score_max(edgeMax, bottom);
+            #endif
+        }
+        buffer[slot + TILE_DIMENSION + 1] = cornerIn.read();
+        strip_right_loop: for (int i = 1; i <= TILE_DIMENSION; i++) {
+            #pragma HLS UNROLL
+            score_t right = edgeIn[i - 1].read();
+            buffer[slot + TILE_DIMENSION + 1 + i] = right;
+            #ifdef AFFINE_GAP
+                gapBuffer[slot + TILE_DIMENSION + 1 + i] = gapEdgeIn[i - 1].read();
+            #endif
+            #ifdef XDROP
+                edgeMax = score_max(edgeMax, right);
+            #endif
+        }
+        #ifdef XDROP
+            if (edgeMax >= xdropFloor) {
+                if (firstLive > horz_tile_num) {
+                    firstLive = horz_tile_num;
+                }
+                lastLive = horz_tile_num;
+            }
+        #endif
+        //same order and compare as max_from_PE_loop
+        strip_max_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+            #pragma HLS UNROLL
+            int maxind = maxIn[i].read();
+            int max = maxIn[i].read();
+            if (maxScore < max) {
+                maxScore = max;
+                maxI = i + vert_tile_num * TILE_DIMENSION + 1;
+                maxJ = maxind;
+            }
+        }
+        #ifdef TRACEBACK_POINTERS
+            int traceSlot = (vert_tile_num * horz_tile_max + horz_tile_num) * TILE_DIMENSION * TRACEBACK_ROW_WORDS;
+            strip_trace_loop: for (int k = 0; k < TILE_DIMENSION * TRACEBACK_ROW_WORDS; k++) {
+                #pragma HLS PIPELINE II=1
+                traceBuffer[traceSlot + k] = traceIn[k / TRACEBACK_ROW_WORDS].read();
+            }
+        #endif
+    }
+    rowBest[0] = maxScore;
+    rowBest[1] = maxJ;
+    rowBest[2] = maxI;
+    #ifdef XDROP
+        rowLive[0] = firstLive;
+        rowLive[1] = lastLive;
+    #endif
+}
+
+//one strip, feed -> PE column -> store all running at once, tiles horz_tile_lo to horz_tile_hi of the tile row
+//stripCorner is the cell above and to the left of the strip, skip_tile_edges' corner (0 without BANDED / XDROP)
+void strip_dataflow(seq_in_t* seq1, const unsigned char codeTable[256], volatile boundary_t* buffer, int buffer_horz_size,
+                    int seqsize1, int seqsize2, int vert_tile_num, int horz_tile_max, int horz_tile_lo, int horz_tile_hi,
+                    score_t stripCorner,
+                    score_t tileProfile[TILE_DIMENSION][SCORE_ALPHABET], int rowBest[3]
+#ifdef AFFINE_GAP
+                    , volatile boundary_t* gapBuffer
+#endif
+#ifdef TRACEBACK_POINTERS
+                    , volatile boundary_t* traceBuffer
+#endif
+#ifdef XDROP
+                    , int xdropFloor, int rowLive[2]
+#endif
+                    )
+{
+    #pragma HLS INLINE off
+    #pragma HLS DATAFLOW
+    hls::stream<score_t> streams[TILE_DIMENSION+1];
+    #pragma HLS STREAM variable=streams depth=3 type=fifo
+    #pragma HLS ARRAY_PARTITION variable=streams type=complete
+    hls::stream<unsigned char> codeStreams[TILE_DIMENSION+1];
+    #pragma HLS STREAM variable=codeStreams depth=3 type=fifo
+    #pragma HLS ARRAY_PARTITION variable=codeStreams type=complete
+    //a tile's worth of right column and max from the first PE has to wait for the last PE's bottom row
+    hls::stream<score_t> edgeStreams[TILE_DIMENSION];
+    #pragma HLS STREAM variable=edgeStreams depth=4 type=fifo
+    #pragma HLS ARRAY_PARTITION variable=edgeStreams type=complete
+    hls::stream<int> maxStreams[TILE_DIMENSION];
+    #pragma HLS STREAM variable=maxStreams depth=8 type=fifo
+    #pragma HLS ARRAY_PARTITION variable=maxStreams type=complete
+    hls::stream<score_t> cornerStream;
+    #pragma HLS STREAM variable=cornerStream depth=4
+    #ifdef AFFINE_GAP
+        hls::stream<score_t> gapStreams[TILE_DIMENSION+1];
+        #pragma HLS STREAM variable=gapStreams depth=3 type=fifo
+        #pragma HLS ARRAY_PARTITION variable=gapStreams type=complete
+        hls::stream<score_t> gapEdgeStreams[TILE_DIMENSION];
+        #pragma HLS STREAM variable=gapEdgeStreams depth=4 type=fifo
+        #pragma HLS ARRAY_PARTITION variable=gapEdgeStreams type=complete
+    #endif
+    #ifdef TRACEBACK_POINTERS
+        //as deep as edgeStreams in tiles
+        hls::stream<unsigned int> traceStreams[TILE_DIMENSION];
+        #pragma HLS STREAM variable=traceStreams depth=4*TRACEBACK_ROW_WORDS type=fifo
+        #pragma HLS ARRAY_PARTITION variable=traceStreams type=complete
+    #endif
+
+    strip_feed(seq1, codeTable, buffer, buffer_horz_size, vert_tile_num, horz_tile_lo, horz_tile_hi, codeStreams[0], streams[0],
+               cornerStream
+           #ifdef AFFINE_GAP
+               , gapBuffer, gapStreams[0]
+           #endif
+               );
+
+    strip_PE_chain: for (int i = 1; i <= TILE_DIMENSION; i++) {
+        #pragma HLS UNROLL
+        PE_strip(vert_tile_num, horz_tile_lo, horz_tile_hi, i, (i == 1) ? stripCorner : score_t(0),
+                 streams[i-1], streams[i], codeStreams[i-1], codeStreams[i],
+                 tileProfile[i-1], seqsize1, seqsize2, edgeStreams[i-1], maxStreams[i-1]
+            #ifdef AFFINE_GAP
+                 , gapStreams[i-1], gapStreams[i], gapEdgeStreams[i-1]
+            #endif
+            #ifdef TRACEBACK_POINTERS
+                 , traceStreams[i-1]
+            #endif
+                 );
+    }
+
+    strip_store(buffer, buffer_horz_size, vert_tile_num, horz_tile_max, horz_tile_lo, horz_tile_hi,
+                streams[TILE_DIMENSION], codeStreams[TILE_DIMENSION],
+                cornerStream, edgeStreams, maxStreams, rowBest
+            #ifdef AFFINE_GAP
+                , gapBuffer, gapStreams[TILE_DIMENSION], gapEdgeStreams
+            #endif
+            #ifdef TRACEBACK_POINTERS
+                , traceBuffer, traceStreams
+            #endif
+            #ifdef XDROP
+                , xdropFloor, rowLive
+            #endif
+                );
+}
+#endif
+
 int getTileNumberHorz(int j) {
     int tile_j = (j - 1)/ TILE_DIMENSION;
         //since all our stuff assumes the zero padding
@@ -247,7 +1213,7 @@ int getTileNumberVert(int i) {
     }
 }
 
-void loadLeftSideBuff_backtrack(volatile int* buffer, int currentTileHorz, int currentTileVert, int buffer_horz_size, int leftSideBoundaryBuffer[TILE_DIMENSION+1]) {
+void loadLeftSideBuff_backtrack(volatile boundary_t* buffer, int currentTileHorz, int currentTileVert, int buffer_horz_size, score_t leftSideBoundaryBuffer[TILE_DIMENSION+1]) {
     if (currentTileHorz == 0) {
         zero_backtrack_tileload: for (int w = 0; w <= TILE_DIMENSION; w++) {
             leftSideBoundaryBuffer[w] = 0;
@@ -255,12 +1221,112 @@ void loadLeftSideBuff_backtrack(volatile int* buffer, int currentTileHorz, int c
     } else {
         backtrack_tileload: for (int w = 0; w <= TILE_DIMENSION; w++) {
             leftSideBoundaryBuffer[w] = buffer[(currentTileVert) * buffer_horz_size +
-                                               (currentTileHorz - 1)* TILE_DIM_TIMES_2 + TILE_DIMENSION + 1 + w];
+                                               (currentTileHorz - 1)* TILE_BOUNDARY_SLOT + TILE_DIMENSION + 1 + w];
                     //right size storage from left tile
         }
     }
 }
 
+#if defined(BANDED) || defined(XDROP)
+//before tile row vert_tile_num, which computes tiles horz_lo to horz_hi (the band's, and XDROP's window):
+//the tiles skipped that it reads get zero edges,
+//so boundary_fill, the loader, the strip feed, the backtrack and the host (host_traceback.hpp) read 0 off them without knowing why
+//  the bottom of the tiles above, lo - 1 to hi, that the row above (aboveLo to aboveHi) did not compute, with onchip the line too,
+//  its corner is the cell the tile to their left ends on
+//  the right column of tile lo - 1, its corner is the cell above it, and the left side the forward pass carries starts as that
+//with TRACEBACK_POINTERS their pointers are zeroed too (TRACE_STOP), the walk can step onto those cells
+//returns the corner of tile lo, which is where the strip starts its diagonal
+score_t skip_tile_edges(volatile boundary_t* buffer, int buffer_horz_size, int vert_tile_num, int horz_tile_max,
+                        int horz_lo, int horz_hi, int aboveLo, int aboveHi,
+                        bool onchip, score_t boundaryLine[ONCHIP_BOUNDARY_LEN+1], score_t leftSideBoundaryBuffer[TILE_DIMENSION+1]
+#ifdef AFFINE_GAP
+                        , volatile boundary_t* gapBuffer, score_t gapLine[ONCHIP_BOUNDARY_LEN+1], score_t leftSideGapBuffer[TILE_DIMENSION+1]
+#endif
+#ifdef TRACEBACK_POINTERS
+                        , volatile boundary_t* traceBuffer
+#endif
+                        )
+{
+    if (horz_lo > horz_hi) {
+        return 0;
+    }
+    if (vert_tile_num > 0) {
+        band_above_loop: for (int horz_tile_num = (horz_lo > 0) ? horz_lo - 1 : 0; horz_tile_num <= horz_hi; horz_tile_num++) {
+            if (horz_tile_num >= aboveLo && horz_tile_num <= aboveHi) {
+                continue;
+            }
+            int slot = (vert_tile_num - 1) * buffer_horz_size + horz_tile_num * TILE_BOUNDARY_SLOT;
+            bool leftDone = horz_tile_num > 0 && horz_tile_num - 1 >= aboveLo && horz_tile_num - 1 <= aboveHi;
+            if (!leftDone) {
+                buffer[slot] = 0;
+            } else if (onchip) {
+                buffer[slot] = boundaryLine[horz_tile_num * TILE_DIMENSION];
+            } else {
+                buffer[slot] = buffer[slot - TILE_BOUNDARY_SLOT + TILE_DIMENSION];
+            }
+            band_above_zero_loop: for (int k = 1; k <= TILE_DIMENSION; k++) {
+                #pragma HLS PIPELINE II=1
+                buffer[slot + k] = 0;
+                if (onchip) {
+                    boundaryLine[horz_tile_num * TILE_DIMENSION + k] = 0;
+                }
+                #ifdef AFFINE_GAP
+                    gapBuffer[slot + k] = 0;
+                    if (onchip) {
+                        gapLine[horz_tile_num * TILE_DIMENSION + k] = 0;
+                    }
+                #endif
+            }
+            #ifdef TRACEBACK_POINTERS
+                int traceSlot = ((vert_tile_num - 1) * horz_tile_max + horz_tile_num) * TILE_DIMENSION * TRACEBACK_ROW_WORDS;
+                band_above_trace_loop: for (int k = 0; k < TILE_DIMENSION * TRACEBACK_ROW_WORDS; k++) {
+                    #pragma HLS PIPELINE II=1
+                    traceBuffer[traceSlot + k] = 0;
+                }
+            #endif
+        }
+    }
+
+    //the cell above the left column, on the bottom of tile lo - 1 of the row above, which is zeroed by now if it was skipped
+    score_t corner = 0;
+    if (vert_tile_num > 0 && horz_lo > 0) {
+        if (onchip) {
+            corner = boundaryLine[horz_lo * TILE_DIMENSION];
+        } else {
+            corner = buffer[(vert_tile_num - 1) * buffer_horz_size + (horz_lo - 1) * TILE_BOUNDARY_SLOT + TILE_DIMENSION];
+        }
+    }
+    leftSideBoundaryBuffer[0] = corner;
+    band_left_zero_loop: for (int w = 1; w <= TILE_DIMENSION; w++) {
+        #pragma HLS UNROLL
+        leftSideBoundaryBuffer[w] = 0;
+        #ifdef AFFINE_GAP
+            leftSideGapBuffer[w] = 0;
+        #endif
+    }
+    if (horz_lo > 0) {
+        int slot = vert_tile_num * buffer_horz_size + (horz_lo - 1) * TILE_BOUNDARY_SLOT + TILE_DIMENSION + 1;
+        band_left_store_loop: for (int w = 0; w <= TILE_DIMENSION; w++) {
+            #pragma HLS PIPELINE II=1
+            buffer[slot + w] = (w == 0) ? corner : score_t(0);
+            #ifdef AFFINE_GAP
+                if (w > 0) {
+                    gapBuffer[slot + w] = 0;
+                }
+            #endif
+        }
+        #ifdef TRACEBACK_POINTERS
+            int traceSlot = (vert_tile_num * horz_tile_max + horz_lo - 1) * TILE_DIMENSION * TRACEBACK_ROW_WORDS;
+            band_left_trace_loop: for (int k = 0; k < TILE_DIMENSION * TRACEBACK_ROW_WORDS; k++) {
+                #pragma HLS PIPELINE II=1
+                traceBuffer[traceSlot + k] = 0;
+            }
+        #endif
+    }
+    return corner;
+}
+#endif
+
 //#define DEBUG
 //#define DEBUG_SCORE
 //#define DEBUG_BACKTRACK
@@ -269,57 +1335,110 @@ void loadLeftSideBuff_backtrack(volatile int* buffer, int currentTileHorz, int c
 //#define DEBUG_OUTPUT
 //host does the reversing
 
-//Input strings: +1 due to taking a possible null terminator
-//Output string: padded with nulls, will always have at least 1 null terminator
-extern "C" void SW_basic_linear(
-    char* seq1, char* seq2, volatile int* buffer,
-            //each buffer location stores each tiles bottom and rtght sides
-            //bottom is stored first, then right
-        //seq1 and seq2 are actually ceiled to (nearest multiple of TILE_SIZE) + 1, since null terminator is included
-    const int seqsize[2], const int tilenum[2], 
-        //0 = seq1_len   //0 = ceil(seq1_len/TILE_SIZE)
-        //1 = seq2_len   //1 = ceil(seq2_len/TILE_SIZE)
-    char* alignedSeq1, char* alignedSeq2)
-        //maximum length of these is seq1_len+seq2_len (includes null term)
+//what align_pair gives back after the tiles
+//PAIR_STRINGS: the aligned strings (SW_basic_linear, SW_batch_linear)
+//PAIR_FORWARD: nothing, the edges in buffer and best are all SW_forward_linear gives back
+//PAIR_CIGAR: cigar runs instead of the strings (SW_cigar_linear)
+enum PairOutput { PAIR_STRINGS, PAIR_FORWARD, PAIR_CIGAR };
 
-    //seq1 is on top, seq2 is on left
+//the cigar runs of a backtrack, kept on chip and written to cigar CIGAR_BUFFER_RUNS at a time
+struct CigarRuns {
+    unsigned int runBuffer[CIGAR_BUFFER_RUNS];
+    int op;
+        //the run being built, -1 before the first step
+    int length;
+    int buffered;
+    int written;
+        //runs already in cigar
+};
 
-    //buffer is flattened 2d array
-    //buffer is row major since thats how C/C++ does it by default
-{
-    #pragma HLS INTERFACE m_axi port=seq1 offset=slave bundle=gmem0 depth=1024
-    #pragma HLS INTERFACE s_axilite port=seq1 bundle=control
-    #pragma HLS INTERFACE m_axi port=seq2 offset=slave bundle=gmem1 depth=1024
-    #pragma HLS INTERFACE s_axilite port=seq2 bundle=control
-    #pragma HLS INTERFACE m_axi port=buffer offset=slave bundle=gmem2 depth=1024
-    #pragma HLS INTERFACE s_axilite port=buffer bundle=control
-    #pragma HLS INTERFACE m_axi port=seqsize offset=slave bundle=gmem5 
-    #pragma HLS INTERFACE s_axilite port=seqsize bundle=control
-    #pragma HLS INTERFACE m_axi port=tilenum offset=slave bundle=gmem6 
-    #pragma HLS INTERFACE s_axilite port=tilenum bundle=control
-    #pragma HLS INTERFACE m_axi port=alignedSeq1 offset=slave bundle=gmem3 depth=128
-    #pragma HLS INTERFACE s_axilite port=alignedSeq1 bundle=control
-    #pragma HLS INTERFACE m_axi port=alignedSeq2 offset=slave bundle=gmem4 depth=128
-    #pragma HLS INTERFACE s_axilite port=alignedSeq2 bundle=control
-    #pragma HLS INTERFACE s_axilite port=return bundle=control
+void cigar_burst(CigarRuns& runs, unsigned int* cigar) {
+    cigar_burst_loop: for (int k = 0; k < runs.buffered; k++) {
+        #pragma HLS PIPELINE II=1
+        cigar[runs.written + k] = runs.runBuffer[k];
+    }
+    runs.written += runs.buffered;
+    runs.buffered = 0;
+}
+
+void cigar_close_run(CigarRuns& runs, unsigned int* cigar) {
+    if (runs.length == 0) {
+        return;
+    }
+    runs.runBuffer[runs.buffered] = ((unsigned int)runs.length << CIGAR_OP_BITS) | runs.op;
+    runs.buffered++;
+    if (runs.buffered == CIGAR_BUFFER_RUNS) {
+        cigar_burst(runs, cigar);
+    }
+}
+
+//one backtrack step, move is CIGAR_MATCH, CIGAR_INS (seq2 only) or CIGAR_DEL (seq1 only)
+//the strings get a character each at idx, cigar only gets a word when a run ends
+void backtrack_emit(PairOutput output, int move, char base1, char base2, int idx,
+                    char* alignedSeq1, char* alignedSeq2, CigarRuns& runs, unsigned int* cigar) {
+    if (output == PAIR_CIGAR) {
+        if (move != runs.op) {
+            cigar_close_run(runs, cigar);
+            runs.op = move;
+            runs.length = 0;
+        }
+        runs.length++;
+        return;
+    }
+    alignedSeq1[idx] = (move == CIGAR_INS) ? '-' : base1;
+    alignedSeq2[idx] = (move == CIGAR_DEL) ? '-' : base2;
+}
 
+//one pair start to end: the tiles, the best cell and the backtrack from it
+//the whole of SW_basic_linear but the scoring scheme, which is loaded once by the caller, SW_batch_linear runs it for every pair
+//best: 0 = score, 1 = end in seq1, 2 = end in seq2, returns the alignment length
+//with PAIR_CIGAR the runs go to cigar, end first like the strings, and cigarResult gets SW_cigar_linear's result
+int align_pair(seq_in_t* seq1, seq_in_t* seq2, volatile boundary_t* buffer, const int seqsize[2], const int tilenum[2],
+               char* alignedSeq1, char* alignedSeq2,
+               score_t subMatrix[SCORE_ALPHABET][SCORE_ALPHABET], unsigned char codeTable[256], int best[3],
+               PairOutput output = PAIR_STRINGS, unsigned int* cigar = 0, int cigarResult[CIGAR_RESULT_WORDS] = 0)
+{
     //initalizing tile buffers
     char seq1_tilebuffer[TILE_DIMENSION];
     #pragma HLS ARRAY_PARTITION variable=seq1_tilebuffer complete
     char seq2_tilebuffer[TILE_DIMENSION];
     #pragma HLS ARRAY_PARTITION variable=seq2_tilebuffer complete
+    unsigned char seq1_codebuffer[TILE_DIMENSION];
+    #pragma HLS ARRAY_PARTITION variable=seq1_codebuffer complete
+
+    //the query profile of the current tile row, one profile row per PE
+    score_t tileProfile[TILE_DIMENSION][SCORE_ALPHABET];
+    #pragma HLS ARRAY_PARTITION variable=tileProfile complete dim=1
 
     //ceil of seqsize / TILEDIM
     int horz_tile_max = tilenum[0];
     int vert_tile_max = tilenum[1];
 
-    //score matrix
-    int score[TILE_DIMENSION+1][TILE_DIMENSION+1];
-            //num ROW       //num COL
-    #pragma HLS ARRAY_PARTITION variable=score complete dim=1
-    //rows are partitioned
-    #pragma HLS BIND_STORAGE variable=score type=RAM_2P impl=AUTO
-    //https://docs.amd.com/r/en-US/ug1399-vitis-hls/pragma-HLS-bind_storage
+    #if !(defined(STRIP_SYSTOLIC) || defined(TILE_DATAFLOW)) || !defined(TRACEBACK_POINTERS)
+        //the tile at a time loop and the backtrack that recomputes tiles work on one tile here,
+        //the tile row pipelines keep their own and the pointer walk needs none
+
+        //score matrix
+        score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1];
+                //num ROW       //num COL
+        #pragma HLS ARRAY_PARTITION variable=score complete dim=1
+        //rows are partitioned
+        #pragma HLS BIND_STORAGE variable=score type=RAM_2P impl=AUTO
+        //https://docs.amd.com/r/en-US/ug1399-vitis-hls/pragma-HLS-bind_storage
+
+        int maxArrBuffer[TILE_DIMENSION][2];
+        #pragma HLS ARRAY_PARTITION variable=maxArrBuffer complete
+
+        #ifdef AFFINE_GAP
+            //gap scores of the tile, E is the gap coming from the left and F the one from above
+            score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1];
+            #pragma HLS ARRAY_PARTITION variable=gapE complete dim=1
+            #pragma HLS BIND_STORAGE variable=gapE type=RAM_2P impl=AUTO
+            score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1];
+            #pragma HLS ARRAY_PARTITION variable=gapF complete dim=1
+            #pragma HLS BIND_STORAGE variable=gapF type=RAM_2P impl=AUTO
+        #endif
+    #endif
 
     int outputsize = seqsize[0] + seqsize[1];
 
@@ -328,56 +1447,253 @@ extern "C" void SW_basic_linear(
     int maxScore = 0;
     int maxI = 0, maxJ = 0;
 
-    int leftSideBoundaryBuffer[TILE_DIMENSION+1];
-    #pragma HLS ARRAY_PARTITION variable=leftSideBoundaryBuffer complete dim=0
+    #if !(defined(STRIP_SYSTOLIC) || defined(TILE_DATAFLOW)) || defined(BANDED) || defined(XDROP)
+        //right side of the tile to the left, for the tile at a time loop and for skip_tile_edges' zero edges
+        score_t leftSideBoundaryBuffer[TILE_DIMENSION+1];
+        #pragma HLS ARRAY_PARTITION variable=leftSideBoundaryBuffer complete dim=0
+        #ifdef AFFINE_GAP
+            //E of the same right side
+            score_t leftSideGapBuffer[TILE_DIMENSION+1];
+            #pragma HLS ARRAY_PARTITION variable=leftSideGapBuffer complete dim=0
+        #endif
+    #endif
 
-    int maxArrBuffer[TILE_DIMENSION][2];
-    #pragma HLS ARRAY_PARTITION variable=maxArrBuffer complete
+    #ifdef AFFINE_GAP
+        volatile boundary_t* gapBuffer = &buffer[vert_tile_max * buffer_horz_size];
+    #endif
+
+    //the bottom row of the tile row above when seq1 fits in it, so the forward pass reads nothing back from buffer
+    //the tile edges still all go to buffer for the backtrack, those are writes only
+    //STRIP_SYSTOLIC has no line, strip_feed reads the row above back from buffer
+    #ifndef STRIP_SYSTOLIC
+        bool onchip = horz_tile_max * TILE_DIMENSION <= ONCHIP_BOUNDARY_LEN;
+    #endif
+    score_t boundaryLine[ONCHIP_BOUNDARY_LEN+1];
+    #pragma HLS BIND_STORAGE variable=boundaryLine type=RAM_2P impl=URAM
+    #ifdef AFFINE_GAP
+        score_t gapLine[ONCHIP_BOUNDARY_LEN+1];
+            //F under the tile row above
+        #pragma HLS BIND_STORAGE variable=gapLine type=RAM_2P impl=URAM
+    #endif
+
+    #ifdef TRACEBACK_POINTERS
+        //the pointers go after every plane of tile edges (traceback_ptr.hpp)
+        volatile boundary_t* traceBuffer = &buffer[vert_tile_max * buffer_horz_size * BOUNDARY_PLANES];
+        #if !(defined(STRIP_SYSTOLIC) || defined(TILE_DATAFLOW))
+            //the tile at a time loop's pointers, the tile row pipelines keep their own
+            unsigned int traceTile[TILE_DIMENSION][TRACEBACK_ROW_WORDS];
+            #pragma HLS ARRAY_PARTITION variable=traceTile complete dim=1
+        #endif
+    #endif
+
+    #ifdef BANDED
+        //the band's center diagonal
+        int bandCenter = BAND_CENTER;
+    #endif
+    #ifdef XDROP
+        //the window of tiles the next row runs, from under the first live tile of the row above to the one after the last
+        int xdropLo = 0, xdropHi = horz_tile_max - 1;
+    #endif
+    #if defined(BANDED) || defined(XDROP)
+        //the tiles the row above computed
+        int aboveLo = 0, aboveHi = -1;
+    #endif
 
     //down the tiles
     vert_tile_loop: for (int vert_tile_num = 0; vert_tile_num < vert_tile_max; vert_tile_num++) {
-        
-        //across the tiles
-        horz_tile_loop: for (int horz_tile_num = 0; horz_tile_num < horz_tile_max; horz_tile_num++) {
-            //#pragma HLS LOOP_FLATTEN off
+        profile_load(tileProfile, subMatrix, codeTable, seq2, vert_tile_num);
+
+        //the tiles of the row that are computed, all of them without BANDED or XDROP
+        int horz_tile_lo = 0, horz_tile_hi = horz_tile_max - 1;
+        #if defined(STRIP_SYSTOLIC) || defined(TILE_DATAFLOW)
+            //corner of tile lo, where the strip starts its diagonal (skip_tile_edges)
+            score_t rowCorner = 0;
+        #endif
+        #ifdef BANDED
+            bandTileRange(vert_tile_num, TILE_DIMENSION, horz_tile_max, bandCenter, BAND_WIDTH, horz_tile_lo, horz_tile_hi);
+        #endif
+        #ifdef XDROP
+            if (horz_tile_lo < xdropLo) {
+                horz_tile_lo = xdropLo;
+            }
+            if (horz_tile_hi > xdropHi) {
+                horz_tile_hi = xdropHi;
+            }
+            //a tile is live if an edge cell is no more than XDROP_SCORE below the best of the rows above,
+            //the same best for every tile of the row, so the pipelined rows and the tile loop drop the same tiles
+            int xdropFloor = maxScore - XDROP_SCORE;
+            int rowLive[2] = {horz_tile_hi + 1, horz_tile_lo - 1};
+        #endif
+        #if defined(BANDED) || defined(XDROP)
+            #if defined(STRIP_SYSTOLIC) || defined(TILE_DATAFLOW)
+                rowCorner =
+            #endif
+            skip_tile_edges(buffer, buffer_horz_size, vert_tile_num, horz_tile_max, horz_tile_lo, horz_tile_hi, aboveLo, aboveHi,
+                        #ifdef STRIP_SYSTOLIC
+                            false,
+                        #else
+                            onchip,
+                        #endif
+                            boundaryLine, leftSideBoundaryBuffer
+                        #ifdef AFFINE_GAP
+                            , gapBuffer, gapLine, leftSideGapBuffer
+                        #endif
+                        #ifdef TRACEBACK_POINTERS
+                            , traceBuffer
+                        #endif
+                            );
+            aboveLo = horz_tile_lo;
+            aboveHi = horz_tile_hi;
+        #endif
+
+        #if defined(STRIP_SYSTOLIC) || defined(TILE_DATAFLOW)
+            //the whole tile row in one pipeline, then its best cell against the rows above
+            int rowBest[3];
+            #ifdef STRIP_SYSTOLIC
+                strip_dataflow(seq1, codeTable, buffer, buffer_horz_size, seqsize[0], seqsize[1], vert_tile_num, horz_tile_max,
+                               horz_tile_lo, horz_tile_hi, rowCorner, tileProfile, rowBest
+                           #ifdef AFFINE_GAP
+                               , gapBuffer
+                           #endif
+                           #ifdef TRACEBACK_POINTERS
+                               , traceBuffer
+                           #endif
+                           #ifdef XDROP
+                               , xdropFloor, rowLive
+                           #endif
+                               );
+            #else
+                tile_row_dataflow(seq1, codeTable, buffer, buffer_horz_size, seqsize[0], seqsize[1], vert_tile_num, horz_tile_max,
+                                  horz_tile_lo, horz_tile_hi, rowCorner, tileProfile, rowBest, onchip, boundaryLine
+                              #ifdef AFFINE_GAP
+                                  , gapBuffer, gapLine
+                              #endif
+                              #ifdef TRACEBACK_POINTERS
+                                  , traceBuffer
+                              #endif
+                              #ifdef XDROP
+                                  , xdropFloor, rowLive
+                              #endif
+                                  );
+            #endif
+            if (maxScore < rowBest[0]) {
+                maxScore = rowBest[0];
+                maxJ = rowBest[1];
+                maxI = rowBest[2];
+            }
+        #else
+            //across the tiles
+            horz_tile_loop: for (int horz_tile_num = horz_tile_lo; horz_tile_num <= horz_tile_hi; horz_tile_num++) {
+                //#pragma HLS LOOP_FLATTEN off
             
-            process_tile(seq1, seq2, score, seqsize, buffer,
-                        buffer_horz_size, leftSideBoundaryBuffer, horz_tile_num, vert_tile_num,
-                        maxArrBuffer, seq1_tilebuffer, seq2_tilebuffer);
+                process_tile(seq1, seq2, score, seqsize, buffer,
+                            buffer_horz_size, leftSideBoundaryBuffer, horz_tile_num, vert_tile_num,
+                            maxArrBuffer, seq1_tilebuffer, seq2_tilebuffer, seq1_codebuffer, codeTable, tileProfile,
+                            onchip, boundaryLine
+                        #ifdef AFFINE_GAP
+                            , gapE, gapF, gapBuffer, leftSideGapBuffer, gapLine
+                        #endif
+                        #ifdef TRACEBACK_POINTERS
+                            , traceTile
+                        #endif
+                            );
 
-            //move max arr from PE to the main storage
-            max_from_PE_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
-                if (maxScore < maxArrBuffer[i][1]) {
-                    maxScore = maxArrBuffer[i][1];
-                    maxI = i + vert_tile_num * TILE_DIMENSION + 1;
-                    maxJ = maxArrBuffer[i][0];
-                }
-            }            
+                //move max arr from PE to the main storage
+                max_from_PE_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+                    if (maxScore < maxArrBuffer[i][1]) {
+                        maxScore = maxArrBuffer[i][1];
+                        maxI = i + vert_tile_num * TILE_DIMENSION + 1;
+                        maxJ = maxArrBuffer[i][0];
+                    }
+                }            
 
-            #ifdef DEBUG_SCORE
-                for (int i = 0; i <= TILE_DIMENSION; i++) {
-                    for (int j = 0; j <= TILE_DIMENSION; j++) {
-                        std::cout << score[i][j] << " ";
+                #ifdef XDROP
+                    //tile_row_store's rowLive
+                    score_t edgeMax = 0;
+                    xdrop_edge_loop: for (int k = 1; k <= TILE_DIMENSION; k++) {
+                        #pragma HLS UNROLL
+                        edgeMax = score_max(edgeMax, score_max(score[TILE_DIMENSION][k], score[k][TILE_DIMENSION]));
                     }
-                    std::cout << std::endl;  // Move to the next line after each row
-                }
-                std::cout << std::endl;
-            #endif
+                    if (edgeMax >= xdropFloor) {
+                        if (rowLive[0] > horz_tile_num) {
+                            rowLive[0] = horz_tile_num;
+                        }
+                        rowLive[1] = horz_tile_num;
+                    }
+                #endif
+
+                #ifdef DEBUG_SCORE
+                    for (int i = 0; i <= TILE_DIMENSION; i++) {
+                        for (int j = 0; j <= TILE_DIMENSION; j++) {
+                            std::cout << score[i][j] << " ";
+                        }
+                        std::cout << std::endl;  // Move to the next line after each row
+                    }
+                    std::cout << std::endl;
+                #endif
 
-            score_buffer_store(score, horz_tile_num, vert_tile_num, buffer, buffer_horz_size, leftSideBoundaryBuffer);
+                score_buffer_store(score, horz_tile_num, vert_tile_num, buffer, buffer_horz_size, leftSideBoundaryBuffer);
+                #ifdef AFFINE_GAP
+                    gap_buffer_store(gapE, gapF, horz_tile_num, vert_tile_num, gapBuffer, buffer_horz_size, leftSideGapBuffer);
+                #endif
+                if (onchip) {
+                    score_row_store(score, horz_tile_num, boundaryLine, leftSideBoundaryBuffer);
+                    #ifdef AFFINE_GAP
+                        gap_row_store(gapE, gapF, horz_tile_num, gapLine, leftSideGapBuffer);
+                    #endif
+                }
+                #ifdef TRACEBACK_POINTERS
+                    int traceSlot = (vert_tile_num * horz_tile_max + horz_tile_num) * TILE_DIMENSION * TRACEBACK_ROW_WORDS;
+                    trace_store_loop: for (int k = 0; k < TILE_DIMENSION * TRACEBACK_ROW_WORDS; k++) {
+                        #pragma HLS PIPELINE II=1
+                        traceBuffer[traceSlot + k] = traceTile[k / TRACEBACK_ROW_WORDS][k % TRACEBACK_ROW_WORDS];
+                    }
+                #endif
             
-        }
+            }
+        #endif
+        #if defined(BANDED) && BAND_ADAPTIVE
+            //the next row's band is around the best cell so far
+            if (maxScore > 0) {
+                bandCenter = maxI - maxJ;
+            }
+        #endif
+        #ifdef XDROP
+            //a row the band left empty says nothing about the tiles, the window stays as it is
+            if (horz_tile_lo <= horz_tile_hi) {
+                if (rowLive[0] > rowLive[1]) {
+                    break; //every tile below only reads dead ones
+                }
+                xdropLo = rowLive[0];
+                xdropHi = (rowLive[1] + 1 < horz_tile_max) ? rowLive[1] + 1 : horz_tile_max - 1;
+            }
+        #endif
+    }
+
+    best[0] = maxScore;
+    best[1] = maxJ;
+    best[2] = maxI;
+    if (output == PAIR_FORWARD) {
+        return 0;
     }
 
     //flushing the output array
-    output_flush: for (int i = 0; i < outputsize; i++) {
-        alignedSeq1[i] = 0;
-        alignedSeq2[i] = 0;
+    if (output == PAIR_STRINGS) {
+        output_flush: for (int i = 0; i < outputsize; i++) {
+            alignedSeq1[i] = 0;
+            alignedSeq2[i] = 0;
+        }
     }
+    CigarRuns runs;
+    runs.op = -1;
+    runs.length = 0;
+    runs.buffered = 0;
+    runs.written = 0;
 
     //backtracking
     //keeping it simple, may improve later
     //backtrack is simply loading each value one by one from the buffer
+    //a tile is recomputed from its edges in buffer, never from the on chip line, which only has the last tile row
     int i = maxI;
     int j = maxJ;
     int idx = 0;
@@ -401,24 +1717,102 @@ extern "C" void SW_basic_linear(
         std::cout << std::endl;
     #endif
 
+#ifdef TRACEBACK_POINTERS
+    //the forward pass left the move out of every cell in traceBuffer, so this is a walk over them, nothing is recomputed
+    //a tile's characters and pointers are loaded when the walk goes into it, the moves are tracebackWalk's (traceback_ptr.hpp)
+    unsigned int tracePtrs[TILE_DIMENSION][TRACEBACK_ROW_WORDS];
+    #pragma HLS ARRAY_PARTITION variable=tracePtrs complete dim=1
+    int currentTileVert = -1;
+    int currentTileHorz = -1;
+    int gapState = 0;
+        //0 = on the score, 1 = in a gap coming from the left (E), 2 = in a gap coming from above (F)
+
+    pointer_backtrack_loop: while (i > 0 && j > 0) {
+        int checkTileVert = getTileNumberVert(i);
+        int checkTileHorz = getTileNumberHorz(j);
+        if ((checkTileHorz != currentTileHorz) || (checkTileVert != currentTileVert)) {
+            currentTileVert = checkTileVert;
+            currentTileHorz = checkTileHorz;
+            seq_buffer_load(seq1_tilebuffer, seq2_tilebuffer, seq1_codebuffer, codeTable, seq1, seq2, currentTileHorz, currentTileVert);
+            int traceSlot = (currentTileVert * horz_tile_max + currentTileHorz) * TILE_DIMENSION * TRACEBACK_ROW_WORDS;
+            trace_tileload: for (int k = 0; k < TILE_DIMENSION * TRACEBACK_ROW_WORDS; k++) {
+                #pragma HLS PIPELINE II=1
+                tracePtrs[k / TRACEBACK_ROW_WORDS][k % TRACEBACK_ROW_WORDS] = traceBuffer[traceSlot + k];
+            }
+        }
+        int seq1buffer_targ = j-currentTileHorz*TILE_DIMENSION-1;
+        int seq2buffer_targ = i-currentTileVert*TILE_DIMENSION-1;
+        int trace = tracebackCell(tracePtrs[seq2buffer_targ], seq1buffer_targ);
+        if ((trace & 3) == TRACE_STOP) {
+            break;
+        }
+        if (gapState == 0 && (trace & 3) != TRACE_DIAG) {
+            gapState = (trace & 3) == TRACE_LEFT ? 1 : 2;
+        }
+
+        int move;
+        if (gapState == 0) {
+            move = CIGAR_MATCH;
+            i--;
+            j--;
+        } else if (gapState == 1) {
+            move = CIGAR_DEL;
+            #ifdef AFFINE_GAP
+                //leave the gap where it was opened, like the recomputing backtrack
+                gapState = (trace & TRACE_E_OPEN) ? 0 : 1;
+            #else
+                gapState = 0;
+            #endif
+            j--;
+        } else {
+            move = CIGAR_INS;
+            #ifdef AFFINE_GAP
+                gapState = (trace & TRACE_F_OPEN) ? 0 : 2;
+            #else
+                gapState = 0;
+            #endif
+            i--;
+        }
+        backtrack_emit(output, move, seq1_tilebuffer[seq1buffer_targ], seq2_tilebuffer[seq2buffer_targ], idx,
+                       alignedSeq1, alignedSeq2, runs, cigar);
+        idx++;
+    }
+#else
     //----------------------------------------------------------------------------------
     //the following section gets the initial setup for the backtrack loop
     int currentTileVert = getTileNumberVert(i);
     int currentTileHorz = getTileNumberHorz(j);
         //gets initial tilenum
 
-    int leftSideBoundaryBuffer2[TILE_DIMENSION+1];
+    score_t leftSideBoundaryBuffer2[TILE_DIMENSION+1];
     #pragma HLS ARRAY_PARTITION variable=leftSideBoundaryBuffer2 complete dim=0
         //remade
+    #ifdef AFFINE_GAP
+        score_t leftSideGapBuffer2[TILE_DIMENSION+1];
+        #pragma HLS ARRAY_PARTITION variable=leftSideGapBuffer2 complete dim=0
+
+        //a gap can go over tile edges, so the backtrack has to remember it is in one
+        //0 = on the score, 1 = in a gap coming from the left (E), 2 = in a gap coming from above (F)
+        int gapState = 0;
+    #endif
     
     bool indexGreaterThanZero = 0;
     if (i > 0 && j > 0) {
         //load up with initial tile if valid
         loadLeftSideBuff_backtrack(buffer, currentTileHorz, currentTileVert, buffer_horz_size, leftSideBoundaryBuffer2);
+        profile_load(tileProfile, subMatrix, codeTable, seq2, currentTileVert);
         indexGreaterThanZero = 1;
-        process_tile(seq1, seq2, score, seqsize, buffer,
-            buffer_horz_size, leftSideBoundaryBuffer2, currentTileHorz, currentTileVert,
-            maxArrBuffer, seq1_tilebuffer, seq2_tilebuffer);
+        #ifdef AFFINE_GAP
+            loadLeftSideBuff_backtrack(gapBuffer, currentTileHorz, currentTileVert, buffer_horz_size, leftSideGapBuffer2);
+            process_tile(seq1, seq2, score, seqsize, buffer,
+                buffer_horz_size, leftSideBoundaryBuffer2, currentTileHorz, currentTileVert,
+                maxArrBuffer, seq1_tilebuffer, seq2_tilebuffer, seq1_codebuffer, codeTable, tileProfile,
+                false, boundaryLine, gapE, gapF, gapBuffer, leftSideGapBuffer2, gapLine);
+        #else
+            process_tile(seq1, seq2, score, seqsize, buffer,
+                buffer_horz_size, leftSideBoundaryBuffer2, currentTileHorz, currentTileVert,
+                maxArrBuffer, seq1_tilebuffer, seq2_tilebuffer, seq1_codebuffer, codeTable, tileProfile, false, boundaryLine);
+        #endif
     }
     
     #ifdef DEBUG_BACKTRACK_MORE
@@ -450,7 +1844,7 @@ extern "C" void SW_basic_linear(
         int seq2buffer_targ = i-currentTileVert*TILE_DIMENSION-1;
 
         #ifdef DEBUG_BACKTRACK
-            std::cout << " |||  = " << ((seq1_tilebuffer[seq1buffer_targ] == seq2_tilebuffer[seq2buffer_targ]) ? MATCH_SCORE : MISMATCH_SCORE) 
+            std::cout << " |||  = " << tileProfile[seq2buffer_targ][seq1_codebuffer[seq1buffer_targ]]
                       << " dia  = " << diagValue 
                       << " |  me " << currValue
                       << " | i = " << i 
@@ -459,25 +1853,60 @@ extern "C" void SW_basic_linear(
 
         //rewriting this to use the score values was a PITA
         //this is the backtrack move
-        if (currValue == (diagValue + ((seq1_tilebuffer[seq1buffer_targ] == 
-                                        seq2_tilebuffer[seq2buffer_targ]) ? MATCH_SCORE : MISMATCH_SCORE))) {
-            alignedSeq1[idx] = seq1_tilebuffer[seq1buffer_targ];
-            alignedSeq2[idx] = seq2_tilebuffer[seq2buffer_targ];
+        int move;
+        #ifdef AFFINE_GAP
+            int aboveValue = score[i-1-currentTileVert*TILE_DIMENSION][j-currentTileHorz*TILE_DIMENSION];
+            int currE = gapE[i-currentTileVert*TILE_DIMENSION][j-currentTileHorz*TILE_DIMENSION];
+            int currF = gapF[i-currentTileVert*TILE_DIMENSION][j-currentTileHorz*TILE_DIMENSION];
+
+            if (gapState == 0) {
+                if (currValue == diagValue + tileProfile[seq2buffer_targ][seq1_codebuffer[seq1buffer_targ]]) {
+                    gapState = 3; //diagonal move, just for this step
+                } else if (currValue == currE) {
+                    gapState = 1;
+                } else { // currValue == currF
+                    gapState = 2;
+                }
+            }
+
+            if (gapState == 3) {
+                move = CIGAR_MATCH;
+                gapState = 0;
+                i--;
+                j--;
+            } else if (gapState == 1) {
+                move = CIGAR_DEL;
+                //leave the gap where it was opened, so the shortest one
+                if (currE == leftValue + GAP_OPEN) {
+                    gapState = 0;
+                }
+                j--;
+            } else {
+                move = CIGAR_INS;
+                if (currF == aboveValue + GAP_OPEN) {
+                    gapState = 0;
+                }
+                i--;
+            }
+        #else
+        if (currValue == diagValue + tileProfile[seq2buffer_targ][seq1_codebuffer[seq1buffer_targ]]) {
+            move = CIGAR_MATCH;
             i--;
             j--;
         } else if (currValue == leftValue + GAP_SCORE) {
-            alignedSeq1[idx] = seq1_tilebuffer[seq1buffer_targ];
-            alignedSeq2[idx] = '-';
+            move = CIGAR_DEL;
             j--;
         } else { // buffer[i][j] == buffer[i][j-1] + GAP_SCORE
-            alignedSeq1[idx] = '-';
-            alignedSeq2[idx] = seq2_tilebuffer[seq2buffer_targ];
+            move = CIGAR_INS;
             i--;
         }
+        #endif
+        backtrack_emit(output, move, seq1_tilebuffer[seq1buffer_targ], seq2_tilebuffer[seq2buffer_targ], idx,
+                       alignedSeq1, alignedSeq2, runs, cigar);
 
         
         #ifdef DEBUG_BACKTRACK
-            std::cout << "idx = " << idx << " | s1 = " << alignedSeq1[idx] << " s2 = " << alignedSeq2[idx] << std::endl;
+            std::cout << "idx = " << idx << " | move = " << move << std::endl;
         #endif
         idx++;
 
@@ -497,12 +1926,23 @@ extern "C" void SW_basic_linear(
                     #ifdef DEBUG_BACKTRACK
                         std::cout << "Moving to tile: horz= " << checkTileHorz << " | vert= " << checkTileVert << std::endl; 
                     #endif
+                    if (checkTileVert != currentTileVert) {
+                        profile_load(tileProfile, subMatrix, codeTable, seq2, checkTileVert);
+                    }
                     currentTileVert = checkTileVert;
                     currentTileHorz = checkTileHorz;
                     loadLeftSideBuff_backtrack(buffer, currentTileHorz, currentTileVert, buffer_horz_size, leftSideBoundaryBuffer2);
-                    process_tile(seq1, seq2, score, seqsize, buffer,
-                        buffer_horz_size, leftSideBoundaryBuffer2, currentTileHorz, currentTileVert,
-                        maxArrBuffer, seq1_tilebuffer, seq2_tilebuffer);
+                    #ifdef AFFINE_GAP
+                        loadLeftSideBuff_backtrack(gapBuffer, currentTileHorz, currentTileVert, buffer_horz_size, leftSideGapBuffer2);
+                        process_tile(seq1, seq2, score, seqsize, buffer,
+                            buffer_horz_size, leftSideBoundaryBuffer2, currentTileHorz, currentTileVert,
+                            maxArrBuffer, seq1_tilebuffer, seq2_tilebuffer, seq1_codebuffer, codeTable, tileProfile,
+                false, boundaryLine, gapE, gapF, gapBuffer, leftSideGapBuffer2, gapLine);
+                    #else
+                        process_tile(seq1, seq2, score, seqsize, buffer,
+                            buffer_horz_size, leftSideBoundaryBuffer2, currentTileHorz, currentTileVert,
+                            maxArrBuffer, seq1_tilebuffer, seq2_tilebuffer, seq1_codebuffer, codeTable, tileProfile, false, boundaryLine);
+                    #endif
 
                     #ifdef DEBUG_BACKTRACK_MORE
                         for (int i = 0; i <= TILE_DIMENSION; i++) {
@@ -517,6 +1957,19 @@ extern "C" void SW_basic_linear(
             }
         }
     }
+#endif
+
+    if (output == PAIR_CIGAR) {
+        //the last run, then what is left of the on chip runs in one burst
+        cigar_close_run(runs, cigar);
+        cigar_burst(runs, cigar);
+        cigarResult[0] = maxScore;
+        cigarResult[1] = j + 1;
+        cigarResult[2] = i + 1;
+        cigarResult[3] = maxJ;
+        cigarResult[4] = maxI;
+        cigarResult[5] = runs.written;
+    }
 
     #ifdef DEBUG_OUTPUT
         std::cout << "alignedSeq1: ";
@@ -531,4 +1984,393 @@ extern "C" void SW_basic_linear(
         }
         std::cout << std::endl;
     #endif
-}
\ No newline at end of file
+
+    return idx;
+}
+
+//Input strings: +1 due to taking a possible null terminator
+//Output string: padded with nulls, will always have at least 1 null terminator
+extern "C" void SW_basic_linear(
+    seq_in_t* seq1, seq_in_t* seq2, volatile boundary_t* buffer,
+            //each buffer location stores each tiles bottom and rtght sides
+            //bottom is stored first, then right
+        //seq1 and seq2 are actually ceiled to (nearest multiple of TILE_SIZE) + 1, since null terminator is included
+        //with PACKED_SEQ they are packedWords(tilenum * TILE_SIZE) words instead (packed_seq.hpp)
+    const int seqsize[2], const int tilenum[2], 
+        //0 = seq1_len   //0 = ceil(seq1_len/TILE_SIZE)
+        //1 = seq2_len   //1 = ceil(seq2_len/TILE_SIZE)
+    char* alignedSeq1, char* alignedSeq2,
+        //maximum length of these is seq1_len+seq2_len (includes null term)
+    const int* scoring)
+        //packed ScoringScheme, SCORING_WORDS long
+
+    //seq1 is on top, seq2 is on left
+    //with AFFINE_GAP buffer holds a second set of tile edges after the scores, F on the bottom and E on the right
+
+    //buffer is flattened 2d array
+    //buffer is row major since thats how C/C++ does it by default
+{
+    #ifdef PACKED_SEQ
+        //a tile is a few words, the ports are widened so it comes in one beat
+        #pragma HLS INTERFACE m_axi port=seq1 offset=slave bundle=gmem0 depth=1024 max_widen_bitwidth=512
+        #pragma HLS INTERFACE m_axi port=seq2 offset=slave bundle=gmem1 depth=1024 max_widen_bitwidth=512
+    #else
+        #pragma HLS INTERFACE m_axi port=seq1 offset=slave bundle=gmem0 depth=1024
+        #pragma HLS INTERFACE m_axi port=seq2 offset=slave bundle=gmem1 depth=1024
+    #endif
+    #pragma HLS INTERFACE s_axilite port=seq1 bundle=control
+    #pragma HLS INTERFACE s_axilite port=seq2 bundle=control
+    #pragma HLS INTERFACE m_axi port=buffer offset=slave bundle=gmem2 depth=1024
+    #pragma HLS INTERFACE s_axilite port=buffer bundle=control
+    #pragma HLS INTERFACE m_axi port=seqsize offset=slave bundle=gmem5 
+    #pragma HLS INTERFACE s_axilite port=seqsize bundle=control
+    #pragma HLS INTERFACE m_axi port=tilenum offset=slave bundle=gmem6 
+    #pragma HLS INTERFACE s_axilite port=tilenum bundle=control
+    #pragma HLS INTERFACE m_axi port=alignedSeq1 offset=slave bundle=gmem3 depth=128
+    #pragma HLS INTERFACE s_axilite port=alignedSeq1 bundle=control
+    #pragma HLS INTERFACE m_axi port=alignedSeq2 offset=slave bundle=gmem4 depth=128
+    #pragma HLS INTERFACE s_axilite port=alignedSeq2 bundle=control
+    #pragma HLS INTERFACE m_axi port=scoring offset=slave bundle=gmem7 depth=1280
+    #pragma HLS INTERFACE s_axilite port=scoring bundle=control
+    #pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    //scoring scheme, the same for the whole alignment
+    score_t subMatrix[SCORE_ALPHABET][SCORE_ALPHABET];
+    unsigned char codeTable[256];
+    scoring_load(scoring, subMatrix, codeTable);
+
+    int best[3];
+    align_pair(seq1, seq2, buffer, seqsize, tilenum, alignedSeq1, alignedSeq2, subMatrix, codeTable, best);
+}
+
+//SW_basic_linear up to the backtrack, which the host does instead (src_syst/host_traceback.hpp)
+//the kernel is done with a pair once its tiles are, so it can go on to the next one while the CPU walks this one
+//buffer is SW_basic_linear's, the host reads the tile edges back from it and recomputes the tiles the backtrack goes through
+//best: 0 = score, 1 = end in seq1, 2 = end in seq2, the cell SW_basic_linear would backtrack from
+extern "C" void SW_forward_linear(
+    seq_in_t* seq1, seq_in_t* seq2, volatile boundary_t* buffer,
+    const int seqsize[2], const int tilenum[2],
+    int best[3], const int* scoring)
+{
+    #ifdef PACKED_SEQ
+        #pragma HLS INTERFACE m_axi port=seq1 offset=slave bundle=gmem0 depth=1024 max_widen_bitwidth=512
+        #pragma HLS INTERFACE m_axi port=seq2 offset=slave bundle=gmem1 depth=1024 max_widen_bitwidth=512
+    #else
+        #pragma HLS INTERFACE m_axi port=seq1 offset=slave bundle=gmem0 depth=1024
+        #pragma HLS INTERFACE m_axi port=seq2 offset=slave bundle=gmem1 depth=1024
+    #endif
+    #pragma HLS INTERFACE s_axilite port=seq1 bundle=control
+    #pragma HLS INTERFACE s_axilite port=seq2 bundle=control
+    #pragma HLS INTERFACE m_axi port=buffer offset=slave bundle=gmem2 depth=1024
+    #pragma HLS INTERFACE s_axilite port=buffer bundle=control
+    #pragma HLS INTERFACE m_axi port=seqsize offset=slave bundle=gmem5 
+    #pragma HLS INTERFACE s_axilite port=seqsize bundle=control
+    #pragma HLS INTERFACE m_axi port=tilenum offset=slave bundle=gmem6 
+    #pragma HLS INTERFACE s_axilite port=tilenum bundle=control
+    #pragma HLS INTERFACE m_axi port=best offset=slave bundle=gmem3 depth=3
+    #pragma HLS INTERFACE s_axilite port=best bundle=control
+    #pragma HLS INTERFACE m_axi port=scoring offset=slave bundle=gmem7 depth=1280
+    #pragma HLS INTERFACE s_axilite port=scoring bundle=control
+    #pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    score_t subMatrix[SCORE_ALPHABET][SCORE_ALPHABET];
+    unsigned char codeTable[256];
+    scoring_load(scoring, subMatrix, codeTable);
+
+    int pairBest[3];
+    align_pair(seq1, seq2, buffer, seqsize, tilenum, 0, 0, subMatrix, codeTable, pairBest, PAIR_FORWARD);
+    best[0] = pairBest[0];
+    best[1] = pairBest[1];
+    best[2] = pairBest[2];
+}
+
+//SW_basic_linear with the alignment as cigar runs (cigar.hpp) instead of two strings of seq1_len + seq2_len chars
+//a run is one word for a whole stretch of matches or a gap, so a long alignment is a few words, not one char a base per string
+//the runs are built on chip and burst out CIGAR_BUFFER_RUNS at a time, end first like SW_basic_linear's strings
+//cigar: room for seq1_len + seq2_len runs, only result[5] of them are written
+//result: CIGAR_RESULT_WORDS, score, start in seq1, start in seq2, end in seq1, end in seq2, runs
+extern "C" void SW_cigar_linear(
+    seq_in_t* seq1, seq_in_t* seq2, volatile boundary_t* buffer,
+    const int seqsize[2], const int tilenum[2],
+    unsigned int* cigar, int result[CIGAR_RESULT_WORDS], const int* scoring)
+{
+    #ifdef PACKED_SEQ
+        #pragma HLS INTERFACE m_axi port=seq1 offset=slave bundle=gmem0 depth=1024 max_widen_bitwidth=512
+        #pragma HLS INTERFACE m_axi port=seq2 offset=slave bundle=gmem1 depth=1024 max_widen_bitwidth=512
+    #else
+        #pragma HLS INTERFACE m_axi port=seq1 offset=slave bundle=gmem0 depth=1024
+        #pragma HLS INTERFACE m_axi port=seq2 offset=slave bundle=gmem1 depth=1024
+    #endif
+    #pragma HLS INTERFACE s_axilite port=seq1 bundle=control
+    #pragma HLS INTERFACE s_axilite port=seq2 bundle=control
+    #pragma HLS INTERFACE m_axi port=buffer offset=slave bundle=gmem2 depth=1024
+    #pragma HLS INTERFACE s_axilite port=buffer bundle=control
+    #pragma HLS INTERFACE m_axi port=seqsize offset=slave bundle=gmem5 
+    #pragma HLS INTERFACE s_axilite port=seqsize bundle=control
+    #pragma HLS INTERFACE m_axi port=tilenum offset=slave bundle=gmem6 
+    #pragma HLS INTERFACE s_axilite port=tilenum bundle=control
+    #pragma HLS INTERFACE m_axi port=cigar offset=slave bundle=gmem3 depth=256 max_write_burst_length=256
+    #pragma HLS INTERFACE s_axilite port=cigar bundle=control
+    #pragma HLS INTERFACE m_axi port=result offset=slave bundle=gmem4 depth=6
+    #pragma HLS INTERFACE s_axilite port=result bundle=control
+    #pragma HLS INTERFACE m_axi port=scoring offset=slave bundle=gmem7 depth=1280
+    #pragma HLS INTERFACE s_axilite port=scoring bundle=control
+    #pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    score_t subMatrix[SCORE_ALPHABET][SCORE_ALPHABET];
+    unsigned char codeTable[256];
+    scoring_load(scoring, subMatrix, codeTable);
+
+    int best[3];
+    int pairResult[CIGAR_RESULT_WORDS];
+    align_pair(seq1, seq2, buffer, seqsize, tilenum, 0, 0, subMatrix, codeTable, best, PAIR_CIGAR, cigar, pairResult);
+    result_store: for (int k = 0; k < CIGAR_RESULT_WORDS; k++) {
+        result[k] = pairResult[k];
+    }
+}
+
+//a batch of pairs in one launch, aligned back to back, so the launch and the small argument transfers are paid once
+//every pair is what SW_basic_linear does for it, the scoring scheme is loaded once for all of them
+//seqArena: every sequence one after the other, each padded like a SW_basic_linear input
+//  (tilenum * TILE_SIZE + 1 chars, or packedWords(tilenum * TILE_SIZE) words with PACKED_SEQ)
+//pairTable: BATCH_PAIR_WORDS a pair, seq1 offset, seq1 length, seq2 offset, seq2 length, offsets in seq_in_t
+//buffer: SW_basic_linear's buffer for the biggest pair (tilenum[0] * tilenum[1]), every pair reuses it
+//alignedArena1/2: a pair's output is where the one before it ends, seq1_len + seq2_len each, reversed like SW_basic_linear's
+//resultTable: BATCH_RESULT_WORDS a pair, score, end in seq1, end in seq2, output offset, alignment length
+extern "C" void SW_batch_linear(
+    seq_in_t* seqArena, const int* pairTable, int numPairs, volatile boundary_t* buffer,
+    char* alignedArena1, char* alignedArena2, int* resultTable, const int* scoring)
+{
+    #ifdef PACKED_SEQ
+        #pragma HLS INTERFACE m_axi port=seqArena offset=slave bundle=gmem0 depth=1024 max_widen_bitwidth=512
+    #else
+        #pragma HLS INTERFACE m_axi port=seqArena offset=slave bundle=gmem0 depth=1024
+    #endif
+    #pragma HLS INTERFACE s_axilite port=seqArena bundle=control
+    #pragma HLS INTERFACE m_axi port=pairTable offset=slave bundle=gmem5 depth=64
+    #pragma HLS INTERFACE s_axilite port=pairTable bundle=control
+    #pragma HLS INTERFACE s_axilite port=numPairs bundle=control
+    #pragma HLS INTERFACE m_axi port=buffer offset=slave bundle=gmem2 depth=1024
+    #pragma HLS INTERFACE s_axilite port=buffer bundle=control
+    #pragma HLS INTERFACE m_axi port=alignedArena1 offset=slave bundle=gmem3 depth=1024
+    #pragma HLS INTERFACE s_axilite port=alignedArena1 bundle=control
+    #pragma HLS INTERFACE m_axi port=alignedArena2 offset=slave bundle=gmem4 depth=1024
+    #pragma HLS INTERFACE s_axilite port=alignedArena2 bundle=control
+    #pragma HLS INTERFACE m_axi port=resultTable offset=slave bundle=gmem6 depth=80
+    #pragma HLS INTERFACE s_axilite port=resultTable bundle=control
+    #pragma HLS INTERFACE m_axi port=scoring offset=slave bundle=gmem7 depth=1280
+    #pragma HLS INTERFACE s_axilite port=scoring bundle=control
+    #pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    score_t subMatrix[SCORE_ALPHABET][SCORE_ALPHABET];
+    unsigned char codeTable[256];
+    scoring_load(scoring, subMatrix, codeTable);
+
+    int outputOffset = 0;
+    pair_loop: for (int pair = 0; pair < numPairs; pair++) {
+        int seq1Offset = pairTable[pair * BATCH_PAIR_WORDS + 0];
+        int seq2Offset = pairTable[pair * BATCH_PAIR_WORDS + 2];
+        int seqsize[2] = {pairTable[pair * BATCH_PAIR_WORDS + 1], pairTable[pair * BATCH_PAIR_WORDS + 3]};
+        int tilenum[2] = {(seqsize[0] + TILE_DIMENSION - 1) / TILE_DIMENSION,
+                          (seqsize[1] + TILE_DIMENSION - 1) / TILE_DIMENSION};
+
+        int best[3];
+        int length = align_pair(&seqArena[seq1Offset], &seqArena[seq2Offset], buffer, seqsize, tilenum,
+                                &alignedArena1[outputOffset], &alignedArena2[outputOffset], subMatrix, codeTable, best);
+
+        resultTable[pair * BATCH_RESULT_WORDS + 0] = best[0];
+        resultTable[pair * BATCH_RESULT_WORDS + 1] = best[1];
+        resultTable[pair * BATCH_RESULT_WORDS + 2] = best[2];
+        resultTable[pair * BATCH_RESULT_WORDS + 3] = outputOffset;
+        resultTable[pair * BATCH_RESULT_WORDS + 4] = length;
+        outputOffset += seqsize[0] + seqsize[1];
+    }
+}
+
+//score only: best score, where it ends and the second best score, no backtrack
+//so nothing is kept for one, only a single boundary row instead of every tile's edges, and no output strings
+//buffer holds the boundary row (tilenum[0] * TILE_DIMENSION + 1), then the max of every seq2 row (tilenum[1] * TILE_DIMENSION)
+//  with AFFINE_GAP, then the F row under the boundary row (tilenum[0] * TILE_DIMENSION + 1)
+//  the rows are only used when seq1 is longer than ONCHIP_BOUNDARY_LEN, they are on chip otherwise
+//result: 0 = score, 1 = end in seq1, 2 = end in seq2, 3 = second best score
+//the end is the same cell SW_basic_linear backtracks from
+//the second best is the best score ending more than max(SECOND_BEST_MIN_MASK, shorter length / 2) rows of seq2 away from the end
+extern "C" void SW_score_linear(
+    seq_in_t* seq1, seq_in_t* seq2, volatile boundary_t* buffer,
+    const int seqsize[2], const int tilenum[2],
+    int result[4], const int* scoring)
+{
+    #ifdef PACKED_SEQ
+        //a tile is a few words, the ports are widened so it comes in one beat
+        #pragma HLS INTERFACE m_axi port=seq1 offset=slave bundle=gmem0 depth=1024 max_widen_bitwidth=512
+        #pragma HLS INTERFACE m_axi port=seq2 offset=slave bundle=gmem1 depth=1024 max_widen_bitwidth=512
+    #else
+        #pragma HLS INTERFACE m_axi port=seq1 offset=slave bundle=gmem0 depth=1024
+        #pragma HLS INTERFACE m_axi port=seq2 offset=slave bundle=gmem1 depth=1024
+    #endif
+    #pragma HLS INTERFACE s_axilite port=seq1 bundle=control
+    #pragma HLS INTERFACE s_axilite port=seq2 bundle=control
+    #pragma HLS INTERFACE m_axi port=buffer offset=slave bundle=gmem2 depth=1024
+    #pragma HLS INTERFACE s_axilite port=buffer bundle=control
+    #pragma HLS INTERFACE m_axi port=seqsize offset=slave bundle=gmem5 
+    #pragma HLS INTERFACE s_axilite port=seqsize bundle=control
+    #pragma HLS INTERFACE m_axi port=tilenum offset=slave bundle=gmem6 
+    #pragma HLS INTERFACE s_axilite port=tilenum bundle=control
+    #pragma HLS INTERFACE m_axi port=result offset=slave bundle=gmem3 depth=4
+    #pragma HLS INTERFACE s_axilite port=result bundle=control
+    #pragma HLS INTERFACE m_axi port=scoring offset=slave bundle=gmem7 depth=1280
+    #pragma HLS INTERFACE s_axilite port=scoring bundle=control
+    #pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    char seq1_tilebuffer[TILE_DIMENSION];
+    #pragma HLS ARRAY_PARTITION variable=seq1_tilebuffer complete
+    char seq2_tilebuffer[TILE_DIMENSION];
+    #pragma HLS ARRAY_PARTITION variable=seq2_tilebuffer complete
+    unsigned char seq1_codebuffer[TILE_DIMENSION];
+    #pragma HLS ARRAY_PARTITION variable=seq1_codebuffer complete
+
+    //scoring scheme and the query profile of the current tile row, one profile row per PE
+    score_t subMatrix[SCORE_ALPHABET][SCORE_ALPHABET];
+    unsigned char codeTable[256];
+    score_t tileProfile[TILE_DIMENSION][SCORE_ALPHABET];
+    #pragma HLS ARRAY_PARTITION variable=tileProfile complete dim=1
+    scoring_load(scoring, subMatrix, codeTable);
+
+    int horz_tile_max = tilenum[0];
+    int vert_tile_max = tilenum[1];
+
+    score_t score[TILE_DIMENSION+1][TILE_DIMENSION+1];
+    #pragma HLS ARRAY_PARTITION variable=score complete dim=1
+    #pragma HLS BIND_STORAGE variable=score type=RAM_2P impl=AUTO
+
+    volatile boundary_t* boundaryRow = buffer;
+    volatile boundary_t* rowMax = &buffer[horz_tile_max * TILE_DIMENSION + 1];
+
+    int maxScore = 0;
+    int maxI = 0, maxJ = 0;
+
+    score_t leftSideBoundaryBuffer[TILE_DIMENSION+1];
+    #pragma HLS ARRAY_PARTITION variable=leftSideBoundaryBuffer complete dim=0
+
+    int maxArrBuffer[TILE_DIMENSION][2];
+    #pragma HLS ARRAY_PARTITION variable=maxArrBuffer complete
+
+    //max of every seq2 row of the current tile row, across all of its tiles
+    int rowMaxBuffer[TILE_DIMENSION];
+    #pragma HLS ARRAY_PARTITION variable=rowMaxBuffer complete
+
+    #ifdef AFFINE_GAP
+        score_t gapE[TILE_DIMENSION+1][TILE_DIMENSION+1];
+        #pragma HLS ARRAY_PARTITION variable=gapE complete dim=1
+        #pragma HLS BIND_STORAGE variable=gapE type=RAM_2P impl=AUTO
+        score_t gapF[TILE_DIMENSION+1][TILE_DIMENSION+1];
+        #pragma HLS ARRAY_PARTITION variable=gapF complete dim=1
+        #pragma HLS BIND_STORAGE variable=gapF type=RAM_2P impl=AUTO
+
+        volatile boundary_t* gapRow = &rowMax[vert_tile_max * TILE_DIMENSION];
+
+        score_t leftSideGapBuffer[TILE_DIMENSION+1];
+        #pragma HLS ARRAY_PARTITION variable=leftSideGapBuffer complete dim=0
+    #endif
+
+    //the boundary row on chip when seq1 fits in it, then buffer only gets the row maxima
+    bool onchip = horz_tile_max * TILE_DIMENSION <= ONCHIP_BOUNDARY_LEN;
+    score_t boundaryLine[ONCHIP_BOUNDARY_LEN+1];
+    #pragma HLS BIND_STORAGE variable=boundaryLine type=RAM_2P impl=URAM
+    #ifdef AFFINE_GAP
+        score_t gapLine[ONCHIP_BOUNDARY_LEN+1];
+        #pragma HLS BIND_STORAGE variable=gapLine type=RAM_2P impl=URAM
+    #endif
+    #ifdef TRACEBACK_POINTERS
+        unsigned int traceScratch[TILE_DIMENSION][TRACEBACK_ROW_WORDS];
+            //no backtrack here, the PEs' pointers are dropped
+        #pragma HLS ARRAY_PARTITION variable=traceScratch complete dim=1
+    #endif
+
+    score_vert_tile_loop: for (int vert_tile_num = 0; vert_tile_num < vert_tile_max; vert_tile_num++) {
+        row_max_reset: for (int i = 0; i < TILE_DIMENSION; i++) {
+            #pragma HLS UNROLL
+            rowMaxBuffer[i] = 0;
+        }
+        profile_load(tileProfile, subMatrix, codeTable, seq2, vert_tile_num);
+
+        score_horz_tile_loop: for (int horz_tile_num = 0; horz_tile_num < horz_tile_max; horz_tile_num++) {
+            seq_buffer_load(seq1_tilebuffer, seq2_tilebuffer, seq1_codebuffer, codeTable, seq1, seq2, horz_tile_num, vert_tile_num);
+            if (onchip) {
+                boundary_fill_row(score, horz_tile_num, vert_tile_num, boundaryLine, leftSideBoundaryBuffer);
+            } else {
+                boundary_fill_row(score, horz_tile_num, vert_tile_num, boundaryRow, leftSideBoundaryBuffer);
+            }
+            #ifdef AFFINE_GAP
+                if (onchip) {
+                    gap_boundary_fill_row(gapE, gapF, horz_tile_num, vert_tile_num, gapLine, leftSideGapBuffer);
+                } else {
+                    gap_boundary_fill_row(gapE, gapF, horz_tile_num, vert_tile_num, gapRow, leftSideGapBuffer);
+                }
+            #endif
+            compute_tile(score, seqsize, horz_tile_num, vert_tile_num, maxArrBuffer, seq1_codebuffer, tileProfile
+                     #ifdef AFFINE_GAP
+                         , gapE, gapF
+                     #endif
+                     #ifdef TRACEBACK_POINTERS
+                         , traceScratch
+                     #endif
+                         );
+
+            //same order as SW_basic_linear, so the same end cell
+            score_max_from_PE_loop: for (int i = 0; i < TILE_DIMENSION; i++) {
+                if (maxScore < maxArrBuffer[i][1]) {
+                    maxScore = maxArrBuffer[i][1];
+                    maxI = i + vert_tile_num * TILE_DIMENSION + 1;
+                    maxJ = maxArrBuffer[i][0];
+                }
+                rowMaxBuffer[i] = std::max(rowMaxBuffer[i], maxArrBuffer[i][1]);
+            }
+
+            if (onchip) {
+                score_row_store(score, horz_tile_num, boundaryLine, leftSideBoundaryBuffer);
+            } else {
+                score_row_store(score, horz_tile_num, boundaryRow, leftSideBoundaryBuffer);
+            }
+            #ifdef AFFINE_GAP
+                if (onchip) {
+                    gap_row_store(gapE, gapF, horz_tile_num, gapLine, leftSideGapBuffer);
+                } else {
+                    gap_row_store(gapE, gapF, horz_tile_num, gapRow, leftSideGapBuffer);
+                }
+            #endif
+        }
+
+        row_max_store: for (int i = 0; i < TILE_DIMENSION; i++) {
+            rowMax[vert_tile_num * TILE_DIMENSION + i] = rowMaxBuffer[i];
+        }
+    }
+
+    //second best, every row far enough from the best end
+    int mask = std::max(SECOND_BEST_MIN_MASK, std::min(seqsize[0], seqsize[1]) / 2);
+    int secondScore = 0;
+    second_best_loop: for (int i = 1; i <= seqsize[1]; i++) {
+        if (i < maxI - mask || i > maxI + mask) {
+            secondScore = std::max(secondScore, (int)rowMax[i - 1]);
+        }
+    }
+
+    result[0] = maxScore;
+    result[1] = maxJ;
+    result[2] = maxI;
+    result[3] = secondScore;
+}
+
+//what this xclbin was built with, one word each (KERNEL_CONFIG_WORDS)
+//the hosts read it once when they load the xclbin and size their tiles and buffers from it, see kernel_config.hpp
+extern "C" void SW_kernel_config(int config[KERNEL_CONFIG_WORDS])
+{
+    #pragma HLS INTERFACE m_axi port=config offset=slave bundle=gmem0 depth=4
+    #pragma HLS INTERFACE s_axilite port=config bundle=control
+    #pragma HLS INTERFACE s_axilite port=return bundle=control
+
+    config[0] = TILE_DIMENSION;
+    config[1] = SCORE_BITS;
+    config[2] = BOUNDARY_PLANES;
+    config[3] = buildFeatures();
+}
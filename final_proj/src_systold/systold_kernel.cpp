@@ -4,9 +4,22 @@
 #include <hls_stream.h>
 #include <ap_int.h>
 #include <iostream>
+
+#ifdef AFFINE_GAP
+    #error "this kernel only does linear gaps (GAP_SCORE), use src_syst for AFFINE_GAP"
+#endif
+
+#ifdef PACKED_SEQ
+    #error "this kernel reads the sequences as chars, use src_syst for PACKED_SEQ"
+#endif
+
+#if SCORE_BITS <= 16
+    #error "this kernel keeps int scores in its buffer, use src_syst for a narrow SCORE_BITS"
+#endif
 #include <cstring>
 
 void seq_buffer_load(char seq1_tilebuffer[TILE_DIMENSION], char seq2_tilebuffer[TILE_DIMENSION], 
+                     unsigned char seq1_codebuffer[TILE_DIMENSION], const unsigned char codeTable[256],
                      char* seq1, char* seq2, int seq1_tile, int seq2_tile) 
 {
     int seq1_start = seq1_tile * TILE_DIMENSION;
@@ -16,9 +29,26 @@ void seq_buffer_load(char seq1_tilebuffer[TILE_DIMENSION], char seq2_tilebuffer[
         #pragma HLS UNROLL
         seq1_tilebuffer[i] = seq1[i+seq1_start];
         seq2_tilebuffer[i] = seq2[i+seq2_start];
+        seq1_codebuffer[i] = codeTable[(unsigned char)seq1_tilebuffer[i]];
     } 
 }
 
+//query profile of a tile row: tileProfile[r][c] is the score of code c (from seq1) against row r of the seq2 tile
+//every PE gets its own row, so the match score is one lookup with the seq1 code instead of a compare
+void profile_load(int tileProfile[TILE_DIMENSION][SCORE_ALPHABET], int subMatrix[SCORE_ALPHABET][SCORE_ALPHABET],
+                  const unsigned char codeTable[256], char* seq2, int seq2_tile)
+{
+    int seq2_start = seq2_tile * TILE_DIMENSION;
+
+    profile_row_loop: for (int r = 0; r < TILE_DIMENSION; r++) {
+        unsigned char seq2Code = codeTable[(unsigned char)seq2[r + seq2_start]];
+        profile_col_loop: for (int c = 0; c < SCORE_ALPHABET; c++) {
+            #pragma HLS PIPELINE II=1
+            tileProfile[r][c] = subMatrix[c][seq2Code];
+        }
+    }
+}
+
 void boundary_fill(int score[TILE_DIMENSION+1][TILE_DIMENSION+1], int horz_tile_num, int vert_tile_num, 
                    volatile int* buffer, int buffer_horz_size, int leftSideBoundaryBuffer[TILE_DIMENSION]) 
 {
@@ -72,7 +102,7 @@ void shift_right(char* array, int seqsize) {
 
 void PE(int vert_tile_num, int horz_tile_num, int rowID, //where am i
     hls::stream<int> &aboveSideIn, hls::stream<int> &downOut, //who do i talk to 
-    int rowHead[TILE_DIMENSION+1], char* seq1, char seq2Char, //where is the data
+    int rowHead[TILE_DIMENSION+1], unsigned char* seq1Code, const int profileRow[SCORE_ALPHABET], //where is the data
     const int seqsize1, const int seqsize2, //how big is stuff
     int maxArrBuffer[2], int firstColDiag, int firstColLeft) //extras
 {
@@ -93,7 +123,7 @@ void PE(int vert_tile_num, int horz_tile_num, int rowID, //where am i
         //if we are within seq2 and seq1
         if ((rowID + vert_tile_num * TILE_DIMENSION <= seqsize2) && (i + horz_tile_num * TILE_DIMENSION <= seqsize1)) {
             
-            int matchScore = (seq2Char == seq1[i-1]) ? MATCH_SCORE : MISMATCH_SCORE;
+            int matchScore = profileRow[seq1Code[i-1]];
                 //get data
 
             int myScore = std::max(
@@ -142,7 +172,8 @@ void PE_end(hls::stream<int> &aboveSideIn) {
     }
 }
 
-void systolic_loop(int score[TILE_DIMENSION+1][TILE_DIMENSION+1], char* seq1_buffer, char* seq2_buffer, const int seqsize1_buffer, const int seqsize2_buffer, 
+void systolic_loop(int score[TILE_DIMENSION+1][TILE_DIMENSION+1], unsigned char* seq1_codebuffer, int tileProfile[TILE_DIMENSION][SCORE_ALPHABET],
+                   const int seqsize1_buffer, const int seqsize2_buffer, 
                    int maxArrBuffer[TILE_DIMENSION][2], int vert_tile_num, int horz_tile_num, int firstColDiag[TILE_DIMENSION], int firstColLeft[TILE_DIMENSION]) 
 {
     #pragma HLS INLINE off
@@ -157,7 +188,7 @@ void systolic_loop(int score[TILE_DIMENSION+1][TILE_DIMENSION+1], char* seq1_buf
         #pragma HLS UNROLL
         PE( vert_tile_num, horz_tile_num, i, 
             streams[i-1], streams[i],
-            score[i], seq1_buffer, seq2_buffer[i-1],
+            score[i], seq1_codebuffer, tileProfile[i-1],
                 //this passes the correct row head pointer
             seqsize1_buffer, seqsize2_buffer,
             maxArrBuffer[i-1], firstColDiag[i-1], firstColLeft[i-1]); 
@@ -182,8 +213,10 @@ extern "C" void SW_basic_linear(
     const int seqsize[2], const int tilenum[2], 
         //0 = seq1_len   //0 = ceil(seq1_len/TILE_SIZE)
         //1 = seq2_len   //1 = ceil(seq2_len/TILE_SIZE)
-    char* alignedSeq1, char* alignedSeq2)
+    char* alignedSeq1, char* alignedSeq2,
         //maximum length of these is seq1_len+seq2_len (includes null term)
+    const int* scoring)
+        //packed ScoringScheme, SCORING_WORDS long
 
     //seq1 is on top, seq2 is on left
 
@@ -204,6 +237,8 @@ extern "C" void SW_basic_linear(
     #pragma HLS INTERFACE s_axilite port=alignedSeq1 bundle=control
     #pragma HLS INTERFACE m_axi port=alignedSeq2 offset=slave bundle=gmem4 depth=128
     #pragma HLS INTERFACE s_axilite port=alignedSeq2 bundle=control
+    #pragma HLS INTERFACE m_axi port=scoring offset=slave bundle=gmem7 depth=1280
+    #pragma HLS INTERFACE s_axilite port=scoring bundle=control
     #pragma HLS INTERFACE s_axilite port=return bundle=control
 
     //initalizing tile buffers
@@ -211,6 +246,15 @@ extern "C" void SW_basic_linear(
     #pragma HLS ARRAY_PARTITION variable=seq1_tilebuffer complete
     char seq2_tilebuffer[TILE_DIMENSION];
     #pragma HLS ARRAY_PARTITION variable=seq2_tilebuffer complete
+    unsigned char seq1_codebuffer[TILE_DIMENSION];
+    #pragma HLS ARRAY_PARTITION variable=seq1_codebuffer complete
+
+    //scoring scheme and the query profile of the current tile row, one profile row per PE
+    int subMatrix[SCORE_ALPHABET][SCORE_ALPHABET];
+    unsigned char codeTable[256];
+    int tileProfile[TILE_DIMENSION][SCORE_ALPHABET];
+    #pragma HLS ARRAY_PARTITION variable=tileProfile complete dim=1
+    scoring_load(scoring, subMatrix, codeTable);
 
     //ceil of seqsize / TILEDIM
     int horz_tile_max = tilenum[0];
@@ -238,13 +282,14 @@ extern "C" void SW_basic_linear(
 
     //down the tiles
     vert_tile_loop: for (int vert_tile_num = 0; vert_tile_num < vert_tile_max; vert_tile_num++) {
+        profile_load(tileProfile, subMatrix, codeTable, seq2, vert_tile_num);
         
         //across the tiles
         horz_tile_loop: for (int horz_tile_num = 0; horz_tile_num < horz_tile_max; horz_tile_num++) {
             #pragma HLS LOOP_FLATTEN off
             
             //load the sequence data
-            seq_buffer_load(seq1_tilebuffer, seq2_tilebuffer, seq1, seq2, horz_tile_num, vert_tile_num);
+            seq_buffer_load(seq1_tilebuffer, seq2_tilebuffer, seq1_codebuffer, codeTable, seq1, seq2, horz_tile_num, vert_tile_num);
                 //TODO: seq1 and seq2 should be another buffer level
             boundary_fill(score, horz_tile_num, vert_tile_num, buffer, buffer_horz_size, leftSideBoundaryBuffer);
 
@@ -285,7 +330,7 @@ extern "C" void SW_basic_linear(
             int maxArrBuffer[TILE_DIMENSION][2];
             #pragma HLS ARRAY_PARTITION variable=maxArrBuffer complete
 
-            systolic_loop(score, seq1_tilebuffer, seq2_tilebuffer, seqsize1_buffer, seqsize2_buffer, maxArrBuffer, vert_tile_num, horz_tile_num, firstColDiag, firstColLeft);
+            systolic_loop(score, seq1_codebuffer, tileProfile, seqsize1_buffer, seqsize2_buffer, maxArrBuffer, vert_tile_num, horz_tile_num, firstColDiag, firstColLeft);
 
             //move max arr from PE to the main storage
             for (int i = 0; i < TILE_DIMENSION; i++) {
@@ -355,9 +400,9 @@ extern "C" void SW_basic_linear(
 
     backtrack_loop: while (i > 0 && j > 0 && buffer[i * buffer_horz_size + j] != 0) {
         #ifdef DEBUG_BACKTRACK
-            std::cout << " |||  = " << ((seq1[j] == seq2[i]) ? MATCH_SCORE : MISMATCH_SCORE) << " dia  = " << buffer[(i-1) * buffer_horz_size + j-1] << " |  me " << buffer[i * buffer_horz_size + j] << std::endl;
+            std::cout << " |||  = " << subMatrix[codeTable[(unsigned char)seq1[j]]][codeTable[(unsigned char)seq2[i]]] << " dia  = " << buffer[(i-1) * buffer_horz_size + j-1] << " |  me " << buffer[i * buffer_horz_size + j] << std::endl;
         #endif
-        if (buffer[i * buffer_horz_size + j] == (buffer[(i-1) * buffer_horz_size + j-1] + ((seq1[j] == seq2[i]) ? MATCH_SCORE : MISMATCH_SCORE))) {
+        if (buffer[i * buffer_horz_size + j] == (buffer[(i-1) * buffer_horz_size + j-1] + subMatrix[codeTable[(unsigned char)seq1[j]]][codeTable[(unsigned char)seq2[i]]])) {
             alignedSeq1[idx] = seq1[j];
             alignedSeq2[idx] = seq2[i];
             i--;
@@ -3,14 +3,132 @@
 
 #include <string>
 #include <utility>
+#include "defines.hpp"
+
+//what the kernels get for a sequence, a char a base, or with PACKED_SEQ the words of packed_seq.hpp
+#ifdef PACKED_SEQ
+    typedef unsigned int seq_in_t;
+#else
+    typedef char seq_in_t;
+#endif
+
+//a word of the kernels' tile edges / boundary row buffer, the smallest int that holds a SCORE_BITS score
+#if SCORE_BITS <= 8
+    typedef signed char boundary_t;
+#elif SCORE_BITS <= 16
+    typedef short boundary_t;
+#else
+    typedef int boundary_t;
+#endif
+
+//traceback pointers (TRACEBACK_POINTERS) are packed into buffer words, TRACEBACK_ROW_WORDS for a row of a tile
+#ifdef TRACEBACK_POINTERS
+    #define TRACEBACK_CELLS_PER_WORD ((int)sizeof(boundary_t) * 8 / TRACEBACK_BITS)
+    #define TRACEBACK_ROW_WORDS ((TILE_DIMENSION + TRACEBACK_CELLS_PER_WORD - 1) / TRACEBACK_CELLS_PER_WORD)
+#endif
+
+//words of SW_basic_linear's buffer for a pair of `tiles` tiles (tilenum[0] * tilenum[1]):
+//the edges of every tile, boundaryPlanes times, then with tracebackBits a tile's rows of traceback pointers, tile after tile
+//the defaults are this build's, a host passes the ones of its xclbin (KernelConfig)
+inline size_t alignBufferWords(size_t tiles, int tileDimension = TILE_DIMENSION, int wordBits = sizeof(boundary_t) * 8,
+                               int boundaryPlanes = BOUNDARY_PLANES, int tracebackBits = TRACEBACK_BITS) {
+    size_t words = tiles * (tileDimension + 1) * 2 * boundaryPlanes;
+    if (tracebackBits > 0) {
+        int cellsPerWord = wordBits / tracebackBits;
+        words += tiles * tileDimension * ((tileDimension + cellsPerWord - 1) / cellsPerWord);
+    }
+    return words;
+}
+
+//the kernels' scoring argument is a packed ScoringScheme (see SCORING_WORDS): the substitution matrix, then the code of every character
+//loaded once per run, so other scores are another argument instead of another synthesis
+//Score is the kernel's score type (score_t in the syst kernel, int in the others)
+template <typename Score>
+inline void scoring_load(const int* scoring, Score subMatrix[SCORE_ALPHABET][SCORE_ALPHABET], unsigned char codeTable[256])
+{
+    sub_load_loop: for (int k = 0; k < SCORE_ALPHABET * SCORE_ALPHABET; k++) {
+        #pragma HLS PIPELINE II=1
+        subMatrix[k / SCORE_ALPHABET][k % SCORE_ALPHABET] = scoring[k];
+    }
+    code_load_loop: for (int c = 0; c < 256; c++) {
+        #pragma HLS PIPELINE II=1
+        codeTable[c] = scoring[SCORE_ALPHABET * SCORE_ALPHABET + c];
+    }
+}
 
 extern "C" void SW_basic_linear(
-    char* seq1, char* seq2, volatile int* buffer, //buffer is scaled to be the tilenum[0] tiles wide and tilenum[1] tiles tall 
+    seq_in_t* seq1, seq_in_t* seq2, volatile boundary_t* buffer, //buffer is scaled to be the tilenum[0] tiles wide and tilenum[1] tiles tall 
+        //with AFFINE_GAP it is twice as tall, the gap edges go after the score edges
+        //with TRACEBACK_POINTERS the pointers go after those, alignBufferWords() has the size
         //seq1 and seq2 are actually len+1, since null terminator is included
+        //packed they are packedWords(tilenum * TILE_SIZE) words
     const int seqsize[2], const int tilenum[2], 
         //0 = seq1_len   //0 = ceil(seq1_len/TILE_SIZE)
         //1 = seq2_len   //1 = ceil(seq2_len/TILE_SIZE)
-    char* alignedSeq1, char* alignedSeq2); 
+    char* alignedSeq1, char* alignedSeq2,
         //maximum length of these is seq1_len+seq2_len (including null term)
+    const int* scoring);
+        //packed ScoringScheme (scoring.hpp), SCORING_WORDS long
+
+extern "C" void SW_forward_linear(
+    seq_in_t* seq1, seq_in_t* seq2, volatile boundary_t* buffer,
+        //SW_basic_linear's buffer, the host backtracks from the tile edges in it (src_syst/host_traceback.hpp)
+    const int seqsize[2], const int tilenum[2],
+    int best[3], const int* scoring);
+        //0 = score, 1 = end in seq1, 2 = end in seq2
+
+extern "C" void SW_cigar_linear(
+    seq_in_t* seq1, seq_in_t* seq2, volatile boundary_t* buffer,
+        //SW_basic_linear's inputs
+    const int seqsize[2], const int tilenum[2],
+    unsigned int* cigar, int result[CIGAR_RESULT_WORDS], const int* scoring);
+        //cigar has room for seq1_len + seq2_len runs, the alignment comes out as runs (cigar.hpp), end first
+        //result: score, start in seq1, start in seq2, end in seq1, end in seq2, runs written
+
+extern "C" void SW_batch_linear(
+    seq_in_t* seqArena, const int* pairTable, int numPairs, volatile boundary_t* buffer,
+        //seqArena has every sequence padded like a SW_basic_linear input, pairTable has BATCH_PAIR_WORDS a pair (batch_arena.hpp)
+        //buffer is SW_basic_linear's buffer for the pair with the most tiles
+    char* alignedArena1, char* alignedArena2, int* resultTable,
+        //a pair's output is seq1_len + seq2_len long and starts where the one before it ends
+        //resultTable has BATCH_RESULT_WORDS a pair
+    const int* scoring);
+
+extern "C" void SW_score_linear(
+    seq_in_t* seq1, seq_in_t* seq2, volatile boundary_t* buffer, //buffer is one boundary row (tilenum[0] * TILE_SIZE + 1) then a max per seq2 row (tilenum[1] * TILE_SIZE)
+        //with AFFINE_GAP then another boundary row for F
+    const int seqsize[2], const int tilenum[2],
+    int result[4], const int* scoring);
+        //0 = score, 1 = end in seq1, 2 = end in seq2, 3 = second best score
+
+extern "C" void SW_kernel_config(int config[KERNEL_CONFIG_WORDS]);
+    //what the xclbin was built with, so a host reads the tile size instead of assuming its own (src_syst/kernel_config.hpp)
+
+//the KERNEL_FEATURE_ bits of this build, what SW_kernel_config reports and what a host checks it against
+inline int buildFeatures() {
+    int features = 0;
+    #ifdef AFFINE_GAP
+        features |= KERNEL_FEATURE_AFFINE_GAP;
+    #endif
+    #ifdef PACKED_SEQ
+        features |= KERNEL_FEATURE_PACKED_SEQ;
+    #endif
+    #ifdef TILE_DATAFLOW
+        features |= KERNEL_FEATURE_TILE_DATAFLOW;
+    #endif
+    #ifdef STRIP_SYSTOLIC
+        features |= KERNEL_FEATURE_STRIP_SYSTOLIC;
+    #endif
+    #ifdef TRACEBACK_POINTERS
+        features |= KERNEL_FEATURE_TRACEBACK_POINTERS;
+    #endif
+    #ifdef BANDED
+        features |= KERNEL_FEATURE_BANDED;
+    #endif
+    #ifdef XDROP
+        features |= KERNEL_FEATURE_XDROP;
+    #endif
+    return features;
+}
 
 #endif // SW_ALGORITHM_HPP
\ No newline at end of file
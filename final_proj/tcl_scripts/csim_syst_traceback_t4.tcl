@@ -0,0 +1,42 @@
+# Set the project name and top-level function
+set project_name "SW_syst_traceback_4"
+set top_function "SW_batch_linear"
+
+# Create a new project
+open_project $project_name
+
+#set_property -name "CONFIG.CFLAGS" -value "-std=c++11" -objects [get_files smith_waterman_basic_linear.cpp]
+
+# Set the solution name
+set solution_name "SW_syst_traceback_4"
+open_solution $solution_name
+
+# Set the target FPGA device (modify as per your board)
+set_part xcu250-figd2104-2L-e
+
+# Define clock period (modify as needed)
+create_clock -period 10
+
+# Add source files
+# TRACEBACK_POINTERS is off in defines.hpp, so the kernel and the testbench get it here
+add_files ../src_syst/syst_kernel.cpp -cflags "-DTRACEBACK_POINTERS"
+add_files ../defines.hpp
+add_files ../sw_algo.hpp
+add_files ../batch_arena.hpp
+add_files ../traceback_ptr.hpp
+add_files ../testbench/csim_tb_traceback.cpp -tb -cflags "-DTRACEBACK_POINTERS"
+
+# Set the top function
+set_top $top_function
+
+
+# Run C simulation
+csim_design -argv "-f ../../../../../datasets/sequence_test_cases.txt" -clean
+csim_design -argv "-f ../../../../../datasets/internally_align_test_cases.txt"
+csim_design -argv "-f ../../../../../datasets/long_test_cases.txt"
+csim_design -argv "-f ../../../../../datasets/no_align_test_cases.txt"
+csim_design -argv "-f ../../../../../datasets/perfect_align_test_cases.txt"
+
+# Close the project
+close_project
+exit
@@ -3,6 +3,8 @@
 #include <cstring>
 #include "../defines.hpp"
 #include "../sw_algo.hpp"
+#include "../scoring.hpp"
+#include "../packed_seq.hpp"
 #include <algorithm>
 #include <cmath>
 
@@ -57,16 +59,28 @@ int main() {
     char* alignedSeq2 = (char*)malloc((seqsize[0]+seqsize[1]) * sizeof(char));
    
     // Pointer for score buffer - size needs to include the boundary cells
-    int buffer_horz_size = numTilesVar[0] * (TILE_DIMENSION + 1) * 2;
-    int buffer_vert_size = numTilesVar[1];
-    int* buffer = (int*)malloc(sizeof(int) * buffer_horz_size * buffer_vert_size);
+    size_t buffer_words = alignBufferWords((size_t)numTilesVar[0] * numTilesVar[1]);
+        //with AFFINE_GAP the gap edges go after the score edges, with TRACEBACK_POINTERS the pointers after those
+    boundary_t* buffer = (boundary_t*)malloc(sizeof(boundary_t) * buffer_words);
    
     // Print input
     std::cout << "Sequence 1: " << seq1 << std::endl;
     std::cout << "Sequence 2: " << seq2 << std::endl;
    
+    // Scoring scheme, packed the way the kernel reads it
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
+
+    // What the kernel reads for the sequences, packed with PACKED_SEQ
+    KernelSeq seq1_in, seq2_in;
+    if (!kernelSequence(seq1, numTilesVar[0] * TILE_DIMENSION, seq1_in) ||
+        !kernelSequence(seq2, numTilesVar[1] * TILE_DIMENSION, seq2_in)) {
+        std::cerr << "PACKED_SEQ only takes A C G T N sequences" << std::endl;
+        return 1;
+    }
+
     // Call the HLS function
-    SW_basic_linear(seq1, seq2, buffer, seqsize, numTilesVar, alignedSeq1, alignedSeq2);
+    SW_basic_linear((seq_in_t*)seq1_in.data(), (seq_in_t*)seq2_in.data(), buffer, seqsize, numTilesVar, alignedSeq1, alignedSeq2, scoring);
    
     // Reverse the aligned sequences
     std::reverse(alignedSeq1, alignedSeq1 + strlen(alignedSeq1));
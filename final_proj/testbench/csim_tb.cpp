@@ -6,6 +6,8 @@
 #include <vector>
 #include "../defines.hpp"
 #include "../sw_algo.hpp"
+#include "../scoring.hpp"
+#include "../packed_seq.hpp"
 #include <algorithm>
 #include <cmath>
 
@@ -170,14 +172,30 @@ int main(int argc, char* argv[]) {
     // Pointer for score buffer - size needs to include the boundary cells
     int buffer_horz_size = numTilesVar[0] * TILE_DIMENSION + 1;
     int buffer_vert_size = numTilesVar[1] * TILE_DIMENSION + 1;
-    int* buffer = (int*)malloc(sizeof(int) * buffer_horz_size * buffer_vert_size);
+    boundary_t* buffer = (boundary_t*)malloc(sizeof(boundary_t) * buffer_horz_size * buffer_vert_size);
    
     // Print input with truncation setting from command line
     displaySequence("Sequence 1: ", seq1, truncateOutput);
     displaySequence("Sequence 2: ", seq2, truncateOutput);
    
+    // Scoring scheme, packed the way the kernel reads it
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
+
+    // What the kernel reads for the sequences, packed with PACKED_SEQ
+    KernelSeq seq1_in, seq2_in;
+    if (!kernelSequence(selectedTest.seq1, numTilesVar[0] * TILE_DIMENSION, seq1_in) ||
+        !kernelSequence(selectedTest.seq2, numTilesVar[1] * TILE_DIMENSION, seq2_in)) {
+        std::cerr << "PACKED_SEQ only takes A C G T N sequences" << std::endl;
+        return 1;
+    }
+    if (scoreBitsNeeded(defaultScheme(), seqsize[0], seqsize[1]) > SCORE_BITS) {
+        std::cerr << "Scores of this pair don't fit in SCORE_BITS" << std::endl;
+        return 1;
+    }
+
     // Call the HLS function
-    SW_basic_linear(seq1, seq2, buffer, seqsize, numTilesVar, alignedSeq1, alignedSeq2);
+    SW_basic_linear((seq_in_t*)seq1_in.data(), (seq_in_t*)seq2_in.data(), buffer, seqsize, numTilesVar, alignedSeq1, alignedSeq2, scoring);
     
     // Reverse the aligned sequences
     std::reverse(alignedSeq1, alignedSeq1 + strlen(alignedSeq1));
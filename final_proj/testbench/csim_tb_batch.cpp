@@ -0,0 +1,239 @@
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../defines.hpp"
+#include "../sw_algo.hpp"
+#include "../scoring.hpp"
+#include "../packed_seq.hpp"
+#include "../batch_arena.hpp"
+#include <algorithm>
+#include <cmath>
+
+static int numTiles(int value, int x) {
+    return std::ceil((value + x - 1) / x);
+}
+
+// Structure to hold test data
+struct TestCase {
+    std::string seq1;
+    std::string seq2;
+    std::string expectedAligned1;
+    std::string expectedAligned2;
+};
+
+// Function to load test cases from file
+//ignores comments
+std::vector<TestCase> loadTestCases(const std::string& filename) {
+    std::vector<TestCase> testCases;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return testCases;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip empty lines or comments
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        TestCase tc;
+        size_t pos = 0;
+        
+        // Parse test case from line (format: seq1,seq2,expectedAligned1,expectedAligned2)
+        // Get seq1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq1 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get seq2
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq2 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get expectedAligned1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.expectedAligned1 = line.substr(0, pos);
+        
+        // Get expectedAligned2
+        tc.expectedAligned2 = line.substr(pos + 1);
+        
+        testCases.push_back(tc);
+    }
+    
+    file.close();
+    return testCases;
+}
+
+// Helper function to display sequences with length limit
+void displaySequence(const char* label, const char* sequence, bool truncate = true) {
+    if (!truncate || strlen(sequence) <= 30) {
+        std::cout << label << sequence << std::endl;
+    } else {
+        std::cout << label << "[" << strlen(sequence) << " characters long - not displayed]" << std::endl;
+    }
+}
+
+// Score of an alignment, the expected alignment gives the expected score
+int alignmentScore(const std::string& aligned1, const std::string& aligned2) {
+    int total = 0;
+    for (size_t k = 0; k < aligned1.length() && k < aligned2.length(); k++) {
+        if (aligned1[k] == '-' || aligned2[k] == '-') {
+#ifdef AFFINE_GAP
+            // a gap carries on if the column before has its gap in the same string
+            bool extends = k > 0 && ((aligned1[k] == '-' && aligned1[k - 1] == '-') ||
+                                     (aligned2[k] == '-' && aligned2[k - 1] == '-'));
+            total += extends ? GAP_EXTEND : GAP_OPEN;
+#else
+            total += GAP_SCORE;
+#endif
+        } else {
+            total += defaultScheme().score(aligned1[k], aligned2[k]);
+        }
+    }
+    return total;
+}
+
+// One pair through SW_basic_linear, what the batch has to give for every pair
+bool alignSingle(const TestCase& testCase, std::string& aligned1, std::string& aligned2) {
+    int seqsize[2] = {static_cast<int>(testCase.seq1.length()), static_cast<int>(testCase.seq2.length())};
+    int numTilesVar[2] = {numTiles(seqsize[0], TILE_DIMENSION), numTiles(seqsize[1], TILE_DIMENSION)};
+
+    KernelSeq seq1_in, seq2_in;
+    if (!kernelSequence(testCase.seq1, numTilesVar[0] * TILE_DIMENSION, seq1_in) ||
+        !kernelSequence(testCase.seq2, numTilesVar[1] * TILE_DIMENSION, seq2_in) ||
+        scoreBitsNeeded(defaultScheme(), seqsize[0], seqsize[1]) > SCORE_BITS) {
+        return false;
+    }
+
+    std::vector<char> alignedSeq1(seqsize[0] + seqsize[1] + 1, 0);
+    std::vector<char> alignedSeq2(seqsize[0] + seqsize[1] + 1, 0);
+    std::vector<boundary_t> buffer(alignBufferWords((size_t)numTilesVar[0] * numTilesVar[1]));
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
+
+    SW_basic_linear((seq_in_t*)seq1_in.data(), (seq_in_t*)seq2_in.data(), buffer.data(), seqsize, numTilesVar,
+                    alignedSeq1.data(), alignedSeq2.data(), scoring);
+
+    aligned1.assign(alignedSeq1.data());
+    aligned2.assign(alignedSeq2.data());
+    std::reverse(aligned1.begin(), aligned1.end());
+    std::reverse(aligned2.begin(), aligned2.end());
+    return true;
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -f <filename>       Specify input file, more than one -f puts every file in the batch (default: ../../../../../datasets/sequence_test_cases.txt)" << std::endl;
+    std::cout << "  -t                  Disable truncation of sequence display" << std::endl;
+    std::cout << "  -h                  Display this help message" << std::endl;
+}
+
+// Every test case of the files in one SW_batch_linear call, checked pair by pair against SW_basic_linear
+// the score in the result table has to be the score of the pair's alignment
+int main(int argc, char* argv[]) {
+    // Input files
+    std::vector<std::string> inputFiles;
+    
+    // Default truncation setting
+    bool truncateOutput = true;
+    
+    // Parse command line arguments
+    for (int i = 1; i < argc; i++) {
+        if (i < argc - 1 && strcmp(argv[i], "-f") == 0) {
+            // -f flag for specifying input file
+            inputFiles.push_back(argv[i + 1]);
+            i++; // Skip the next argument since we've used it
+        } else if (strcmp(argv[i], "-t") == 0) {
+            // -t flag to disable truncation
+            truncateOutput = false;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            // -h flag for help
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+    if (inputFiles.empty()) {
+        inputFiles.push_back("../../../../../datasets/sequence_test_cases.txt");
+    }
+    
+    // Load test cases from the specified files
+    std::vector<TestCase> testCases;
+    for (const std::string& inputFile : inputFiles) {
+        std::cout << "Using input file: " << inputFile << std::endl;
+        std::vector<TestCase> fileCases = loadTestCases(inputFile);
+        testCases.insert(testCases.end(), fileCases.begin(), fileCases.end());
+    }
+    
+    if (testCases.empty()) {
+        std::cerr << "No test cases found." << std::endl;
+        return 1;
+    }
+
+    // Build the batch, pairs the kernel can't take are left out
+    BatchArena batch;
+    std::vector<int> caseOfPair;
+    for (size_t n = 0; n < testCases.size(); n++) {
+        if (batch.add(testCases[n].seq1, testCases[n].seq2)) {
+            caseOfPair.push_back(n);
+        } else {
+            std::cout << "Test case " << n << ": left out, PACKED_SEQ only takes A C G T N sequences and the scores have to fit in SCORE_BITS" << std::endl;
+        }
+    }
+    std::cout << "Batch of " << batch.pairs() << " pairs, " << batch.outputBytes << " output bytes, buffer for "
+              << batch.boundaryTiles << " tiles" << std::endl;
+
+    std::vector<boundary_t> buffer(batch.bufferWords());
+    std::vector<char> alignedArena1(batch.outputBytes + 1, 0);
+    std::vector<char> alignedArena2(batch.outputBytes + 1, 0);
+    std::vector<int> resultTable(batch.pairs() * BATCH_RESULT_WORDS + 1, 0);
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
+
+    // Call the HLS function once for the whole batch
+    SW_batch_linear((seq_in_t*)batch.arena.data(), batch.pairTable.data(), batch.pairs(), buffer.data(),
+                    alignedArena1.data(), alignedArena2.data(), resultTable.data(), scoring);
+
+    // Verification
+    int passed = 0;
+    for (int p = 0; p < batch.pairs(); p++) {
+        const TestCase& testCase = testCases[caseOfPair[p]];
+        std::string aligned1 = BatchArena::aligned(alignedArena1, resultTable.data(), p);
+        std::string aligned2 = BatchArena::aligned(alignedArena2, resultTable.data(), p);
+        std::string single1, single2;
+        alignSingle(testCase, single1, single2);
+
+        bool matchesSingle = (aligned1 == single1) && (aligned2 == single2);
+        bool matchesScore = resultTable[p * BATCH_RESULT_WORDS] == alignmentScore(aligned1, aligned2);
+        if (matchesSingle && matchesScore) {
+            passed++;
+        } else {
+            std::cout << "Test case " << caseOfPair[p] << ": "
+                      << (matchesSingle ? "score " : "batch and single pair outputs differ, score ")
+                      << resultTable[p * BATCH_RESULT_WORDS] << " vs " << alignmentScore(aligned1, aligned2) << std::endl;
+            displaySequence("  Batch 1   : ", aligned1.c_str(), truncateOutput);
+            displaySequence("  Batch 2   : ", aligned2.c_str(), truncateOutput);
+            displaySequence("  Single 1  : ", single1.c_str(), truncateOutput);
+            displaySequence("  Single 2  : ", single2.c_str(), truncateOutput);
+        }
+    }
+    std::cout << passed << "/" << batch.pairs() << " pairs match SW_basic_linear" << std::endl;
+    
+    // Final result
+    if (passed == batch.pairs()) {
+        std::cout << "Test Passed!" << std::endl;
+        return 0; // Success
+    } else {
+        std::cout << "Test Failed: Batch differs from single pairs" << std::endl;
+        return 1; // Failure
+    }
+}
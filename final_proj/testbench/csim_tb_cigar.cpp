@@ -0,0 +1,180 @@
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../defines.hpp"
+#include "../sw_algo.hpp"
+#include "../scoring.hpp"
+#include "../packed_seq.hpp"
+#include "../cigar.hpp"
+#include <algorithm>
+#include <cmath>
+
+static int numTiles(int value, int x) {
+    return std::ceil((value + x - 1) / x);
+}
+
+// Structure to hold test data
+struct TestCase {
+    std::string seq1;
+    std::string seq2;
+    std::string expectedAligned1;
+    std::string expectedAligned2;
+};
+
+// Function to load test cases from file
+//ignores comments
+std::vector<TestCase> loadTestCases(const std::string& filename) {
+    std::vector<TestCase> testCases;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return testCases;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip empty lines or comments
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        TestCase tc;
+        size_t pos = 0;
+        
+        // Parse test case from line (format: seq1,seq2,expectedAligned1,expectedAligned2)
+        // Get seq1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq1 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get seq2
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq2 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get expectedAligned1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.expectedAligned1 = line.substr(0, pos);
+        
+        // Get expectedAligned2
+        tc.expectedAligned2 = line.substr(pos + 1);
+        
+        testCases.push_back(tc);
+    }
+    
+    file.close();
+    return testCases;
+}
+
+// Helper function to display sequences with length limit
+void displaySequence(const char* label, const char* sequence, bool truncate = true) {
+    if (!truncate || strlen(sequence) <= 30) {
+        std::cout << label << sequence << std::endl;
+    } else {
+        std::cout << label << "[" << strlen(sequence) << " characters long - not displayed]" << std::endl;
+    }
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -f <filename>       Specify input file (default: ../../../../../datasets/sequence_test_cases.txt)" << std::endl;
+    std::cout << "  -t                  Disable truncation of sequence display" << std::endl;
+    std::cout << "  -h                  Display this help message" << std::endl;
+}
+
+// Every test case through SW_basic_linear and through SW_cigar_linear, whose runs expanded on the host (expandCigar)
+// have to give the same strings, also prints how many bytes each wrote
+int main(int argc, char* argv[]) {
+    std::string inputFile = "../../../../../datasets/sequence_test_cases.txt";
+    bool truncateOutput = true;
+
+    // Parse command line arguments
+    for (int i = 1; i < argc; i++) {
+        if (i < argc - 1 && strcmp(argv[i], "-f") == 0) {
+            inputFile = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            truncateOutput = false;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    std::cout << "Using input file: " << inputFile << std::endl;
+    std::vector<TestCase> testCases = loadTestCases(inputFile);
+    if (testCases.empty()) {
+        std::cerr << "No test cases found." << std::endl;
+        return 1;
+    }
+
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
+
+    int passed = 0;
+    int checked = 0;
+    size_t stringBytes = 0;
+    size_t cigarBytes = 0;
+    for (size_t n = 0; n < testCases.size(); n++) {
+        const TestCase& testCase = testCases[n];
+        int seqsize[2] = {(int)testCase.seq1.length(), (int)testCase.seq2.length()};
+        int tilenum[2] = {numTiles(seqsize[0], TILE_DIMENSION), numTiles(seqsize[1], TILE_DIMENSION)};
+        KernelSeq seq1_in, seq2_in;
+        if (!kernelSequence(testCase.seq1, tilenum[0] * TILE_DIMENSION, seq1_in) ||
+            !kernelSequence(testCase.seq2, tilenum[1] * TILE_DIMENSION, seq2_in) ||
+            scoreBitsNeeded(defaultScheme(), seqsize[0], seqsize[1]) > SCORE_BITS) {
+            std::cout << "Test case " << n << ": left out, PACKED_SEQ only takes A C G T N sequences and the scores have to fit in SCORE_BITS" << std::endl;
+            continue;
+        }
+        checked++;
+
+        std::vector<boundary_t> buffer(alignBufferWords((size_t)tilenum[0] * tilenum[1]));
+        std::vector<char> alignedSeq1(seqsize[0] + seqsize[1] + 1, 0);
+        std::vector<char> alignedSeq2(seqsize[0] + seqsize[1] + 1, 0);
+        SW_basic_linear((seq_in_t*)seq1_in.data(), (seq_in_t*)seq2_in.data(), buffer.data(), seqsize, tilenum,
+                        alignedSeq1.data(), alignedSeq2.data(), scoring);
+        std::string kernel1(alignedSeq1.data());
+        std::string kernel2(alignedSeq2.data());
+        std::reverse(kernel1.begin(), kernel1.end());
+        std::reverse(kernel2.begin(), kernel2.end());
+
+        std::vector<boundary_t> cigarBuffer(buffer.size(), 0);
+        std::vector<unsigned int> cigar(seqsize[0] + seqsize[1] + 1, 0);
+        int result[CIGAR_RESULT_WORDS] = {0};
+        SW_cigar_linear((seq_in_t*)seq1_in.data(), (seq_in_t*)seq2_in.data(), cigarBuffer.data(), seqsize, tilenum,
+                        cigar.data(), result, scoring);
+        std::string host1, host2;
+        expandCigar(testCase.seq1, testCase.seq2, result, cigar.data(), host1, host2);
+        stringBytes += 2 * (seqsize[0] + seqsize[1]);
+        cigarBytes += sizeof(unsigned int) * result[5];
+
+        if (host1 == kernel1 && host2 == kernel2) {
+            passed++;
+        } else {
+            std::cout << "Test case " << n << ": expanded cigar differs from the kernel's strings, " << cigarString(result, cigar.data()) << std::endl;
+            displaySequence("  Kernel 1  : ", kernel1.c_str(), truncateOutput);
+            displaySequence("  Kernel 2  : ", kernel2.c_str(), truncateOutput);
+            displaySequence("  Host 1    : ", host1.c_str(), truncateOutput);
+            displaySequence("  Host 2    : ", host2.c_str(), truncateOutput);
+        }
+    }
+    std::cout << passed << "/" << checked << " expanded cigars match the kernel" << std::endl;
+    std::cout << "Aligned strings: " << stringBytes << " bytes, cigar runs: " << cigarBytes << " bytes" << std::endl;
+
+    // Final result
+    if (passed == checked) {
+        std::cout << "Test Passed!" << std::endl;
+        return 0; // Success
+    } else {
+        std::cout << "Test Failed: Expanded cigar differs from the kernel" << std::endl;
+        return 1; // Failure
+    }
+}
@@ -0,0 +1,214 @@
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../defines.hpp"
+#include "../sw_algo.hpp"
+#include "../scoring.hpp"
+#include "../packed_seq.hpp"
+#include <algorithm>
+#include <cmath>
+#include "../src_syst/align_queue.hpp"
+
+static int numTiles(int value, int x) {
+    return std::ceil((value + x - 1) / x);
+}
+
+// Structure to hold test data
+struct TestCase {
+    std::string seq1;
+    std::string seq2;
+    std::string expectedAligned1;
+    std::string expectedAligned2;
+};
+
+// Function to load test cases from file
+//ignores comments
+std::vector<TestCase> loadTestCases(const std::string& filename) {
+    std::vector<TestCase> testCases;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return testCases;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip empty lines or comments
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        TestCase tc;
+        size_t pos = 0;
+        
+        // Parse test case from line (format: seq1,seq2,expectedAligned1,expectedAligned2)
+        // Get seq1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq1 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get seq2
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq2 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get expectedAligned1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.expectedAligned1 = line.substr(0, pos);
+        
+        // Get expectedAligned2
+        tc.expectedAligned2 = line.substr(pos + 1);
+        
+        testCases.push_back(tc);
+    }
+    
+    file.close();
+    return testCases;
+}
+
+// Helper function to display sequences with length limit
+void displaySequence(const char* label, const char* sequence, bool truncate = true) {
+    if (!truncate || strlen(sequence) <= 30) {
+        std::cout << label << sequence << std::endl;
+    } else {
+        std::cout << label << "[" << strlen(sequence) << " characters long - not displayed]" << std::endl;
+    }
+}
+
+// One pair through SW_basic_linear, what SoftwareAlignBackend runs on each slot
+// everything is local, so the slots can run it at the same time
+bool alignWithKernel(const std::string& seq1Str, const std::string& seq2Str, std::string& aligned1, std::string& aligned2) {
+    int seqsize[2] = {static_cast<int>(seq1Str.length()), static_cast<int>(seq2Str.length())};
+    int numTilesVar[2] = {numTiles(seqsize[0], TILE_DIMENSION), numTiles(seqsize[1], TILE_DIMENSION)};
+
+    KernelSeq seq1_in, seq2_in;
+    if (!kernelSequence(seq1Str, numTilesVar[0] * TILE_DIMENSION, seq1_in) ||
+        !kernelSequence(seq2Str, numTilesVar[1] * TILE_DIMENSION, seq2_in) ||
+        scoreBitsNeeded(defaultScheme(), seqsize[0], seqsize[1]) > SCORE_BITS) {
+        return false;
+    }
+
+    std::vector<char> alignedSeq1(seqsize[0] + seqsize[1] + 1, 0);
+    std::vector<char> alignedSeq2(seqsize[0] + seqsize[1] + 1, 0);
+    std::vector<boundary_t> buffer(alignBufferWords((size_t)numTilesVar[0] * numTilesVar[1]));
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
+
+    SW_basic_linear((seq_in_t*)seq1_in.data(), (seq_in_t*)seq2_in.data(), buffer.data(), seqsize, numTilesVar,
+                    alignedSeq1.data(), alignedSeq2.data(), scoring);
+
+    aligned1.assign(alignedSeq1.data());
+    aligned2.assign(alignedSeq2.data());
+    std::reverse(aligned1.begin(), aligned1.end());
+    std::reverse(aligned2.begin(), aligned2.end());
+    return true;
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -f <filename>       Specify input file (default: ../../../../../datasets/sequence_test_cases.txt)" << std::endl;
+    std::cout << "  -q <depth>          Pairs in flight at once (default: 2)" << std::endl;
+    std::cout << "  -t                  Disable truncation of sequence display" << std::endl;
+    std::cout << "  -h                  Display this help message" << std::endl;
+}
+
+// Every test case of the file through AlignQueue, the same queue syst_host -a puts in front of the device
+// checks the callbacks come back in push order and match the expected alignments
+int main(int argc, char* argv[]) {
+    // Default input file
+    std::string inputFile = "../../../../../datasets/sequence_test_cases.txt";
+    
+    // Default truncation setting
+    bool truncateOutput = true;
+
+    // Default queue depth, double buffered
+    int depth = 2;
+    
+    // Parse command line arguments
+    for (int i = 1; i < argc; i++) {
+        if (i < argc - 1 && strcmp(argv[i], "-f") == 0) {
+            // -f flag for specifying input file
+            inputFile = argv[i + 1];
+            i++; // Skip the next argument since we've used it
+        } else if (i < argc - 1 && strcmp(argv[i], "-q") == 0) {
+            // -q flag for the queue depth
+            depth = std::max(1, std::atoi(argv[i + 1]));
+            i++;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            // -t flag to disable truncation
+            truncateOutput = false;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            // -h flag for help
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+    
+    std::cout << "Using input file: " << inputFile << std::endl;
+    
+    // Load test cases from the specified file
+    std::vector<TestCase> testCases = loadTestCases(inputFile);
+    
+    if (testCases.empty()) {
+        std::cerr << "No test cases found in file '" << inputFile << "'." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Running " << testCases.size() << " test cases, " << depth << " in flight" << std::endl;
+
+    int passed = 0;
+    size_t nextExpected = 0;
+    bool inOrder = true;
+    SoftwareAlignBackend backend(alignWithKernel, depth);
+    {
+        AlignQueue<SoftwareAlignBackend> queue(backend,
+            [&](size_t id, bool ok, const std::string& aligned1, const std::string& aligned2) {
+                inOrder = inOrder && (id == nextExpected);
+                nextExpected++;
+                const TestCase& testCase = testCases[id];
+                if (!ok) {
+                    std::cout << "Test case " << id << ": PACKED_SEQ only takes A C G T N sequences and the scores have to fit in SCORE_BITS" << std::endl;
+                    return;
+                }
+                // Verification, no expected alignment counts as a match
+                bool matchesExpected = testCase.expectedAligned1.empty() || testCase.expectedAligned2.empty() ||
+                                       (aligned1 == testCase.expectedAligned1 && aligned2 == testCase.expectedAligned2);
+                if (matchesExpected) {
+                    passed++;
+                } else {
+                    std::cout << "Test case " << id << ": output does not match expected result!" << std::endl;
+                    displaySequence("  Aligned 1 : ", aligned1.c_str(), truncateOutput);
+                    displaySequence("  Aligned 2 : ", aligned2.c_str(), truncateOutput);
+                    displaySequence("  Expected 1: ", testCase.expectedAligned1.c_str(), truncateOutput);
+                    displaySequence("  Expected 2: ", testCase.expectedAligned2.c_str(), truncateOutput);
+                }
+            }, depth);
+
+        for (const TestCase& testCase : testCases) {
+            queue.push(testCase.seq1, testCase.seq2);
+        }
+        queue.drain();
+    }
+
+    std::cout << passed << "/" << testCases.size() << " test cases passed" << std::endl;
+    if (!inOrder) {
+        std::cout << "Callbacks did not come back in push order!" << std::endl;
+    }
+    
+    // Final result
+    if (inOrder && nextExpected == testCases.size() && passed == static_cast<int>(testCases.size())) {
+        std::cout << "Test Passed!" << std::endl;
+        return 0; // Success
+    } else {
+        std::cout << "Test Failed: Incorrect alignment" << std::endl;
+        return 1; // Failure
+    }
+}
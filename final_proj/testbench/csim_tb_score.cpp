@@ -0,0 +1,310 @@
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../defines.hpp"
+#include "../sw_algo.hpp"
+#include "../scoring.hpp"
+#include "../packed_seq.hpp"
+#include <algorithm>
+#include <cmath>
+
+static int ceilToMultiple(int value, int x) {
+    return ((value + x - 1) / x) * x;
+}
+
+static int numTiles(int value, int x) {
+    return std::ceil((value + x - 1) / x);
+}
+
+// Structure to hold test data
+struct TestCase {
+    std::string seq1;
+    std::string seq2;
+    std::string expectedAligned1;
+    std::string expectedAligned2;
+};
+
+// Function to load test cases from file
+//ignores comments
+std::vector<TestCase> loadTestCases(const std::string& filename) {
+    std::vector<TestCase> testCases;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return testCases;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip empty lines or comments
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        TestCase tc;
+        size_t pos = 0;
+        
+        // Parse test case from line (format: seq1,seq2,expectedAligned1,expectedAligned2)
+        // Get seq1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq1 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get seq2
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq2 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get expectedAligned1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.expectedAligned1 = line.substr(0, pos);
+        
+        // Get expectedAligned2
+        tc.expectedAligned2 = line.substr(pos + 1);
+        
+        testCases.push_back(tc);
+    }
+    
+    file.close();
+    return testCases;
+}
+
+// Helper function to display sequences with length limit
+void displaySequence(const char* label, const char* sequence, bool truncate = true) {
+    if (!truncate || strlen(sequence) <= 30) {
+        std::cout << label << sequence << std::endl;
+    } else {
+        std::cout << label << "[" << strlen(sequence) << " characters long - not displayed]" << std::endl;
+    }
+}
+
+// Score of an alignment, the expected alignment gives the expected score
+int alignmentScore(const std::string& aligned1, const std::string& aligned2) {
+    int total = 0;
+    for (size_t k = 0; k < aligned1.length() && k < aligned2.length(); k++) {
+        if (aligned1[k] == '-' || aligned2[k] == '-') {
+#ifdef AFFINE_GAP
+            // a gap carries on if the column before has its gap in the same string
+            bool extends = k > 0 && ((aligned1[k] == '-' && aligned1[k - 1] == '-') ||
+                                     (aligned2[k] == '-' && aligned2[k - 1] == '-'));
+            total += extends ? GAP_EXTEND : GAP_OPEN;
+#else
+            total += GAP_SCORE;
+#endif
+        } else {
+            total += defaultScheme().score(aligned1[k], aligned2[k]);
+        }
+    }
+    return total;
+}
+
+// Reference for SW_score_linear, full matrix in the kernel's orientation (seq2 rows, seq1 columns)
+// the end is the first strictly greater cell walking TILE_DIMENSION tiles row major, row major inside each tile
+void referenceScore(const std::string& seq1, const std::string& seq2, int result[4]) {
+    int rows = seq2.length(), cols = seq1.length();
+    std::vector<std::vector<int>> score(rows + 1, std::vector<int>(cols + 1, 0));
+#ifdef AFFINE_GAP
+    // Gotoh, E and F clamped at 0 like the kernel
+    std::vector<std::vector<int>> gapE(rows + 1, std::vector<int>(cols + 1, 0));
+    std::vector<std::vector<int>> gapF(rows + 1, std::vector<int>(cols + 1, 0));
+#endif
+    for (int i = 1; i <= rows; i++) {
+        for (int j = 1; j <= cols; j++) {
+            int matchScore = defaultScheme().score(seq1[j - 1], seq2[i - 1]);
+#ifdef AFFINE_GAP
+            gapE[i][j] = std::max(0, std::max(score[i][j - 1] + GAP_OPEN, gapE[i][j - 1] + GAP_EXTEND));
+            gapF[i][j] = std::max(0, std::max(score[i - 1][j] + GAP_OPEN, gapF[i - 1][j] + GAP_EXTEND));
+            score[i][j] = std::max(std::max(0, score[i - 1][j - 1] + matchScore), std::max(gapE[i][j], gapF[i][j]));
+#else
+            score[i][j] = std::max(std::max(0, score[i - 1][j - 1] + matchScore),
+                                   std::max(score[i - 1][j] + GAP_SCORE, score[i][j - 1] + GAP_SCORE));
+#endif
+        }
+    }
+
+    int maxScore = 0, maxI = 0, maxJ = 0;
+    for (int start_i = 1; start_i <= rows; start_i += TILE_DIMENSION) {
+        for (int start_j = 1; start_j <= cols; start_j += TILE_DIMENSION) {
+            for (int i = start_i; i < start_i + TILE_DIMENSION && i <= rows; i++) {
+                for (int j = start_j; j < start_j + TILE_DIMENSION && j <= cols; j++) {
+                    if (score[i][j] > maxScore) {
+                        maxScore = score[i][j];
+                        maxI = i;
+                        maxJ = j;
+                    }
+                }
+            }
+        }
+    }
+
+    int mask = std::max(SECOND_BEST_MIN_MASK, std::min(cols, rows) / 2);
+    int secondScore = 0;
+    for (int i = 1; i <= rows; i++) {
+        if (i < maxI - mask || i > maxI + mask) {
+            for (int j = 1; j <= cols; j++) {
+                secondScore = std::max(secondScore, score[i][j]);
+            }
+        }
+    }
+
+    result[0] = maxScore;
+    result[1] = maxJ;
+    result[2] = maxI;
+    result[3] = secondScore;
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options] [test_case_index]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -f <filename>       Specify input file (default: ../../../../../datasets/sequence_test_cases.txt)" << std::endl;
+    std::cout << "  -t                  Disable truncation of sequence display" << std::endl;
+    std::cout << "  -h                  Display this help message" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // Default test case index
+    int testCaseIndex = 0;
+    
+    // Default input file
+    std::string inputFile = "../../../../../datasets/sequence_test_cases.txt";
+    
+    // Default truncation setting
+    bool truncateOutput = true;
+    
+    // Parse command line arguments
+    for (int i = 1; i < argc; i++) {
+        if (i < argc - 1 && strcmp(argv[i], "-f") == 0) {
+            // -f flag for specifying input file
+            inputFile = argv[i + 1];
+            i++; // Skip the next argument since we've used it
+        } else if (strcmp(argv[i], "-t") == 0) {
+            // -t flag to disable truncation
+            truncateOutput = false;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            // -h flag for help
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            // Assume it's the test case index
+            testCaseIndex = std::atoi(argv[i]);
+        }
+    }
+    
+    std::cout << "Using input file: " << inputFile << std::endl;
+    
+    // Load test cases from the specified file
+    std::vector<TestCase> testCases = loadTestCases(inputFile);
+    
+    if (testCases.empty()) {
+        std::cerr << "No test cases found in file '" << inputFile << "'." << std::endl;
+        return 1;
+    }
+    
+    if (testCaseIndex < 0 || testCaseIndex >= static_cast<int>(testCases.size())) {
+        std::cerr << "Invalid test case index. Valid range: 0-" << (testCases.size() - 1) << std::endl;
+        return 1;
+    }
+    
+    // Get the selected test case
+    TestCase selectedTest = testCases[testCaseIndex];
+    
+    std::cout << "Running test case " << testCaseIndex << std::endl;
+    
+    int seqsize[2] = {static_cast<int>(selectedTest.seq1.length()), 
+                      static_cast<int>(selectedTest.seq2.length())}; // Original sequence lengths
+   
+    // Calculate padded sizes and number of tiles
+    int inputsize1 = ceilToMultiple(seqsize[0], TILE_DIMENSION) + 1;
+    int inputsize2 = ceilToMultiple(seqsize[1], TILE_DIMENSION) + 1;
+    int numTilesVar[2] = {
+        numTiles(seqsize[0], TILE_DIMENSION), // Number of horizontal tiles
+        numTiles(seqsize[1], TILE_DIMENSION)  // Number of vertical tiles
+    };
+   
+    std::cout << "Input sizes: " << inputsize1 << " || " << inputsize2 << std::endl;
+    std::cout << "Tile counts: " << numTilesVar[0] << " || " << numTilesVar[1] << std::endl;
+   
+    // Allocate memory for sequences
+    char* seq1 = (char*)malloc(inputsize1 * sizeof(char));
+    char* seq2 = (char*)malloc(inputsize2 * sizeof(char));
+   
+    // Copy sequences from test case
+    strcpy(seq1, selectedTest.seq1.c_str());
+    strcpy(seq2, selectedTest.seq2.c_str());
+    
+    // One boundary row, then the max of every seq2 row, then the F row with AFFINE_GAP
+    int buffer_size = numTilesVar[0] * TILE_DIMENSION + 1 + numTilesVar[1] * TILE_DIMENSION +
+                      (BOUNDARY_PLANES - 1) * (numTilesVar[0] * TILE_DIMENSION + 1);
+    boundary_t* buffer = (boundary_t*)malloc(sizeof(boundary_t) * buffer_size);
+    int result[4];
+   
+    // Print input with truncation setting from command line
+    displaySequence("Sequence 1: ", seq1, truncateOutput);
+    displaySequence("Sequence 2: ", seq2, truncateOutput);
+   
+    // Scoring scheme, packed the way the kernel reads it
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
+
+    // What the kernel reads for the sequences, packed with PACKED_SEQ
+    KernelSeq seq1_in, seq2_in;
+    if (!kernelSequence(selectedTest.seq1, numTilesVar[0] * TILE_DIMENSION, seq1_in) ||
+        !kernelSequence(selectedTest.seq2, numTilesVar[1] * TILE_DIMENSION, seq2_in)) {
+        std::cerr << "PACKED_SEQ only takes A C G T N sequences" << std::endl;
+        return 1;
+    }
+    if (scoreBitsNeeded(defaultScheme(), seqsize[0], seqsize[1]) > SCORE_BITS) {
+        std::cerr << "Scores of this pair don't fit in SCORE_BITS" << std::endl;
+        return 1;
+    }
+
+    // Call the HLS function
+    SW_score_linear((seq_in_t*)seq1_in.data(), (seq_in_t*)seq2_in.data(), buffer, seqsize, numTilesVar, result, scoring);
+
+    int expected[4];
+    referenceScore(selectedTest.seq1, selectedTest.seq2, expected);
+
+    std::cout << "Score     : " << result[0] << " ending at (" << result[1] << ", " << result[2] << "), second best " << result[3] << std::endl;
+    std::cout << "Reference : " << expected[0] << " ending at (" << expected[1] << ", " << expected[2] << "), second best " << expected[3] << std::endl;
+
+    bool matchesExpected = std::equal(result, result + 4, expected);
+
+    // The expected alignment has to score the same
+    if (!selectedTest.expectedAligned1.empty() && !selectedTest.expectedAligned2.empty()) {
+        int expectedScore = alignmentScore(selectedTest.expectedAligned1, selectedTest.expectedAligned2);
+        std::cout << "Expected  : " << expectedScore << std::endl;
+#ifdef AFFINE_GAP
+        // the expected alignments are the linear gap ones, so they can only score less or the same
+        matchesExpected = matchesExpected && (result[0] >= expectedScore);
+#else
+        matchesExpected = matchesExpected && (result[0] == expectedScore);
+#endif
+    }
+
+    if (!matchesExpected) {
+        std::cout << "Output does not match expected result!" << std::endl;
+    } else {
+        std::cout << "Output matches expected result." << std::endl;
+    }
+    
+    // Cleanup
+    free(seq1);
+    free(seq2);
+    free(buffer);
+    
+    // Final result
+    if (matchesExpected) {
+        std::cout << "Test Passed!" << std::endl;
+        return 0; // Success
+    } else {
+        std::cout << "Test Failed: Incorrect score" << std::endl;
+        return 1; // Failure
+    }
+}
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../defines.hpp"
+#include "../sw_algo.hpp"
+#include "../scoring.hpp"
+#include "../packed_seq.hpp"
+#include "../batch_arena.hpp"
+#include "../traceback_ptr.hpp"
+#include <algorithm>
+#include <cmath>
+
+#ifndef TRACEBACK_POINTERS
+    #error "csim_tb_traceback checks the traceback pointers, build it with -DTRACEBACK_POINTERS (tcl_scripts/csim_syst_traceback_t4.tcl does)"
+#endif
+
+static int numTiles(int value, int x) {
+    return std::ceil((value + x - 1) / x);
+}
+
+// Structure to hold test data
+struct TestCase {
+    std::string seq1;
+    std::string seq2;
+    std::string expectedAligned1;
+    std::string expectedAligned2;
+};
+
+// Function to load test cases from file
+//ignores comments
+std::vector<TestCase> loadTestCases(const std::string& filename) {
+    std::vector<TestCase> testCases;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return testCases;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip empty lines or comments
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        TestCase tc;
+        size_t pos = 0;
+        
+        // Parse test case from line (format: seq1,seq2,expectedAligned1,expectedAligned2)
+        // Get seq1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq1 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get seq2
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq2 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+        
+        // Get expectedAligned1
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.expectedAligned1 = line.substr(0, pos);
+        
+        // Get expectedAligned2
+        tc.expectedAligned2 = line.substr(pos + 1);
+        
+        testCases.push_back(tc);
+    }
+    
+    file.close();
+    return testCases;
+}
+
+// Helper function to display sequences with length limit
+void displaySequence(const char* label, const char* sequence, bool truncate = true) {
+    if (!truncate || strlen(sequence) <= 30) {
+        std::cout << label << sequence << std::endl;
+    } else {
+        std::cout << label << "[" << strlen(sequence) << " characters long - not displayed]" << std::endl;
+    }
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -f <filename>       Specify input file (default: ../../../../../datasets/sequence_test_cases.txt)" << std::endl;
+    std::cout << "  -t                  Disable truncation of sequence display" << std::endl;
+    std::cout << "  -h                  Display this help message" << std::endl;
+}
+
+// Every test case on its own through SW_batch_linear, which gives the end cell, then the pointers it left in buffer
+// are walked on the host (tracebackWalk) and have to give the kernel's own alignment
+int main(int argc, char* argv[]) {
+    std::string inputFile = "../../../../../datasets/sequence_test_cases.txt";
+    bool truncateOutput = true;
+
+    // Parse command line arguments
+    for (int i = 1; i < argc; i++) {
+        if (i < argc - 1 && strcmp(argv[i], "-f") == 0) {
+            inputFile = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            truncateOutput = false;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    std::cout << "Using input file: " << inputFile << std::endl;
+    std::vector<TestCase> testCases = loadTestCases(inputFile);
+    if (testCases.empty()) {
+        std::cerr << "No test cases found." << std::endl;
+        return 1;
+    }
+
+    int scoring[SCORING_WORDS];
+    defaultScheme().pack(scoring);
+
+    int passed = 0;
+    int checked = 0;
+    for (size_t n = 0; n < testCases.size(); n++) {
+        const TestCase& testCase = testCases[n];
+        BatchArena batch;
+        if (!batch.add(testCase.seq1, testCase.seq2)) {
+            std::cout << "Test case " << n << ": left out, PACKED_SEQ only takes A C G T N sequences and the scores have to fit in SCORE_BITS" << std::endl;
+            continue;
+        }
+        checked++;
+
+        std::vector<boundary_t> buffer(batch.bufferWords());
+        std::vector<char> alignedArena1(batch.outputBytes + 1, 0);
+        std::vector<char> alignedArena2(batch.outputBytes + 1, 0);
+        std::vector<int> resultTable(BATCH_RESULT_WORDS + 1, 0);
+        SW_batch_linear((seq_in_t*)batch.arena.data(), batch.pairTable.data(), batch.pairs(), buffer.data(),
+                        alignedArena1.data(), alignedArena2.data(), resultTable.data(), scoring);
+
+        std::string kernel1 = BatchArena::aligned(alignedArena1, resultTable.data(), 0);
+        std::string kernel2 = BatchArena::aligned(alignedArena2, resultTable.data(), 0);
+
+        // the one pair's buffer is laid out for its own tilenum
+        int tilenum[2] = {numTiles(testCase.seq1.length(), TILE_DIMENSION), numTiles(testCase.seq2.length(), TILE_DIMENSION)};
+        std::string host1, host2;
+        tracebackWalk(buffer.data(), tilenum, testCase.seq1, testCase.seq2, resultTable[1], resultTable[2], host1, host2);
+
+        if (host1 == kernel1 && host2 == kernel2) {
+            passed++;
+        } else {
+            std::cout << "Test case " << n << ": host walk differs from the kernel's backtrack" << std::endl;
+            displaySequence("  Kernel 1  : ", kernel1.c_str(), truncateOutput);
+            displaySequence("  Kernel 2  : ", kernel2.c_str(), truncateOutput);
+            displaySequence("  Host 1    : ", host1.c_str(), truncateOutput);
+            displaySequence("  Host 2    : ", host2.c_str(), truncateOutput);
+        }
+    }
+    std::cout << passed << "/" << checked << " host walks match the kernel" << std::endl;
+
+    // Final result
+    if (passed == checked) {
+        std::cout << "Test Passed!" << std::endl;
+        return 0; // Success
+    } else {
+        std::cout << "Test Failed: Host walk differs from the kernel" << std::endl;
+        return 1; // Failure
+    }
+}
@@ -0,0 +1,178 @@
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../defines.hpp"
+#include "../band.hpp"
+#include "../src_base/base_main.hpp"
+
+// Host only test of the CPU baselines' band (-w, -d, -r), no kernel
+// g++ -O2 host_tb_band.cpp ../src_base/base_basic.cpp -o host_tb_band
+// g++ -O2 -fopenmp host_tb_band.cpp ../src_base/base_wave.cpp -o host_tb_band_wave
+// a fixed band of BAND_WIDTH at TILE_DIMENSION gives the expected alignments of the files, like the BANDED kernel
+// (tcl_scripts/csim_syst_band_t4.tcl), and a band as wide as the matrix gives the full matrix's alignment, fixed or adaptive
+
+// Structure to hold test data
+struct TestCase {
+    std::string seq1;
+    std::string seq2;
+    std::string expectedAligned1;
+    std::string expectedAligned2;
+};
+
+// Function to load test cases from file
+//ignores comments
+std::vector<TestCase> loadTestCases(const std::string& filename) {
+    std::vector<TestCase> testCases;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return testCases;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip empty lines or comments
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        // Parse test case from line (format: seq1,seq2,expectedAligned1,expectedAligned2)
+        TestCase tc;
+        size_t pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq1 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq2 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.expectedAligned1 = line.substr(0, pos);
+        tc.expectedAligned2 = line.substr(pos + 1);
+
+        testCases.push_back(tc);
+    }
+
+    file.close();
+    return testCases;
+}
+
+static std::pair<std::string, std::string> align(const std::string& seq1, const std::string& seq2, int tileDim, const Band& band) {
+    return smithWaterman(seq1.c_str(), seq1.length(), seq2.c_str(), seq2.length(), defaultScheme(), tileDim, band);
+}
+
+// A band of every diagonal, so it never leaves out a cell wherever its center goes
+static Band wideBand(const std::string& seq1, const std::string& seq2, bool adaptive) {
+    Band band = {(int)(seq1.length() + seq2.length()), 0, adaptive};
+    return band;
+}
+
+// Every test case of the file: the kernel's fixed band gives the expected alignment, a wide band the full one
+static bool testFile(const std::string& filename) {
+    std::vector<TestCase> testCases = loadTestCases(filename);
+    if (testCases.empty()) {
+        std::cout << "No test cases found in file '" << filename << "'." << std::endl;
+        return false;
+    }
+    Band kernelBand = {BAND_WIDTH, BAND_CENTER, false};
+    int failed = 0;
+    for (size_t n = 0; n < testCases.size(); n++) {
+        const TestCase& tc = testCases[n];
+        std::pair<std::string, std::string> full = align(tc.seq1, tc.seq2, TILE_DIMENSION, fullBand());
+        std::pair<std::string, std::string> banded = align(tc.seq1, tc.seq2, TILE_DIMENSION, kernelBand);
+        bool passed = banded.first == tc.expectedAligned1 && banded.second == tc.expectedAligned2;
+        for (bool adaptive : {false, true}) {
+            passed = passed && align(tc.seq1, tc.seq2, TILE_DIMENSION, wideBand(tc.seq1, tc.seq2, adaptive)) == full;
+        }
+        if (!passed) {
+            std::cout << "  Test case " << n << " does not match" << std::endl;
+            failed++;
+        }
+    }
+    std::cout << filename << ": " << testCases.size() - failed << " of " << testCases.size() << " match" << std::endl;
+    return failed == 0;
+}
+
+// A copy of seq with about one base in `rate` changed, dropped or doubled
+static std::string mutate(const std::string& seq, int rate) {
+    const char bases[] = "ACGT";
+    std::string out;
+    for (char c : seq) {
+        int r = rand() % (3 * rate);
+        if (r == 0) {
+            out += bases[rand() % 4];
+        } else if (r == 1) {
+            continue;
+        } else if (r == 2) {
+            out += c;
+            out += bases[rand() % 4];
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+// Related random pairs at every block size: a wide band, fixed or adaptive, is the full alignment
+static bool testRandomPairs() {
+    const char bases[] = "ACGT";
+    srand(24);
+    int failed = 0, total = 0;
+    for (int n = 0; n < 40; n++) {
+        std::string seq1;
+        int length = 20 + rand() % 400;
+        for (int k = 0; k < length; k++) {
+            seq1 += bases[rand() % 4];
+        }
+        std::string seq2 = mutate(seq1, 10);
+        for (int tileDim : {8, 16, 32, 64}) {
+            std::pair<std::string, std::string> full = align(seq1, seq2, tileDim, fullBand());
+            for (bool adaptive : {false, true}) {
+                total++;
+                if (align(seq1, seq2, tileDim, wideBand(seq1, seq2, adaptive)) != full) {
+                    failed++;
+                }
+            }
+        }
+    }
+    std::cout << "Random pairs: " << total - failed << " of " << total << " wide bands match the full alignment" << std::endl;
+    return failed == 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputFiles;
+    for (int i = 1; i < argc; i++) {
+        if (i < argc - 1 && strcmp(argv[i], "-f") == 0) {
+            // -f flag for a test case file, more than one can be given
+            inputFiles.push_back(argv[i + 1]);
+            i++; // Skip the next argument since we've used it
+        }
+    }
+    if (inputFiles.empty()) {
+        inputFiles = {"../datasets/sequence_test_cases.txt", "../datasets/internally_align_test_cases.txt",
+                      "../datasets/long_test_cases.txt", "../datasets/no_align_test_cases.txt",
+                      "../datasets/perfect_align_test_cases.txt"};
+    }
+
+    bool passed = true;
+    for (const std::string& file : inputFiles) {
+        passed = testFile(file) && passed;
+    }
+    passed = testRandomPairs() && passed;
+
+    // Final result
+    if (passed) {
+        std::cout << "Test Passed!" << std::endl;
+        return 0; // Success
+    } else {
+        std::cout << "Test Failed: Banded alignment differs" << std::endl;
+        return 1; // Failure
+    }
+}
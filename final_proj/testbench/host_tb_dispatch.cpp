@@ -0,0 +1,119 @@
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../src_syst/cu_scheduler.hpp"
+
+// Host only test of CuScheduler, no kernel: FakeCuBackend compute units sleep secondsPerTile for every tile
+// the pass / fail checks only look at which compute unit got which pair, the wall time and utilization are informational
+// g++ -O2 host_tb_dispatch.cpp -pthread -o host_tb_dispatch
+
+static const int tileDimension = 16;
+
+typedef CuScheduler<FakeCuBackend> Scheduler;
+
+// A pair of horzTiles x vertTiles tiles
+static Scheduler::Pair tilePair(int horzTiles, int vertTiles) {
+    return {std::string(horzTiles * tileDimension, 'A'), std::string(vertTiles * tileDimension, 'C')};
+}
+
+static void printStats(const Scheduler& scheduler) {
+    for (int cu = 0; cu < scheduler.computeUnits(); cu++) {
+        std::cout << "  CU " << cu << ": " << scheduler.stats(cu).pairs << " pairs, " << scheduler.stats(cu).tiles
+                  << " tiles, utilization " << 100 * scheduler.utilization(cu) << "%" << std::endl;
+    }
+    std::cout << "  Wall time: " << scheduler.wallSeconds() << " seconds" << std::endl;
+}
+
+// Runs the batch, checks every pair is called back once and returns false if not
+static bool runBatch(Scheduler& scheduler, const std::vector<Scheduler::Pair>& pairs) {
+    std::vector<int> calls(pairs.size(), 0);
+    scheduler.run(pairs, [&](size_t id, bool ok, const std::string& aligned1, const std::string& aligned2) {
+        calls[id] += ok ? 1 : 100;
+    });
+    bool allOnce = std::all_of(calls.begin(), calls.end(), [](int c) { return c == 1; });
+    if (!allOnce) {
+        std::cout << "Not every pair was called back exactly once!" << std::endl;
+    }
+    return allOnce;
+}
+
+// Four 1 tile pairs then a 4 tile pair on 2 compute units
+// in batch order the 4 tile pair goes last and takes 6 tile times, longest first takes 4
+// the check is on what each compute unit got, the times are only printed
+static bool testLongestFirst(double secondsPerTile) {
+    std::cout << "Longest first, 2 compute units" << std::endl;
+    std::vector<Scheduler::Pair> pairs = {tilePair(1, 1), tilePair(1, 1), tilePair(1, 1), tilePair(1, 1), tilePair(2, 2)};
+    FakeCuBackend backend(2, tileDimension, secondsPerTile);
+    Scheduler scheduler(backend, tileDimension);
+    bool passed = runBatch(scheduler, pairs);
+    printStats(scheduler);
+
+    // the 4 tile pair went first if it has a compute unit to itself and the 1 tile pairs all went to the other one
+    int bigCu = scheduler.stats(0).pairs == 1 ? 0 : 1;
+    passed = passed && scheduler.stats(bigCu).pairs == 1 && scheduler.stats(1 - bigCu).pairs == 4;
+    for (int cu = 0; cu < 2; cu++) {
+        passed = passed && scheduler.stats(cu).tiles == 4;
+    }
+    // so the 1 tile pairs finished one after the other, in batch order
+    std::vector<size_t> smallOrder;
+    for (size_t id : scheduler.finishOrder()) {
+        if (id != 4) {
+            smallOrder.push_back(id);
+        }
+    }
+    passed = passed && scheduler.finishOrder().size() == pairs.size() && smallOrder == std::vector<size_t>({0, 1, 2, 3});
+    return passed;
+}
+
+// A mixed batch on 3 compute units, every tile is scheduled once
+// longest first is within 4/3 of the best split, the wall time is printed against it but not checked
+static bool testMixedBatch(double secondsPerTile) {
+    std::cout << "Mixed batch, 3 compute units" << std::endl;
+    std::vector<Scheduler::Pair> pairs;
+    srand(7);
+    long totalTiles = 0, biggest = 0;
+    for (int n = 0; n < 40; n++) {
+        Scheduler::Pair pair = tilePair(1 + rand() % 6, 1 + rand() % 4);
+        pairs.push_back(pair);
+        long tiles = (pair.first.length() / tileDimension) * (pair.second.length() / tileDimension);
+        totalTiles += tiles;
+        biggest = std::max(biggest, tiles);
+    }
+    FakeCuBackend backend(3, tileDimension, secondsPerTile);
+    Scheduler scheduler(backend, tileDimension);
+    bool passed = runBatch(scheduler, pairs);
+    printStats(scheduler);
+
+    double bestSplit = std::max((double)totalTiles / 3, (double)biggest) * secondsPerTile;
+    std::cout << "  Best split: " << bestSplit << " seconds" << std::endl;
+    long scheduledTiles = 0;
+    int scheduledPairs = 0;
+    for (int cu = 0; cu < 3; cu++) {
+        scheduledTiles += scheduler.stats(cu).tiles;
+        scheduledPairs += scheduler.stats(cu).pairs;
+    }
+    return passed && scheduledTiles == totalTiles && scheduledPairs == (int)pairs.size() &&
+           scheduler.finishOrder().size() == pairs.size();
+}
+
+int main(int argc, char* argv[]) {
+    double secondsPerTile = 0.005;
+    if (argc > 1) {
+        secondsPerTile = std::atof(argv[1]);
+    }
+
+    bool passed = testLongestFirst(secondsPerTile);
+    passed = testMixedBatch(secondsPerTile / 5) && passed;
+
+    // Final result
+    if (passed) {
+        std::cout << "Test Passed!" << std::endl;
+        return 0; // Success
+    } else {
+        std::cout << "Test Failed: Incorrect schedule" << std::endl;
+        return 1; // Failure
+    }
+}
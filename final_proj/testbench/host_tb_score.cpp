@@ -0,0 +1,132 @@
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../defines.hpp"
+#include "../src_base/base_main.hpp"
+
+// Host only test of the CPU baselines' score only mode with the second best score, no kernel
+// builds against any engine, with or without -DAFFINE_GAP:
+// g++ -O2 -DAFFINE_GAP host_tb_score.cpp ../src_base/base_basic.cpp -o host_tb_score
+// g++ -O2 -march=native -DAFFINE_GAP host_tb_score.cpp ../src_base/base_simd.cpp -o host_tb_score_simd
+// -o <file> writes the score, end cell and second best of every random pair, -c <file> checks them against such a file,
+// so two engines agree when one build writes and the other checks:
+//   ./host_tb_score -o score_basic.txt && ./host_tb_score_simd -c score_basic.txt
+// the pairs are related with indels, hold part of seq1 twice, or are unrelated, so the second best is all over seq2,
+// and their lengths are not multiples of any block size or SIMD width
+
+static std::string randomSequence(int length) {
+    const char bases[] = "ACGT";
+    std::string seq;
+    for (int k = 0; k < length; k++) {
+        seq += bases[rand() % 4];
+    }
+    return seq;
+}
+
+// A copy of seq with about one base in `rate` changed, dropped or doubled
+static std::string mutate(const std::string& seq, int rate) {
+    const char bases[] = "ACGT";
+    std::string out;
+    for (char c : seq) {
+        int r = rand() % (3 * rate);
+        if (r == 0) {
+            out += bases[rand() % 4];
+        } else if (r == 1) {
+            continue;
+        } else if (r == 2) {
+            out += c;
+            out += bases[rand() % 4];
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+static std::vector<std::pair<std::string, std::string>> randomPairs() {
+    srand(8);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (int n = 0; n < 2000; n++) {
+        std::string seq1 = randomSequence(1 + rand() % 100);
+        std::string seq2;
+        if (n % 3 == 0) {
+            seq2 = randomSequence(rand() % 20) + mutate(seq1, 4 + rand() % 12) + randomSequence(rand() % 20);
+        } else if (n % 3 == 1) {
+            //seq1's start, then its end again, so there is a second alignment next to the best one
+            seq2 = seq1.substr(0, 1 + rand() % seq1.length()) + randomSequence(rand() % 40) + seq1.substr(rand() % seq1.length());
+        } else {
+            seq2 = randomSequence(1 + rand() % 100);
+        }
+        pairs.push_back({seq1, seq2});
+    }
+    return pairs;
+}
+
+int main(int argc, char* argv[]) {
+    std::string writeFile, checkFile;
+    for (int i = 1; i < argc; i++) {
+        if (i < argc - 1 && strcmp(argv[i], "-o") == 0) {
+            // -o flag to write the scores
+            writeFile = argv[i + 1];
+            i++; // Skip the next argument since we've used it
+        } else if (i < argc - 1 && strcmp(argv[i], "-c") == 0) {
+            // -c flag to check the scores against another engine's
+            checkFile = argv[i + 1];
+            i++; // Skip the next argument since we've used it
+        }
+    }
+
+    #ifdef AFFINE_GAP
+        std::cout << "Affine gaps: open " << GAP_OPEN << ", extend " << GAP_EXTEND << std::endl;
+    #else
+        std::cout << "Linear gaps: " << GAP_SCORE << std::endl;
+    #endif
+
+    std::vector<std::pair<std::string, std::string>> pairs = randomPairs();
+    std::vector<std::string> lines;
+    for (const std::pair<std::string, std::string>& pair : pairs) {
+        ScoreResult result = smithWatermanScore(pair.first.c_str(), pair.first.length(), pair.second.c_str(),
+                                                pair.second.length(), true);
+        lines.push_back(std::to_string(result.score) + "," + std::to_string(result.maxI) + "," +
+                        std::to_string(result.maxJ) + "," + std::to_string(result.secondScore));
+    }
+
+    bool passed = true;
+    if (!writeFile.empty()) {
+        std::ofstream out(writeFile);
+        for (const std::string& line : lines) {
+            out << line << "\n";
+        }
+        std::cout << "Wrote " << lines.size() << " scores to " << writeFile << std::endl;
+    }
+    if (!checkFile.empty()) {
+        std::ifstream in(checkFile);
+        std::vector<std::string> other;
+        std::string line;
+        while (std::getline(in, line)) {
+            other.push_back(line);
+        }
+        int same = 0;
+        for (size_t n = 0; n < lines.size() && n < other.size(); n++) {
+            if (lines[n] == other[n]) {
+                same++;
+            } else {
+                std::cout << "  Pair " << n << ": " << lines[n] << " against " << other[n] << std::endl;
+            }
+        }
+        std::cout << "Scores: " << same << " of " << lines.size() << " match " << checkFile << std::endl;
+        passed = other.size() == lines.size() && same == (int)lines.size();
+    }
+
+    // Final result
+    if (passed) {
+        std::cout << "Test Passed!" << std::endl;
+        return 0; // Success
+    } else {
+        std::cout << "Test Failed: Scores differ" << std::endl;
+        return 1; // Failure
+    }
+}
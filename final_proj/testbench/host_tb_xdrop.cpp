@@ -0,0 +1,214 @@
+#include <cstdlib>
+#include <iostream>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../defines.hpp"
+#include "../band.hpp"
+#include "../src_base/base_main.hpp"
+
+// Host only test of the CPU baselines' X-drop (-x), no kernel
+// g++ -O2 host_tb_xdrop.cpp ../src_base/base_basic.cpp -o host_tb_xdrop
+// g++ -O2 -fopenmp host_tb_xdrop.cpp ../src_base/base_wave.cpp -o host_tb_xdrop_wave
+// an X-drop no score can fall by gives the full alignment, on the files and on random pairs at every block size
+// -o <file> writes the alignments of the random pairs at a few real X-drops, -c <file> checks them against such a file,
+// so the engines agree when one build writes and the other checks:
+//   ./host_tb_xdrop -o xdrop_basic.txt && ./host_tb_xdrop_wave -c xdrop_basic.txt
+// the XDROP kernel is not checked against these, it drops against the best before the tile row and the CPU
+// against the best along the dependencies, so the two skip different tiles and can give different alignments
+
+static const int noDrop = 1 << 30;
+    //more than any score, nothing is ever dropped
+static const int realDrops[] = {0, 10, 40};
+
+// Structure to hold test data
+struct TestCase {
+    std::string seq1;
+    std::string seq2;
+    std::string expectedAligned1;
+    std::string expectedAligned2;
+};
+
+// Function to load test cases from file
+//ignores comments
+std::vector<TestCase> loadTestCases(const std::string& filename) {
+    std::vector<TestCase> testCases;
+    std::ifstream file(filename);
+
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return testCases;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip empty lines or comments
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        // Parse test case from line (format: seq1,seq2,expectedAligned1,expectedAligned2)
+        TestCase tc;
+        size_t pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq1 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.seq2 = line.substr(0, pos);
+        line = line.substr(pos + 1);
+
+        pos = line.find(',');
+        if (pos == std::string::npos) continue;
+        tc.expectedAligned1 = line.substr(0, pos);
+        tc.expectedAligned2 = line.substr(pos + 1);
+
+        testCases.push_back(tc);
+    }
+
+    file.close();
+    return testCases;
+}
+
+static std::pair<std::string, std::string> align(const std::string& seq1, const std::string& seq2, int tileDim, int xDrop) {
+    return smithWaterman(seq1.c_str(), seq1.length(), seq2.c_str(), seq2.length(), defaultScheme(), tileDim, fullBand(), xDrop);
+}
+
+// Every test case of the file gives its expected alignment when nothing can drop
+static bool testFile(const std::string& filename) {
+    std::vector<TestCase> testCases = loadTestCases(filename);
+    if (testCases.empty()) {
+        std::cout << "No test cases found in file '" << filename << "'." << std::endl;
+        return false;
+    }
+    int failed = 0;
+    for (size_t n = 0; n < testCases.size(); n++) {
+        const TestCase& tc = testCases[n];
+        std::pair<std::string, std::string> out = align(tc.seq1, tc.seq2, BASELINE_TILE_DIM, noDrop);
+        if (out.first != tc.expectedAligned1 || out.second != tc.expectedAligned2) {
+            std::cout << "  Test case " << n << " does not match" << std::endl;
+            failed++;
+        }
+    }
+    std::cout << filename << ": " << testCases.size() - failed << " of " << testCases.size() << " match" << std::endl;
+    return failed == 0;
+}
+
+static std::string randomSequence(int length) {
+    const char bases[] = "ACGT";
+    std::string seq;
+    for (int k = 0; k < length; k++) {
+        seq += bases[rand() % 4];
+    }
+    return seq;
+}
+
+// Random pairs, half of them unrelated so there is something to drop, half with a shared stretch in the middle
+static std::vector<std::pair<std::string, std::string>> randomPairs() {
+    srand(25);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (int n = 0; n < 40; n++) {
+        std::string seq1 = randomSequence(50 + rand() % 400);
+        std::string seq2 = randomSequence(50 + rand() % 400);
+        if (n % 2 == 1) {
+            std::string shared = randomSequence(30 + rand() % 60);
+            seq1.insert(rand() % seq1.length(), shared);
+            seq2.insert(rand() % seq2.length(), shared);
+        }
+        pairs.push_back({seq1, seq2});
+    }
+    return pairs;
+}
+
+// Random pairs at every block size: nothing dropped is the full alignment
+static bool testNoDrop(const std::vector<std::pair<std::string, std::string>>& pairs) {
+    int failed = 0, total = 0;
+    for (const std::pair<std::string, std::string>& pair : pairs) {
+        for (int tileDim : {8, 16, 32, 64}) {
+            total++;
+            if (align(pair.first, pair.second, tileDim, noDrop) != align(pair.first, pair.second, tileDim, -1)) {
+                failed++;
+            }
+        }
+    }
+    std::cout << "Random pairs: " << total - failed << " of " << total << " match the full alignment with nothing dropped" << std::endl;
+    return failed == 0;
+}
+
+// The random pairs at the real X-drops, a line per alignment
+static std::vector<std::string> dropAlignments(const std::vector<std::pair<std::string, std::string>>& pairs) {
+    std::vector<std::string> lines;
+    for (const std::pair<std::string, std::string>& pair : pairs) {
+        for (int xDrop : realDrops) {
+            std::pair<std::string, std::string> out = align(pair.first, pair.second, BASELINE_TILE_DIM, xDrop);
+            lines.push_back(out.first + "," + out.second);
+        }
+    }
+    return lines;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputFiles;
+    std::string writeFile, checkFile;
+    for (int i = 1; i < argc; i++) {
+        if (i < argc - 1 && strcmp(argv[i], "-f") == 0) {
+            // -f flag for a test case file, more than one can be given
+            inputFiles.push_back(argv[i + 1]);
+            i++; // Skip the next argument since we've used it
+        } else if (i < argc - 1 && strcmp(argv[i], "-o") == 0) {
+            // -o flag to write the X-drop alignments
+            writeFile = argv[i + 1];
+            i++; // Skip the next argument since we've used it
+        } else if (i < argc - 1 && strcmp(argv[i], "-c") == 0) {
+            // -c flag to check the X-drop alignments against another engine's
+            checkFile = argv[i + 1];
+            i++; // Skip the next argument since we've used it
+        }
+    }
+    if (inputFiles.empty()) {
+        inputFiles = {"../datasets/sequence_test_cases.txt", "../datasets/internally_align_test_cases.txt",
+                      "../datasets/long_test_cases.txt", "../datasets/no_align_test_cases.txt",
+                      "../datasets/perfect_align_test_cases.txt"};
+    }
+
+    bool passed = true;
+    for (const std::string& file : inputFiles) {
+        passed = testFile(file) && passed;
+    }
+    std::vector<std::pair<std::string, std::string>> pairs = randomPairs();
+    passed = testNoDrop(pairs) && passed;
+
+    std::vector<std::string> lines = dropAlignments(pairs);
+    if (!writeFile.empty()) {
+        std::ofstream out(writeFile);
+        for (const std::string& line : lines) {
+            out << line << "\n";
+        }
+        std::cout << "Wrote " << lines.size() << " X-drop alignments to " << writeFile << std::endl;
+    }
+    if (!checkFile.empty()) {
+        std::ifstream in(checkFile);
+        std::vector<std::string> other;
+        std::string line;
+        while (std::getline(in, line)) {
+            other.push_back(line);
+        }
+        int same = 0;
+        for (size_t n = 0; n < lines.size() && n < other.size(); n++) {
+            same += lines[n] == other[n] ? 1 : 0;
+        }
+        std::cout << "X-drop alignments: " << same << " of " << lines.size() << " match " << checkFile << std::endl;
+        passed = passed && other.size() == lines.size() && same == (int)lines.size();
+    }
+
+    // Final result
+    if (passed) {
+        std::cout << "Test Passed!" << std::endl;
+        return 0; // Success
+    } else {
+        std::cout << "Test Failed: X-drop alignment differs" << std::endl;
+        return 1; // Failure
+    }
+}
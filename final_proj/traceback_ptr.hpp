@@ -0,0 +1,81 @@
+#ifndef TRACEBACK_PTR_HPP
+#define TRACEBACK_PTR_HPP
+
+#include <string>
+#include "defines.hpp"
+#include "sw_algo.hpp"
+
+//traceback pointers (TRACEBACK_POINTERS): every PE writes the move the backtrack would take out of its cell,
+//so the backtrack is a walk over them instead of recomputing tiles, on the kernel (align_pair) or on the host (tracebackWalk)
+//a pointer is TRACEBACK_BITS: TRACE_STOP / TRACE_DIAG / TRACE_LEFT / TRACE_UP in the low 2 bits, the same order align_pair tries them,
+//with AFFINE_GAP TRACE_LEFT / TRACE_UP are the E / F gaps and TRACE_E_OPEN / TRACE_F_OPEN say the gap opens at this cell
+//in buffer they go after the tile edges: a tile after another in row major order, TILE_DIMENSION rows of TRACEBACK_ROW_WORDS a tile,
+//cell c of a row in word c / TRACEBACK_CELLS_PER_WORD, from the low bits up
+#ifdef TRACEBACK_POINTERS
+
+//where row `row` of tile (horzTile, vertTile) starts in buffer, horzTiles x vertTiles is the pair's tilenum
+inline size_t tracebackRowOffset(int horzTiles, int vertTiles, int horzTile, int vertTile, int row) {
+    size_t edges = (size_t)vertTiles * horzTiles * TILE_BOUNDARY_SLOT * BOUNDARY_PLANES;
+    return edges + (((size_t)vertTile * horzTiles + horzTile) * TILE_DIMENSION + row) * TRACEBACK_ROW_WORDS;
+}
+
+//the pointer of cell col of a packed row, from buffer or from the kernel's copy of a tile
+template <typename Word>
+inline int tracebackCell(const Word row[TRACEBACK_ROW_WORDS], int col) {
+    unsigned int word = (unsigned int)row[col / TRACEBACK_CELLS_PER_WORD];
+    return (word >> ((col % TRACEBACK_CELLS_PER_WORD) * TRACEBACK_BITS)) & ((1 << TRACEBACK_BITS) - 1);
+}
+
+//align_pair's backtrack on the host, from SW_basic_linear's buffer and the end cell (endJ in seq1, endI in seq2, 1 based)
+//aligned1 / aligned2 come out in order, not reversed like the kernel's
+inline void tracebackWalk(const boundary_t* buffer, const int tilenum[2], const std::string& seq1, const std::string& seq2,
+                          int endJ, int endI, std::string& aligned1, std::string& aligned2) {
+    std::string reversed1, reversed2;
+    int i = endI;
+    int j = endJ;
+    int gapState = 0;
+        //like align_pair, 0 = on the score, 1 = in a gap from the left, 2 = in a gap from above
+    while (i > 0 && j > 0) {
+        int vertTile = (i - 1) / TILE_DIMENSION;
+        int horzTile = (j - 1) / TILE_DIMENSION;
+        const boundary_t* row = &buffer[tracebackRowOffset(tilenum[0], tilenum[1], horzTile, vertTile, (i - 1) % TILE_DIMENSION)];
+        int trace = tracebackCell(row, (j - 1) % TILE_DIMENSION);
+        if ((trace & 3) == TRACE_STOP) {
+            break;
+        }
+        if (gapState == 0 && (trace & 3) != TRACE_DIAG) {
+            gapState = (trace & 3) == TRACE_LEFT ? 1 : 2;
+        }
+
+        if (gapState == 0) {
+            reversed1 += seq1[j - 1];
+            reversed2 += seq2[i - 1];
+            i--;
+            j--;
+        } else if (gapState == 1) {
+            reversed1 += seq1[j - 1];
+            reversed2 += '-';
+            #ifdef AFFINE_GAP
+                gapState = (trace & TRACE_E_OPEN) ? 0 : 1;
+            #else
+                gapState = 0;
+            #endif
+            j--;
+        } else {
+            reversed1 += '-';
+            reversed2 += seq2[i - 1];
+            #ifdef AFFINE_GAP
+                gapState = (trace & TRACE_F_OPEN) ? 0 : 2;
+            #else
+                gapState = 0;
+            #endif
+            i--;
+        }
+    }
+    aligned1.assign(reversed1.rbegin(), reversed1.rend());
+    aligned2.assign(reversed2.rbegin(), reversed2.rend());
+}
+
+#endif
+
+#endif
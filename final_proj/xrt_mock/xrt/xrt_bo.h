@@ -0,0 +1,42 @@
+#ifndef XRT_MOCK_BO_H
+#define XRT_MOCK_BO_H
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "xrt_device.h"
+
+namespace xrt {
+
+//host memory, copies share it like xrt::bo handles share the device buffer
+//sync is a no-op, write / read copy in and out like they do against the host side of a real bo
+class bo {
+public:
+    enum class flags { normal, device_only, host_only };
+
+    bo() {}
+    bo(const device& device, size_t size, int group) : bo(device, size, flags::normal, group) {}
+    bo(const device& device, size_t size, flags flags, int group);
+
+    void write(const void* src, size_t size, size_t seek) { std::memcpy(storage->data() + seek, src, size); }
+    void write(const void* src) { write(src, size(), 0); }
+    void read(void* dst, size_t size, size_t skip) { std::memcpy(dst, storage->data() + skip, size); }
+    void read(void* dst) { read(dst, size(), 0); }
+    void sync(xclBOSyncDirection dir, size_t size, size_t offset) {}
+    void sync(xclBOSyncDirection dir) {}
+
+    template <typename T>
+    T map() { return reinterpret_cast<T>(storage->data()); }
+
+    size_t size() const { return storage ? storage->size() : 0; }
+
+    //what the kernel gets for this argument
+    void* host() const { return storage ? storage->data() : nullptr; }
+
+private:
+    std::shared_ptr<std::vector<char>> storage;
+};
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef XRT_MOCK_DEVICE_H
+#define XRT_MOCK_DEVICE_H
+
+#include <string>
+#include <vector>
+
+//software stand in for the parts of XRT the hosts use, see xrt_mock/readme.md
+//loading an xclbin only counts the load, the kernels are the C++ sources linked into the host
+//every kernel has XRT_MOCK_CUS compute units (default 1), named like v++ names them: kernel_1, kernel_2, ...
+
+enum xclBOSyncDirection {
+    XCL_BO_SYNC_BO_TO_DEVICE = 0,
+    XCL_BO_SYNC_BO_FROM_DEVICE,
+};
+
+namespace xrt {
+
+class uuid {};
+
+class xclbin {
+public:
+    //a compute unit, named "kernel:cu" like in the xclbin ip layout
+    class ip {
+    public:
+        explicit ip(const std::string& name) : name(name) {}
+        std::string get_name() const { return name; }
+
+    private:
+        std::string name;
+    };
+
+    class kernel {
+    public:
+        explicit kernel(const std::string& name) : name(name) {}
+        std::string get_name() const { return name; }
+        std::vector<ip> get_cus() const;
+
+    private:
+        std::string name;
+    };
+
+    xclbin() {}
+    explicit xclbin(const std::string& path) : path(path) {}
+
+    kernel get_kernel(const std::string& name) const { return kernel(name); }
+
+private:
+    std::string path;
+};
+
+class device {
+public:
+    device() {}
+    explicit device(unsigned int index) {}
+    explicit device(const std::string& bdf) {}
+
+    uuid load_xclbin(const xclbin& xclbin);
+    uuid load_xclbin(const std::string& path) { return load_xclbin(xrt::xclbin(path)); }
+};
+
+}
+
+#endif
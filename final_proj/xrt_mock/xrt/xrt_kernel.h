@@ -0,0 +1,81 @@
+#ifndef XRT_MOCK_KERNEL_H
+#define XRT_MOCK_KERNEL_H
+
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include "xrt_device.h"
+#include "xrt_bo.h"
+
+enum ert_cmd_state {
+    ERT_CMD_STATE_NEW = 1,
+    ERT_CMD_STATE_QUEUED = 2,
+    ERT_CMD_STATE_RUNNING = 3,
+    ERT_CMD_STATE_COMPLETED = 4,
+};
+
+#define XRT_MOCK_MAX_ARGS 32
+
+namespace xrt_mock {
+
+//calls the kernel function with the host pointers of its arguments, in argument order
+typedef std::function<void(const std::vector<void*>& args)> launcher;
+
+//kernels are found by name, "name:{cu}" finds the launcher of name
+void registerKernel(const std::string& name, launcher launch);
+launcher findKernel(const std::string& name);
+
+}
+
+namespace xrt {
+
+class kernel {
+public:
+    kernel() {}
+    kernel(const device& device, const uuid& uuid, const std::string& name);
+
+    int group_id(int argno) const { return 0; }
+    const std::string& get_name() const { return name; }
+
+private:
+    friend class run;
+    std::string name;
+    xrt_mock::launcher launch;
+};
+
+//start() runs the kernel on its own thread, so like a real run it returns straight away
+//copies share the same run, like xrt::run handles
+class run {
+public:
+    run() {}
+    explicit run(const kernel& kernel);
+
+    void set_arg(int index, const bo& bo) { state_->args.at(index) = bo.host(); }
+    //scalars are kept in the run, the kernel gets a pointer to them like it gets one to a buffer
+    template <typename T>
+    void set_arg(int index, const T& value) {
+        static_assert(sizeof(T) <= sizeof(long long), "scalar arguments are at most 8 bytes");
+        std::memcpy(&state_->scalars.at(index), &value, sizeof(T));
+        state_->args.at(index) = &state_->scalars.at(index);
+    }
+
+    void start();
+    ert_cmd_state wait(unsigned int timeoutMs = 0);
+    ert_cmd_state state() const;
+
+private:
+    struct State {
+        xrt_mock::launcher launch;
+        std::vector<void*> args = std::vector<void*>(XRT_MOCK_MAX_ARGS, nullptr);
+        std::vector<long long> scalars = std::vector<long long>(XRT_MOCK_MAX_ARGS, 0);
+        std::shared_future<void> done;
+    };
+    std::shared_ptr<State> state_;
+};
+
+}
+
+#endif
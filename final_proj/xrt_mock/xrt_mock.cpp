@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include "xrt/xrt_device.h"
+#include "xrt/xrt_kernel.h"
+#include "xrt/xrt_bo.h"
+#include "xrt_mock.hpp"
+
+namespace xrt_mock {
+
+static std::map<std::string, launcher>& kernels() {
+    static std::map<std::string, launcher> registry;
+    return registry;
+}
+static std::mutex registryMutex;
+
+void registerKernel(const std::string& name, launcher launch) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    kernels()[name] = launch;
+}
+
+launcher findKernel(const std::string& name) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto found = kernels().find(name.substr(0, name.find(':')));
+    if (found == kernels().end()) {
+        throw std::runtime_error("xrt_mock: no kernel named " + name + " is linked in");
+    }
+    return found->second;
+}
+
+Counters& counters() {
+    static Counters all;
+    return all;
+}
+
+//XRT_MOCK_STATS=1 prints the counters when the host exits
+static struct StatsAtExit {
+    ~StatsAtExit() {
+        if (std::getenv("XRT_MOCK_STATS") == nullptr) {
+            return;
+        }
+        Counters& c = counters();
+        std::cerr << "xrt_mock: " << c.xclbinLoads << " xclbin loads, " << c.kernels << " kernels, "
+                  << c.runs << " runs, " << c.bos << " bos (" << c.boBytes << " bytes), "
+                  << c.starts << " starts" << std::endl;
+    }
+} statsAtExit;
+
+}
+
+namespace xrt {
+
+std::vector<xclbin::ip> xclbin::kernel::get_cus() const {
+    const char* env = std::getenv("XRT_MOCK_CUS");
+    int numCus = env ? std::max(1, std::atoi(env)) : 1;
+    std::vector<ip> cus;
+    for (int cu = 1; cu <= numCus; cu++) {
+        cus.push_back(ip(name + ":" + name + "_" + std::to_string(cu)));
+    }
+    return cus;
+}
+
+uuid device::load_xclbin(const xclbin& xclbin) {
+    xrt_mock::counters().xclbinLoads++;
+    return uuid();
+}
+
+bo::bo(const device& device, size_t size, flags flags, int group)
+    : storage(std::make_shared<std::vector<char>>(size, 0)) {
+    xrt_mock::counters().bos++;
+    xrt_mock::counters().boBytes += size;
+}
+
+kernel::kernel(const device& device, const uuid& uuid, const std::string& name)
+    : name(name), launch(xrt_mock::findKernel(name)) {
+    xrt_mock::counters().kernels++;
+}
+
+run::run(const kernel& kernel) : state_(std::make_shared<State>()) {
+    state_->launch = kernel.launch;
+    xrt_mock::counters().runs++;
+}
+
+void run::start() {
+    xrt_mock::counters().starts++;
+    std::shared_ptr<State> state = state_;
+    std::vector<void*> args = state->args;
+        //the arguments as they are now, set_arg for the next start can't change this one
+    state->done = std::async(std::launch::async, [state, args]() { state->launch(args); }).share();
+}
+
+ert_cmd_state run::wait(unsigned int timeoutMs) {
+    if (!state_->done.valid()) {
+        return ERT_CMD_STATE_NEW;
+    }
+    if (timeoutMs > 0 && state_->done.wait_for(std::chrono::milliseconds(timeoutMs)) != std::future_status::ready) {
+        return ERT_CMD_STATE_RUNNING;
+    }
+    state_->done.get();
+    return ERT_CMD_STATE_COMPLETED;
+}
+
+ert_cmd_state run::state() const {
+    if (!state_->done.valid()) {
+        return ERT_CMD_STATE_NEW;
+    }
+    if (state_->done.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return ERT_CMD_STATE_RUNNING;
+    }
+    return ERT_CMD_STATE_COMPLETED;
+}
+
+}
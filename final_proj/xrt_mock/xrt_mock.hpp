@@ -0,0 +1,22 @@
+#ifndef XRT_MOCK_HPP
+#define XRT_MOCK_HPP
+
+#include <atomic>
+
+namespace xrt_mock {
+
+//what the host has asked XRT for, so a host built against the mock can be checked for how often it does what
+struct Counters {
+    std::atomic<long> xclbinLoads{0};
+    std::atomic<long> kernels{0};
+    std::atomic<long> runs{0};
+    std::atomic<long> bos{0};
+    std::atomic<long> boBytes{0};
+    std::atomic<long> starts{0};
+};
+
+Counters& counters();
+
+}
+
+#endif
@@ -0,0 +1,31 @@
+#include "xrt/xrt_kernel.h"
+#include "../sw_algo.hpp"
+
+//the src_syst kernels, for hosts built against the mock with src_syst/syst_kernel.cpp
+
+static bool registered = [] {
+    xrt_mock::registerKernel("SW_basic_linear", [](const std::vector<void*>& a) {
+        SW_basic_linear((seq_in_t*)a[0], (seq_in_t*)a[1], (volatile boundary_t*)a[2], (const int*)a[3], (const int*)a[4],
+                        (char*)a[5], (char*)a[6], (const int*)a[7]);
+    });
+    xrt_mock::registerKernel("SW_batch_linear", [](const std::vector<void*>& a) {
+        SW_batch_linear((seq_in_t*)a[0], (const int*)a[1], *(const int*)a[2], (volatile boundary_t*)a[3], (char*)a[4],
+                        (char*)a[5], (int*)a[6], (const int*)a[7]);
+    });
+    xrt_mock::registerKernel("SW_score_linear", [](const std::vector<void*>& a) {
+        SW_score_linear((seq_in_t*)a[0], (seq_in_t*)a[1], (volatile boundary_t*)a[2], (const int*)a[3], (const int*)a[4],
+                        (int*)a[5], (const int*)a[6]);
+    });
+    xrt_mock::registerKernel("SW_forward_linear", [](const std::vector<void*>& a) {
+        SW_forward_linear((seq_in_t*)a[0], (seq_in_t*)a[1], (volatile boundary_t*)a[2], (const int*)a[3], (const int*)a[4],
+                          (int*)a[5], (const int*)a[6]);
+    });
+    xrt_mock::registerKernel("SW_cigar_linear", [](const std::vector<void*>& a) {
+        SW_cigar_linear((seq_in_t*)a[0], (seq_in_t*)a[1], (volatile boundary_t*)a[2], (const int*)a[3], (const int*)a[4],
+                        (unsigned int*)a[5], (int*)a[6], (const int*)a[7]);
+    });
+    xrt_mock::registerKernel("SW_kernel_config", [](const std::vector<void*>& a) {
+        SW_kernel_config((int*)a[0]);
+    });
+    return true;
+}();